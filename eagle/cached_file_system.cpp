@@ -0,0 +1,414 @@
+#include <eagle/cached_file_system.h>
+#include <eagle/log.h>
+#include <eagle/hash.h>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <thread>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace eagle {
+
+#if defined(__linux__)
+
+//directories are watched instead of files so editors that save through a rename are still detected
+class CachedFileSystem::Watcher {
+public:
+    explicit Watcher(CachedFileSystem* owner) : m_owner(owner) {
+        m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_fd < 0){
+            EG_WARNING("eagle", "Failed to initialize inotify, cached files will be checked on every read");
+            return;
+        }
+        m_running = true;
+        m_thread = std::thread(&Watcher::run, this);
+    }
+
+    ~Watcher() {
+        m_running = false;
+        if (m_thread.joinable()){
+            m_thread.join();
+        }
+        if (m_fd >= 0){
+            close(m_fd);
+        }
+    }
+
+    //called with the owner's mutex held
+    bool watch(const std::string& directory) {
+        auto it = m_directoryWatches.find(directory);
+        if (it != m_directoryWatches.end()){
+            return it->second >= 0;
+        }
+        int wd = m_fd < 0 ? -1 : inotify_add_watch(m_fd, directory.c_str(),
+                                                   IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_ATTRIB);
+        //marks the directory even when the watch fails (e.g. paths served from an archive) to avoid retrying
+        m_directoryWatches.emplace(directory, wd);
+        if (wd >= 0){
+            m_watchDirectories.emplace(wd, directory);
+        }
+        return wd >= 0;
+    }
+
+private:
+    void run() {
+        alignas(inotify_event) char buffer[4096];
+        pollfd pfd = {m_fd, POLLIN, 0};
+        while (m_running){
+            if (poll(&pfd, 1, 100) <= 0){
+                continue;
+            }
+            ssize_t length;
+            while ((length = read(m_fd, buffer, sizeof(buffer))) > 0){
+                std::lock_guard<std::mutex> lock(m_owner->m_mutex);
+                for (char* ptr = buffer; ptr < buffer + length;){
+                    auto event = reinterpret_cast<inotify_event*>(ptr);
+                    ptr += sizeof(inotify_event) + event->len;
+
+                    if (event->mask & IN_Q_OVERFLOW){
+                        for (auto& directory : m_watchDirectories){
+                            m_owner->on_directory_changed(directory.second);
+                        }
+                        continue;
+                    }
+                    auto directory = m_watchDirectories.find(event->wd);
+                    if (directory != m_watchDirectories.end() && event->len > 0){
+                        m_owner->on_file_changed(directory->second + "/" + event->name);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    CachedFileSystem* m_owner;
+    int m_fd = -1;
+    std::unordered_map<int, std::string> m_watchDirectories;
+    std::unordered_map<std::string, int> m_directoryWatches;
+    std::thread m_thread;
+    std::atomic_bool m_running{false};
+};
+
+#elif defined(_WIN32)
+
+//one overlapped ReadDirectoryChangesW per directory, all waited on by a single thread
+class CachedFileSystem::Watcher {
+public:
+    explicit Watcher(CachedFileSystem* owner) : m_owner(owner) {
+        m_wake = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+        if (!m_wake){
+            EG_WARNING("eagle", "Failed to create the file watcher event, cached files will be checked on every read");
+            return;
+        }
+        m_running = true;
+        m_thread = std::thread(&Watcher::run, this);
+    }
+
+    ~Watcher() {
+        m_running = false;
+        if (m_thread.joinable()){
+            SetEvent(m_wake);
+            m_thread.join();
+        }
+        for (auto& directory : m_directories){
+            close(*directory);
+        }
+        if (m_wake){
+            CloseHandle(m_wake);
+        }
+    }
+
+    //called with the owner's mutex held
+    bool watch(const std::string& directory) {
+        if (std::find(m_unwatchable.begin(), m_unwatchable.end(), directory) != m_unwatchable.end()){
+            return false;
+        }
+        for (auto& watched : m_directories){
+            if (watched->path == directory){
+                return true;
+            }
+        }
+
+        //the wake event takes one of the MAXIMUM_WAIT_OBJECTS slots
+        if (!m_running || m_directories.size() + 1 >= MAXIMUM_WAIT_OBJECTS){
+            m_unwatchable.emplace_back(directory);
+            return false;
+        }
+
+        auto watched = std::make_unique<DirectoryWatch>();
+        watched->path = directory;
+        watched->handle = CreateFileA(directory.c_str(), FILE_LIST_DIRECTORY,
+                                      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                      FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        watched->overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+        if (watched->handle == INVALID_HANDLE_VALUE || !watched->overlapped.hEvent || !issue(*watched)){
+            //e.g. paths served from an archive, marked to avoid retrying
+            close(*watched);
+            m_unwatchable.emplace_back(directory);
+            return false;
+        }
+        m_directories.emplace_back(std::move(watched));
+        //the watcher thread starts waiting on the new directory
+        SetEvent(m_wake);
+        return true;
+    }
+
+private:
+    struct DirectoryWatch {
+        std::string path;
+        HANDLE handle = INVALID_HANDLE_VALUE;
+        OVERLAPPED overlapped = {};
+        alignas(DWORD) uint8_t buffer[16 * 1024];
+    };
+
+    static bool issue(DirectoryWatch& watched) {
+        ResetEvent(watched.overlapped.hEvent);
+        return ReadDirectoryChangesW(watched.handle, watched.buffer, sizeof(watched.buffer), FALSE,
+                                     FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE,
+                                     nullptr, &watched.overlapped, nullptr) != 0;
+    }
+
+    static void close(DirectoryWatch& watched) {
+        if (watched.handle != INVALID_HANDLE_VALUE){
+            CancelIoEx(watched.handle, &watched.overlapped);
+            DWORD bytes;
+            GetOverlappedResult(watched.handle, &watched.overlapped, &bytes, TRUE);
+            CloseHandle(watched.handle);
+        }
+        if (watched.overlapped.hEvent){
+            CloseHandle(watched.overlapped.hEvent);
+        }
+    }
+
+    void run() {
+        std::vector<HANDLE> handles;
+        std::vector<DirectoryWatch*> watches;
+        while (m_running){
+            {
+                std::lock_guard<std::mutex> lock(m_owner->m_mutex);
+                handles.assign(1, m_wake);
+                watches.clear();
+                for (auto& watched : m_directories){
+                    handles.emplace_back(watched->overlapped.hEvent);
+                    watches.emplace_back(watched.get());
+                }
+            }
+
+            DWORD result = WaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(), FALSE, INFINITE);
+            if (result <= WAIT_OBJECT_0 || result >= WAIT_OBJECT_0 + handles.size()){
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(m_owner->m_mutex);
+            DirectoryWatch& watched = *watches[result - WAIT_OBJECT_0 - 1];
+            DWORD bytes = 0;
+            if (!GetOverlappedResult(watched.handle, &watched.overlapped, &bytes, FALSE) || bytes == 0){
+                //the buffer overflowed, or the read was cancelled because the thread that issued it exited
+                m_owner->on_directory_changed(watched.path);
+            }
+            else {
+                notify(watched);
+            }
+
+            if (!issue(watched)){
+                m_owner->on_directory_changed(watched.path);
+                auto it = std::find_if(m_directories.begin(), m_directories.end(), [&watched](const std::unique_ptr<DirectoryWatch>& other){
+                    return other.get() == &watched;
+                });
+                close(watched);
+                //watched again the next time one of its files is read
+                m_directories.erase(it);
+            }
+        }
+    }
+
+    void notify(DirectoryWatch& watched) {
+        for (auto ptr = watched.buffer;;){
+            auto info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(ptr);
+            int length = static_cast<int>(info->FileNameLength / sizeof(WCHAR));
+            int size = WideCharToMultiByte(CP_ACP, 0, info->FileName, length, nullptr, 0, nullptr, nullptr);
+            std::string name(size, '\0');
+            WideCharToMultiByte(CP_ACP, 0, info->FileName, length, &name[0], size, nullptr, nullptr);
+            std::transform(name.begin(), name.end(), name.begin(), [](char c){ return static_cast<char>(::tolower(static_cast<unsigned char>(c))); });
+            m_owner->on_file_changed(watched.path + "/" + name);
+
+            if (info->NextEntryOffset == 0){
+                break;
+            }
+            ptr += info->NextEntryOffset;
+        }
+    }
+
+private:
+    CachedFileSystem* m_owner;
+    HANDLE m_wake = nullptr;
+    std::vector<std::unique_ptr<DirectoryWatch>> m_directories;
+    std::vector<std::string> m_unwatchable;
+    std::thread m_thread;
+    std::atomic_bool m_running{false};
+};
+
+#else
+
+class CachedFileSystem::Watcher {
+public:
+    explicit Watcher(CachedFileSystem* owner) {}
+    bool watch(const std::string& directory) { return false; }
+};
+
+#endif
+
+void CachedFileSystem::init(size_t byteBudget) {
+    assert(s_instance && "CachedFileSystem must wrap an initialized FileSystem");
+    s_instance = new CachedFileSystem(s_instance, byteBudget);
+}
+
+CachedFileSystem::CachedFileSystem(FileSystem *source, size_t byteBudget) :
+    m_source(source),
+    m_byteBudget(byteBudget),
+    m_watcher(std::make_unique<Watcher>(this)) {
+
+}
+
+CachedFileSystem::~CachedFileSystem() {
+    //joins the watcher thread before the entries go away
+    m_watcher.reset();
+}
+
+std::string CachedFileSystem::cache_key(const std::string &path) const {
+    std::error_code ec;
+    auto absolute = std::filesystem::absolute(path, ec);
+    std::string key = ec ? path : absolute.lexically_normal().generic_string();
+#ifdef _WIN32
+    //paths are case insensitive, keys have to match the names reported by the watcher
+    std::transform(key.begin(), key.end(), key.begin(), [](char c){ return static_cast<char>(::tolower(static_cast<unsigned char>(c))); });
+#endif
+    return key;
+}
+
+int64_t CachedFileSystem::last_write_time(const std::string &key) {
+    std::error_code ec;
+    auto time = std::filesystem::last_write_time(key, ec);
+    return ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+const CachedFileSystem::Entry& CachedFileSystem::fetch(const std::string &path) {
+    std::string key = cache_key(path);
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()){
+        if (it->second.watched || it->second.lastWriteTime == last_write_time(key)){
+            m_stats.hits++;
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lruIterator);
+            return it->second;
+        }
+        m_stats.invalidations++;
+        erase(it);
+    }
+
+    m_stats.misses++;
+    Entry entry;
+    //watched before reading, changes reported meanwhile wait for m_mutex and evict the new entry
+    entry.watched = watch(key);
+    entry.lastWriteTime = entry.watched ? 0 : last_write_time(key);
+    entry.bytes = m_source->read_bytes(path);
+    entry.hash = fnv1a(entry.bytes.data(), entry.bytes.size());
+    m_lru.emplace_front(key);
+    entry.lruIterator = m_lru.begin();
+    m_stats.cachedBytes += entry.bytes.size();
+
+    it = m_entries.emplace(key, std::move(entry)).first;
+    trim();
+    return it->second;
+}
+
+void CachedFileSystem::erase(std::unordered_map<std::string, Entry>::iterator it) {
+    m_stats.cachedBytes -= it->second.bytes.size();
+    m_lru.erase(it->second.lruIterator);
+    m_entries.erase(it);
+}
+
+void CachedFileSystem::trim() {
+    //the most recently used entry is always kept, even if it alone exceeds the budget
+    while (m_stats.cachedBytes > m_byteBudget && m_lru.size() > 1){
+        m_stats.evictions++;
+        erase(m_entries.find(m_lru.back()));
+    }
+}
+
+std::vector<uint8_t> CachedFileSystem::read_bytes(const std::string &path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return fetch(path).bytes;
+}
+
+std::vector<uint8_t> CachedFileSystem::read_bytes(const std::string &path, size_t offset, size_t size) {
+    return m_source->read_bytes(path, offset, size);
+}
+
+std::string CachedFileSystem::read_text(const std::string &path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& entry = fetch(path);
+    return std::string(entry.bytes.begin(), entry.bytes.end());
+}
+
+uint64_t CachedFileSystem::content_hash(const std::string &path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return fetch(path).hash;
+}
+
+void CachedFileSystem::invalidate(const std::string &path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(cache_key(path));
+    if (it != m_entries.end()){
+        m_stats.invalidations++;
+        erase(it);
+    }
+}
+
+void CachedFileSystem::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_lru.clear();
+    m_stats.cachedBytes = 0;
+}
+
+CachedFileSystemStats CachedFileSystem::stats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.cachedFiles = m_entries.size();
+    return m_stats;
+}
+
+bool CachedFileSystem::watch(const std::string &key) {
+    return m_watcher->watch(std::filesystem::path(key).parent_path().generic_string());
+}
+
+void CachedFileSystem::on_file_changed(const std::string &key) {
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()){
+        EG_TRACE("eagle", "Cached file changed on disk: {0}", it->first);
+        m_stats.invalidations++;
+        erase(it);
+    }
+}
+
+void CachedFileSystem::on_directory_changed(const std::string &directory) {
+    EG_TRACE("eagle", "Lost file changes of {0}, evicting its cached files", directory);
+    for (auto it = m_entries.begin(); it != m_entries.end();){
+        auto current = it++;
+        if (std::filesystem::path(current->first).parent_path().generic_string() == directory){
+            m_stats.invalidations++;
+            erase(current);
+        }
+    }
+}
+
+}
@@ -0,0 +1,91 @@
+#ifndef EG_CACHED_FILE_SYSTEM_H
+#define EG_CACHED_FILE_SYSTEM_H
+
+#include <eagle/file_system.h>
+
+#include <list>
+#include <unordered_map>
+
+namespace eagle {
+
+struct CachedFileSystemStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t invalidations = 0;
+    size_t cachedBytes = 0;
+    size_t cachedFiles = 0;
+};
+
+//Keeps recently read files in memory, bounded by a byte budget (LRU).
+//Entries are evicted when the file changes on disk. Their directory is watched for changes, with inotify on linux
+//and ReadDirectoryChangesW on windows. Files whose directory can't be watched, e.g. on other platforms or once the
+//watch limit is reached, have their last write time compared on every hit instead.
+class CachedFileSystem : public FileSystem {
+public:
+    static constexpr size_t DEFAULT_BYTE_BUDGET = 64 * 1024 * 1024;
+
+    //wraps the current FileSystem instance
+    static void init(size_t byteBudget = DEFAULT_BYTE_BUDGET);
+
+    CachedFileSystem(FileSystem* source, size_t byteBudget);
+    ~CachedFileSystem();
+
+    std::vector<uint8_t> read_bytes(const std::string &path) override;
+    //ranges are read straight from the source, e.g. streamed mip levels that would only evict whole files
+    std::vector<uint8_t> read_bytes(const std::string &path, size_t offset, size_t size) override;
+    std::string read_text(const std::string& path) override;
+
+    //FNV-1a 64 of the file contents, loads the file through the cache if needed
+    uint64_t content_hash(const std::string& path);
+
+    void invalidate(const std::string& path);
+    void clear();
+
+    CachedFileSystemStats stats();
+
+    inline FileSystem* source() const { return m_source.get(); }
+
+private:
+    struct Entry {
+        std::vector<uint8_t> bytes;
+        uint64_t hash;
+        bool watched;
+        int64_t lastWriteTime;      //only compared when the file is not watched
+        std::list<std::string>::iterator lruIterator;
+    };
+
+    //returns the cache entry for path, loading it when missing, m_mutex must be held
+    const Entry& fetch(const std::string& path);
+
+    std::string cache_key(const std::string& path) const;
+    void erase(std::unordered_map<std::string, Entry>::iterator it);
+    void trim();
+
+    static int64_t last_write_time(const std::string& key);
+
+    //implemented per platform in cached_file_system.cpp
+    class Watcher;
+
+    //true when changes to the file are reported to on_file_changed
+    bool watch(const std::string& key);
+    //called from the watcher thread with m_mutex held
+    void on_file_changed(const std::string& key);
+    //the changes of the directory were lost, any of its files may have changed
+    void on_directory_changed(const std::string& directory);
+
+private:
+    std::unique_ptr<FileSystem> m_source;
+    size_t m_byteBudget;
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::list<std::string> m_lru;   //front is the most recently used
+    CachedFileSystemStats m_stats;
+
+    std::unique_ptr<Watcher> m_watcher;
+};
+
+}
+
+#endif //EG_CACHED_FILE_SYSTEM_H
@@ -19,6 +19,10 @@
 
 #include <eagle/renderer/renderer_global_definitions.h>
 #include <eagle/renderer/rendering_context.h>
+#include <eagle/renderer/render_graph.h>
+#include <eagle/renderer/instanced_batch_renderer.h>
+#include <eagle/renderer/mip_chain_builder.h>
+#include <eagle/renderer/texture_container.h>
 
 #include <eagle/memory/stack_allocator.h>
 #include <eagle/memory/pool_allocator.h>
@@ -4,4 +4,14 @@
 
 #include "file_system.h"
 
-eagle::FileSystem* eagle::FileSystem::s_instance = nullptr;
\ No newline at end of file
+#include <algorithm>
+
+eagle::FileSystem* eagle::FileSystem::s_instance = nullptr;
+
+std::vector<uint8_t> eagle::FileSystem::read_bytes(const std::string &path, size_t offset, size_t size) {
+    //file systems without random access read the whole file
+    std::vector<uint8_t> bytes = read_bytes(path);
+    offset = std::min(offset, bytes.size());
+    size = std::min(size, bytes.size() - offset);
+    return std::vector<uint8_t>(bytes.begin() + offset, bytes.begin() + offset + size);
+}
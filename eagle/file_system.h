@@ -11,8 +11,12 @@ namespace eagle {
 
 class FileSystem {
 public:
+    virtual ~FileSystem() = default;
+
     static inline FileSystem* instance() { return s_instance; }
     virtual std::vector<uint8_t> read_bytes(const std::string& path) = 0;
+    //size bytes starting at offset, clamped to the end of the file
+    virtual std::vector<uint8_t> read_bytes(const std::string& path, size_t offset, size_t size);
     virtual std::string read_text(const std::string& path) = 0;
 
 protected:
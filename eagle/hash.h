@@ -0,0 +1,24 @@
+#ifndef EAGLE_HASH_H
+#define EAGLE_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace eagle {
+
+constexpr uint64_t FNV1A_OFFSET_BASIS = 14695981039346656037ull;
+constexpr uint64_t FNV1A_PRIME = 1099511628211ull;
+
+//FNV-1a 64, pass the previous result as hash to chain several ranges into one key
+inline uint64_t fnv1a(const void* data, size_t size, uint64_t hash = FNV1A_OFFSET_BASIS) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++){
+        hash ^= bytes[i];
+        hash *= FNV1A_PRIME;
+    }
+    return hash;
+}
+
+}
+
+#endif //EAGLE_HASH_H
@@ -0,0 +1,201 @@
+#include <eagle/pak/pak_archive.h>
+#include <eagle/log.h>
+
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef EG_USE_LZ4
+#include <lz4.h>
+#endif
+
+namespace eagle {
+
+PakArchive::PakArchive(const std::string &path) : m_path(path) {
+    EG_TRACE("eagle","Opening pak archive: {0}", path);
+    map_file();
+    try {
+        validate();
+    }
+    catch (...) {
+        unmap_file();
+        throw;
+    }
+    EG_TRACE("eagle","Pak archive opened with {0} entries!", m_header->entryCount);
+}
+
+PakArchive::~PakArchive() {
+    unmap_file();
+}
+
+void PakArchive::map_file() {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(m_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE){
+        throw std::runtime_error("failed to open pak archive: " + m_path);
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping){
+        CloseHandle(file);
+        throw std::runtime_error("failed to map pak archive: " + m_path);
+    }
+    m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_data){
+        CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("failed to map pak archive: " + m_path);
+    }
+    m_fileHandle = file;
+    m_mappingHandle = mapping;
+    m_size = static_cast<size_t>(size.QuadPart);
+#else
+    m_fd = open(m_path.c_str(), O_RDONLY);
+    if (m_fd < 0){
+        throw std::runtime_error("failed to open pak archive: " + m_path);
+    }
+    struct stat st = {};
+    if (fstat(m_fd, &st) != 0 || st.st_size == 0){
+        close(m_fd);
+        m_fd = -1;
+        throw std::runtime_error("failed to stat pak archive: " + m_path);
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (data == MAP_FAILED){
+        close(m_fd);
+        m_fd = -1;
+        throw std::runtime_error("failed to map pak archive: " + m_path);
+    }
+    m_data = static_cast<const uint8_t*>(data);
+#endif
+}
+
+void PakArchive::unmap_file() {
+#ifdef _WIN32
+    if (m_data){
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mappingHandle){
+        CloseHandle(m_mappingHandle);
+    }
+    if (m_fileHandle){
+        CloseHandle(m_fileHandle);
+    }
+    m_fileHandle = m_mappingHandle = nullptr;
+#else
+    if (m_data){
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+    if (m_fd >= 0){
+        close(m_fd);
+    }
+    m_fd = -1;
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+void PakArchive::validate() {
+    if (m_size < sizeof(PakHeader)){
+        throw std::runtime_error("invalid pak archive (truncated header): " + m_path);
+    }
+    m_header = reinterpret_cast<const PakHeader*>(m_data);
+    if (std::memcmp(m_header->magic, PAK_MAGIC, sizeof(PAK_MAGIC)) != 0){
+        throw std::runtime_error("invalid pak archive (bad magic): " + m_path);
+    }
+    if (m_header->version != PAK_VERSION){
+        throw std::runtime_error("unsupported pak archive version: " + m_path);
+    }
+    if (m_header->fileSize != m_size ||
+        m_header->indexOffset + uint64_t(m_header->entryCount) * sizeof(PakEntry) > m_size ||
+        m_header->stringsOffset + m_header->stringsSize > m_size){
+        throw std::runtime_error("invalid pak archive (truncated): " + m_path);
+    }
+    m_entries = reinterpret_cast<const PakEntry*>(m_data + m_header->indexOffset);
+    m_strings = reinterpret_cast<const char*>(m_data + m_header->stringsOffset);
+    bool hasCompressedEntries = false;
+    for (uint32_t i = 0; i < m_header->entryCount; i++){
+        auto& entry = m_entries[i];
+        if (entry.offset + entry.storedSize > m_header->indexOffset ||
+            uint64_t(entry.pathOffset) + entry.pathLength > m_header->stringsSize){
+            throw std::runtime_error("invalid pak archive (corrupted index): " + m_path);
+        }
+        hasCompressedEntries |= entry.compression == PakCompression::LZ4;
+    }
+    if (hasCompressedEntries && !lz4_supported()){
+        EG_WARNING("eagle", "Pak archive {0} contains LZ4 entries but eagle was built without LZ4 support", m_path);
+    }
+}
+
+const PakEntry* PakArchive::find(const std::string &path) const {
+    std::string normalized = pak::normalize_path(path);
+    uint64_t hash = pak::hash_path(normalized);
+
+    const PakEntry* begin = m_entries;
+    const PakEntry* end = m_entries + m_header->entryCount;
+    auto it = std::lower_bound(begin, end, hash, [](const PakEntry& entry, uint64_t value){
+        return entry.pathHash < value;
+    });
+    for (; it != end && it->pathHash == hash; ++it){
+        if (it->pathLength == normalized.size() &&
+            std::memcmp(m_strings + it->pathOffset, normalized.data(), normalized.size()) == 0){
+            return it;
+        }
+    }
+    return nullptr;
+}
+
+const uint8_t* PakArchive::view(const PakEntry &entry) const {
+    assert(entry.compression == PakCompression::NONE && "Tried to view a compressed pak entry");
+    return m_data + entry.offset;
+}
+
+void PakArchive::read(const PakEntry &entry, uint8_t *dst) const {
+    switch (entry.compression){
+        case PakCompression::NONE:
+            std::memcpy(dst, m_data + entry.offset, entry.size);
+            break;
+        case PakCompression::LZ4: {
+#ifdef EG_USE_LZ4
+            int result = LZ4_decompress_safe(reinterpret_cast<const char*>(m_data + entry.offset),
+                                             reinterpret_cast<char*>(dst),
+                                             static_cast<int>(entry.storedSize),
+                                             static_cast<int>(entry.size));
+            if (result < 0 || static_cast<uint64_t>(result) != entry.size){
+                throw std::runtime_error("failed to decompress pak entry: " + entry_path(entry));
+            }
+            break;
+#else
+            throw std::runtime_error("pak entry is LZ4 compressed but LZ4 support is disabled: " + entry_path(entry));
+#endif
+        }
+        default:
+            throw std::runtime_error("unknown pak entry compression: " + entry_path(entry));
+    }
+}
+
+std::string PakArchive::entry_path(const PakEntry &entry) const {
+    return std::string(m_strings + entry.pathOffset, entry.pathLength);
+}
+
+bool PakArchive::lz4_supported() {
+#ifdef EG_USE_LZ4
+    return true;
+#else
+    return false;
+#endif
+}
+
+}
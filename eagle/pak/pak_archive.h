@@ -0,0 +1,57 @@
+#ifndef EG_PAK_ARCHIVE_H
+#define EG_PAK_ARCHIVE_H
+
+#include <eagle/core_global_definitions.h>
+#include <eagle/pak/pak_format.h>
+
+namespace eagle {
+
+//read only view over a memory mapped .pak file
+class PakArchive {
+public:
+    explicit PakArchive(const std::string& path);
+    ~PakArchive();
+
+    PakArchive(const PakArchive&) = delete;
+    PakArchive& operator=(const PakArchive&) = delete;
+
+    const PakEntry* find(const std::string& path) const;
+
+    //returns a pointer into the mapped file, only valid for uncompressed entries
+    const uint8_t* view(const PakEntry& entry) const;
+
+    //decompresses if needed, uncompressed entries are a single memcpy from the mapping
+    void read(const PakEntry& entry, uint8_t* dst) const;
+
+    std::string entry_path(const PakEntry& entry) const;
+
+    inline uint32_t entry_count() const { return m_header->entryCount; }
+    inline const PakEntry* entries() const { return m_entries; }
+    inline const std::string& path() const { return m_path; }
+
+    static bool lz4_supported();
+
+private:
+    void map_file();
+    void unmap_file();
+    void validate();
+
+private:
+    std::string m_path;
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    const PakHeader* m_header = nullptr;
+    const PakEntry* m_entries = nullptr;
+    const char* m_strings = nullptr;
+
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
+
+}
+
+#endif //EG_PAK_ARCHIVE_H
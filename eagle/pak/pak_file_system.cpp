@@ -0,0 +1,67 @@
+#include <eagle/pak/pak_file_system.h>
+
+#include <algorithm>
+
+namespace eagle {
+
+void PakFileSystem::init(const std::string &pakPath, const std::string &mountPoint) {
+    s_instance = new PakFileSystem(pakPath, mountPoint);
+}
+
+PakFileSystem::PakFileSystem(const std::string &pakPath, const std::string &mountPoint) :
+    m_archive(pakPath),
+    m_mountPoint(pak::normalize_path(mountPoint)) {
+    if (!m_mountPoint.empty() && m_mountPoint.back() != '/'){
+        m_mountPoint += '/';
+    }
+}
+
+std::string PakFileSystem::archive_path(const std::string &path) const {
+    std::string normalized = pak::normalize_path(path);
+    if (!m_mountPoint.empty() && normalized.compare(0, m_mountPoint.size(), m_mountPoint) == 0){
+        normalized.erase(0, m_mountPoint.size());
+    }
+    return normalized;
+}
+
+const PakEntry& PakFileSystem::find_entry(const std::string &path) const {
+    auto entry = m_archive.find(archive_path(path));
+    if (!entry){
+        throw std::runtime_error("failed to open file: " + path);
+    }
+    return *entry;
+}
+
+bool PakFileSystem::exists(const std::string &path) const {
+    return m_archive.find(archive_path(path)) != nullptr;
+}
+
+std::vector<uint8_t> PakFileSystem::read_bytes(const std::string &path) {
+    auto& entry = find_entry(path);
+    std::vector<uint8_t> bytes(entry.size);
+    m_archive.read(entry, bytes.data());
+    return bytes;
+}
+
+std::vector<uint8_t> PakFileSystem::read_bytes(const std::string &path, size_t offset, size_t size) {
+    auto& entry = find_entry(path);
+    if (entry.compression != PakCompression::NONE){
+        return FileSystem::read_bytes(path, offset, size);
+    }
+    offset = std::min<size_t>(offset, entry.size);
+    size = std::min<size_t>(size, entry.size - offset);
+    const uint8_t* data = m_archive.view(entry) + offset;
+    return std::vector<uint8_t>(data, data + size);
+}
+
+std::string PakFileSystem::read_text(const std::string &path) {
+    auto& entry = find_entry(path);
+    if (entry.compression == PakCompression::NONE){
+        return std::string(reinterpret_cast<const char*>(m_archive.view(entry)), entry.size);
+    }
+    std::string text(entry.size, '\0');
+    m_archive.read(entry, reinterpret_cast<uint8_t*>(&text[0]));
+    return text;
+}
+
+}
@@ -0,0 +1,36 @@
+#ifndef EG_PAK_FILE_SYSTEM_H
+#define EG_PAK_FILE_SYSTEM_H
+
+#include <eagle/file_system.h>
+#include <eagle/pak/pak_archive.h>
+
+namespace eagle {
+
+class PakFileSystem : public FileSystem {
+public:
+    //mountPoint is stripped from requested paths, so PROJECT_ROOT based paths resolve inside the archive
+    static void init(const std::string& pakPath, const std::string& mountPoint = "");
+
+    PakFileSystem(const std::string& pakPath, const std::string& mountPoint);
+
+    std::vector<uint8_t> read_bytes(const std::string &path) override;
+    //stored entries are copied from the mapping, compressed ones have to be decompressed whole
+    std::vector<uint8_t> read_bytes(const std::string &path, size_t offset, size_t size) override;
+    std::string read_text(const std::string& path) override;
+
+    bool exists(const std::string& path) const;
+
+    inline const PakArchive& archive() const { return m_archive; }
+
+private:
+    std::string archive_path(const std::string& path) const;
+    const PakEntry& find_entry(const std::string& path) const;
+
+private:
+    PakArchive m_archive;
+    std::string m_mountPoint;
+};
+
+}
+
+#endif //EG_PAK_FILE_SYSTEM_H
@@ -0,0 +1,89 @@
+#ifndef EG_PAK_FORMAT_H
+#define EG_PAK_FORMAT_H
+
+#include <eagle/hash.h>
+
+#include <cstdint>
+#include <string>
+
+namespace eagle {
+
+// On disk layout of a .pak archive:
+//
+// [PakHeader][entry data, each entry aligned to PAK_ALIGNMENT]...[PakEntry index][path strings]
+//
+// The index is sorted by path hash so lookups are a binary search over the mapped file,
+// path strings are kept to resolve hash collisions.
+
+static constexpr char PAK_MAGIC[4] = {'E', 'P', 'A', 'K'};
+static constexpr uint32_t PAK_VERSION = 1;
+static constexpr uint64_t PAK_ALIGNMENT = 64;
+
+enum class PakCompression : uint32_t {
+    NONE = 0,
+    LZ4 = 1
+};
+
+struct PakHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+    uint64_t indexOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    uint64_t fileSize;
+    uint8_t padding[16];
+};
+static_assert(sizeof(PakHeader) == PAK_ALIGNMENT, "PakHeader must be 64 bytes");
+
+struct PakEntry {
+    uint64_t pathHash;
+    uint64_t offset;
+    uint64_t size;              //uncompressed size
+    uint64_t storedSize;        //size in the archive
+    uint32_t pathOffset;
+    uint32_t pathLength;
+    PakCompression compression;
+    uint32_t reserved;
+};
+static_assert(sizeof(PakEntry) == 48, "PakEntry layout changed, bump PAK_VERSION");
+
+namespace pak {
+
+inline uint64_t align_up(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+//forward slashes only, no leading "./" or "/"
+inline std::string normalize_path(const std::string& path) {
+    std::string normalized(path);
+    for (auto& c : normalized){
+        if (c == '\\'){
+            c = '/';
+        }
+    }
+    size_t start = 0;
+    while (start < normalized.size()){
+        if (normalized.compare(start, 2, "./") == 0){
+            start += 2;
+        }
+        else if (normalized[start] == '/'){
+            start++;
+        }
+        else {
+            break;
+        }
+    }
+    return normalized.substr(start);
+}
+
+inline uint64_t hash_path(const std::string& normalizedPath) {
+    return fnv1a(normalizedPath.data(), normalizedPath.size());
+}
+
+}
+
+}
+
+#endif //EG_PAK_FORMAT_H
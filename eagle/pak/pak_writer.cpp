@@ -0,0 +1,133 @@
+#include <eagle/pak/pak_writer.h>
+#include <eagle/pak/pak_archive.h>
+#include <eagle/log.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef EG_USE_LZ4
+#include <lz4.h>
+#endif
+
+namespace eagle {
+
+PakWriter::PakWriter(const PakWriterCreateInfo &createInfo) : m_createInfo(createInfo) {
+    if (m_createInfo.compress && !PakArchive::lz4_supported()){
+        EG_WARNING("eagle", "LZ4 support is disabled, pak entries will be stored uncompressed");
+        m_createInfo.compress = false;
+    }
+}
+
+void PakWriter::add(const std::string &path, std::vector<uint8_t> &&bytes) {
+    std::string normalized = pak::normalize_path(path);
+    auto it = std::find_if(m_files.begin(), m_files.end(), [&normalized](const PendingFile& file){
+        return file.path == normalized;
+    });
+    if (it != m_files.end()){
+        throw std::runtime_error("duplicated pak entry: " + normalized);
+    }
+    m_files.emplace_back(PendingFile{normalized, pak::hash_path(normalized), std::move(bytes)});
+}
+
+void PakWriter::add_directory(const std::string &directory) {
+    namespace fs = std::filesystem;
+    fs::path root(directory);
+    if (!fs::is_directory(root)){
+        throw std::runtime_error("failed to open directory: " + directory);
+    }
+    for (auto& item : fs::recursive_directory_iterator(root)){
+        if (!item.is_regular_file()){
+            continue;
+        }
+        std::ifstream is(item.path(), std::ios::binary);
+        if (!is.is_open()){
+            throw std::runtime_error("failed to open file: " + item.path().string());
+        }
+        std::vector<uint8_t> bytes(static_cast<size_t>(item.file_size()));
+        is.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+        add(fs::relative(item.path(), root).generic_string(), std::move(bytes));
+    }
+}
+
+void PakWriter::write(const std::string &path) {
+    EG_TRACE("eagle","Writing pak archive: {0}", path);
+
+    std::sort(m_files.begin(), m_files.end(), [](const PendingFile& a, const PendingFile& b){
+        return a.hash < b.hash || (a.hash == b.hash && a.path < b.path);
+    });
+
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    if (!os.is_open()){
+        throw std::runtime_error("failed to create pak archive: " + path);
+    }
+
+    static const uint8_t zeros[PAK_ALIGNMENT] = {};
+    auto pad_to = [&os](uint64_t offset){
+        uint64_t current = static_cast<uint64_t>(os.tellp());
+        assert(offset >= current && offset - current <= PAK_ALIGNMENT);
+        os.write(reinterpret_cast<const char*>(zeros), offset - current);
+    };
+
+    PakHeader header = {};
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<PakEntry> entries;
+    entries.reserve(m_files.size());
+    std::string strings;
+    std::vector<char> compressed;
+
+    uint64_t offset = sizeof(PakHeader);
+    for (auto& file : m_files){
+        PakEntry entry = {};
+        entry.pathHash = file.hash;
+        entry.offset = offset;
+        entry.size = file.bytes.size();
+        entry.pathOffset = static_cast<uint32_t>(strings.size());
+        entry.pathLength = static_cast<uint32_t>(file.path.size());
+        entry.compression = PakCompression::NONE;
+        strings += file.path;
+
+        const char* data = reinterpret_cast<const char*>(file.bytes.data());
+        uint64_t storedSize = file.bytes.size();
+
+#ifdef EG_USE_LZ4
+        if (m_createInfo.compress && !file.bytes.empty()){
+            compressed.resize(LZ4_compressBound(static_cast<int>(file.bytes.size())));
+            int compressedSize = LZ4_compress_default(data, compressed.data(),
+                                                      static_cast<int>(file.bytes.size()),
+                                                      static_cast<int>(compressed.size()));
+            if (compressedSize > 0 && compressedSize < file.bytes.size() * m_createInfo.minCompressionRatio){
+                entry.compression = PakCompression::LZ4;
+                data = compressed.data();
+                storedSize = static_cast<uint64_t>(compressedSize);
+            }
+        }
+#endif
+        entry.storedSize = storedSize;
+        os.write(data, storedSize);
+        offset = pak::align_up(offset + storedSize, PAK_ALIGNMENT);
+        pad_to(offset);
+        entries.emplace_back(entry);
+    }
+
+    header.indexOffset = offset;
+    os.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(PakEntry));
+    header.stringsOffset = header.indexOffset + entries.size() * sizeof(PakEntry);
+    header.stringsSize = strings.size();
+    os.write(strings.data(), strings.size());
+
+    std::memcpy(header.magic, PAK_MAGIC, sizeof(PAK_MAGIC));
+    header.version = PAK_VERSION;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    header.fileSize = header.stringsOffset + header.stringsSize;
+    os.seekp(0);
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (!os.good()){
+        throw std::runtime_error("failed to write pak archive: " + path);
+    }
+    EG_TRACE("eagle","Pak archive written with {0} entries!", entries.size());
+}
+
+}
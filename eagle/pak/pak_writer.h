@@ -0,0 +1,41 @@
+#ifndef EG_PAK_WRITER_H
+#define EG_PAK_WRITER_H
+
+#include <eagle/core_global_definitions.h>
+#include <eagle/pak/pak_format.h>
+
+namespace eagle {
+
+struct PakWriterCreateInfo {
+    bool compress = true;
+    //entries that do not shrink below this ratio are stored uncompressed so they can be read without decoding
+    float minCompressionRatio = 0.9f;
+};
+
+class PakWriter {
+public:
+    explicit PakWriter(const PakWriterCreateInfo& createInfo = {});
+
+    void add(const std::string& path, std::vector<uint8_t>&& bytes);
+
+    //adds every regular file under directory, using paths relative to it
+    void add_directory(const std::string& directory);
+
+    void write(const std::string& path);
+
+    inline size_t entry_count() const { return m_files.size(); }
+
+private:
+    struct PendingFile {
+        std::string path;
+        uint64_t hash;
+        std::vector<uint8_t> bytes;
+    };
+
+    PakWriterCreateInfo m_createInfo;
+    std::vector<PendingFile> m_files;
+};
+
+}
+
+#endif //EG_PAK_WRITER_H
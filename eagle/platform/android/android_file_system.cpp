@@ -4,6 +4,7 @@
 
 #include "android_file_system.h"
 #include <android/asset_manager.h>
+#include <algorithm>
 
 void eagle::AndroidFileSystem::init(AAssetManager *assetManager) {
     s_instance = new AndroidFileSystem(assetManager);
@@ -24,6 +25,20 @@ std::vector<uint8_t> eagle::AndroidFileSystem::read_bytes(const std::string &pat
     return std::move(bytes);
 }
 
+std::vector<uint8_t> eagle::AndroidFileSystem::read_bytes(const std::string &path, size_t offset, size_t size) {
+    AAsset* asset = AAssetManager_open(m_assetManager, path.c_str(), AASSET_MODE_RANDOM);
+    if (!asset){
+        throw std::runtime_error("failed to open file: " + path);
+    }
+    size_t assetSize = AAsset_getLength(asset);
+    offset = std::min(offset, assetSize);
+    std::vector<uint8_t> bytes(std::min(size, assetSize - offset));
+    AAsset_seek(asset, offset, SEEK_SET);
+    AAsset_read(asset, bytes.data(), bytes.size());
+    AAsset_close(asset);
+    return bytes;
+}
+
 std::string eagle::AndroidFileSystem::read_text(const std::string &path) {
     std::vector<uint8_t> bytes = std::move(read_bytes(path));
     return std::string(bytes.begin(), bytes.end());
@@ -16,6 +16,7 @@ public:
     static void init(AAssetManager* assetManager);
 
     std::vector<uint8_t> read_bytes(const std::string &path) override;
+    std::vector<uint8_t> read_bytes(const std::string &path, size_t offset, size_t size) override;
     std::string read_text(const std::string &path) override;
 private:
     AndroidFileSystem(AAssetManager* assetManager);
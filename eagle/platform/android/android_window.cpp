@@ -9,6 +9,7 @@
 eagle::AndroidWindow::AndroidWindow(android_app *androidApp) :
     m_androidApp(androidApp) {
     m_renderingContext = std::make_shared<VulkanContextAndroid>(this);
+    m_renderingContext->set_pipeline_cache_path(std::string(androidApp->activity->internalDataPath) + "/pipeline_cache.bin");
 }
 
 eagle::AndroidWindow::~AndroidWindow() {
@@ -10,6 +10,7 @@
 #include "eagle/application_delegate.h"
 #include "eagle/platform/desktop/desktop_window_glfw.h"
 #include "desktop_file_system.h"
+#include "eagle/cached_file_system.h"
 
 namespace eagle {
 
@@ -18,6 +19,7 @@ DesktopApplication::DesktopApplication(uint32_t width, uint32_t height, Applicat
     m_delegate = std::shared_ptr<ApplicationDelegate>(delegate);
     m_window = std::make_shared<DesktopWindowGLFW>(width, height);
     DesktopFileSystem::init();
+    CachedFileSystem::init();
 }
 
 void DesktopApplication::run() {
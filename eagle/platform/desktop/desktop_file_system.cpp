@@ -4,6 +4,7 @@
 
 #include "desktop_file_system.h"
 #include <fstream>
+#include <algorithm>
 
 using namespace eagle;
 
@@ -25,6 +26,20 @@ std::vector<uint8_t> eagle::DesktopFileSystem::read_bytes(const std::string &pat
     return std::move(bytes);
 }
 
+std::vector<uint8_t> DesktopFileSystem::read_bytes(const std::string &path, size_t offset, size_t size) {
+    std::ifstream is(path, std::ios::binary | std::ios::in | std::ios::ate);
+
+    if (!is.is_open()) {
+        throw std::runtime_error("failed to open file: " + path);
+    }
+    size_t fileSize = is.tellg();
+    offset = std::min(offset, fileSize);
+    std::vector<uint8_t> bytes(std::min(size, fileSize - offset));
+    is.seekg(offset, std::ios::beg);
+    is.read((char*)bytes.data(), bytes.size());
+    return bytes;
+}
+
 std::string DesktopFileSystem::read_text(const std::string &path) {
     std::ifstream file(path);
     if (!file.is_open()) {
@@ -13,6 +13,7 @@ class DesktopFileSystem : public FileSystem {
 public:
     static void init();
     std::vector<uint8_t> read_bytes(const std::string &path) override;
+    std::vector<uint8_t> read_bytes(const std::string &path, size_t offset, size_t size) override;
     std::string read_text(const std::string& path) override;
 };
 
@@ -11,10 +11,14 @@
 #include "vertex_buffer.h"
 #include "index_buffer.h"
 #include "uniform_buffer.h"
+#include "dynamic_uniform_buffer.h"
+#include "storage_buffer.h"
+#include "image.h"
 #include "descriptor_set.h"
 #include "render_target.h"
 #include "render_pass.h"
 #include "framebuffer.h"
+#include "gpu_zone.h"
 
 namespace eagle {
 
@@ -24,8 +28,24 @@ enum class CommandBufferLevel {
     SECONDARY
 };
 
+struct ImageBarrier {
+    std::shared_ptr<Image> image;
+    ImageLayout oldLayout = ImageLayout::UNDEFINED;
+    ImageLayout newLayout = ImageLayout::UNDEFINED;
+    std::vector<Access> srcAccess;
+    std::vector<Access> dstAccess;
+};
+
+struct BufferBarrier {
+    std::shared_ptr<StorageBuffer> buffer;
+    std::vector<Access> srcAccess;
+    std::vector<Access> dstAccess;
+};
+
 struct CommandBufferCreateInfo {
     CommandBufferLevel level = CommandBufferLevel::MASTER;
+    //recorded again every frame it is used in, its commands are only valid for the frame they were recorded in
+    bool transient = false;
 };
 
 class CommandBuffer {
@@ -55,6 +75,10 @@ public:
     virtual void
     bind_vertex_buffer(const std::shared_ptr<VertexBuffer> &vertexBuffer) = 0;
 
+    //binds vertex data from RenderingContext::allocate_frame_vertices
+    virtual void
+    bind_vertex_buffer(const FrameAllocation &allocation, uint32_t binding) = 0;
+
     virtual void
     bind_index_buffer(const std::shared_ptr<IndexBuffer> &indexBuffer) = 0;
 
@@ -64,9 +88,21 @@ public:
     virtual void
     draw_indexed(uint32_t indicesCount, uint32_t indexOffset, uint32_t vertexOffset) = 0;
 
+    virtual void
+    draw_instanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) = 0;
+
+    virtual void
+    draw_indexed_instanced(uint32_t indicesCount, uint32_t instanceCount, uint32_t indexOffset, uint32_t vertexOffset,
+                           uint32_t firstInstance) = 0;
+
     virtual void
     bind_descriptor_sets(const std::shared_ptr<DescriptorSet> &descriptorSet, uint32_t setIndex) = 0;
 
+    //one offset per UNIFORM_BUFFER_DYNAMIC binding of the set, in binding order (see DynamicUniformBuffer)
+    virtual void
+    bind_descriptor_sets(const std::shared_ptr<DescriptorSet> &descriptorSet, uint32_t setIndex,
+                         const std::vector<uint32_t>& dynamicOffsets) = 0;
+
     virtual void
     bind_descriptor_sets(const std::shared_ptr<ComputeShader> &shader, const std::shared_ptr<DescriptorSet> &descriptorSet,
                                       uint32_t setIndex) = 0;
@@ -87,14 +123,72 @@ public:
     pipeline_barrier(const std::shared_ptr<Image> &image, const std::vector<PipelineStage> &srcPipelineStages,
                      const std::vector<PipelineStage> &dstPipelineStages) = 0;
 
+    //a single barrier for any number of images and buffers, without memory barriers it is an execution dependency only
+    virtual void
+    pipeline_barrier(const std::vector<PipelineStage> &srcPipelineStages, const std::vector<PipelineStage> &dstPipelineStages,
+                     const std::vector<ImageBarrier> &imageBarriers, const std::vector<BufferBarrier> &bufferBarriers) = 0;
+
     virtual void
     dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) = 0;
 
+    //argument buffers are storage buffers holding DrawIndirectCommand, DrawIndexedIndirectCommand or
+    //DispatchIndirectCommand structs, offsets are in bytes. They can be written by compute shaders
+    virtual void
+    draw_indirect(const std::shared_ptr<StorageBuffer> &buffer, size_t offset, uint32_t drawCount,
+                  uint32_t stride = sizeof(DrawIndirectCommand)) = 0;
+
+    virtual void
+    draw_indexed_indirect(const std::shared_ptr<StorageBuffer> &buffer, size_t offset, uint32_t drawCount,
+                          uint32_t stride = sizeof(DrawIndexedIndirectCommand)) = 0;
+
+    //the draw count is read by the GPU from a uint32_t in countBuffer, clamped to maxDrawCount.
+    //only valid when supports_indirect_count returns true
+    virtual void
+    draw_indirect_count(const std::shared_ptr<StorageBuffer> &buffer, size_t offset,
+                        const std::shared_ptr<StorageBuffer> &countBuffer, size_t countOffset, uint32_t maxDrawCount,
+                        uint32_t stride = sizeof(DrawIndirectCommand)) = 0;
+
+    virtual void
+    draw_indexed_indirect_count(const std::shared_ptr<StorageBuffer> &buffer, size_t offset,
+                                const std::shared_ptr<StorageBuffer> &countBuffer, size_t countOffset, uint32_t maxDrawCount,
+                                uint32_t stride = sizeof(DrawIndexedIndirectCommand)) = 0;
+
+    virtual bool
+    supports_indirect_count() const = 0;
+
+    virtual void
+    dispatch_indirect(const std::shared_ptr<StorageBuffer> &buffer, size_t offset) = 0;
+
+    //times the commands recorded until the matching end_gpu_zone, zones can be nested.
+    //results show up in RenderingContext::gpu_zone_timings once the frame has finished on the GPU.
+    //pipelineStatistics is only honored for the outermost zone of a primary command buffer, that zone has to begin
+    //and end on the same side of a render pass and can't enclose execute_commands
+    virtual void
+    begin_gpu_zone(const std::string& name, bool pipelineStatistics = false) = 0;
+
+    virtual void
+    end_gpu_zone() = 0;
+
 protected:
     CommandBufferCreateInfo m_createInfo;
 
 };
 
+class GpuZoneScope {
+public:
+    GpuZoneScope(CommandBuffer& commandBuffer, const std::string& name, bool pipelineStatistics = false) :
+        m_commandBuffer(commandBuffer) {
+        m_commandBuffer.begin_gpu_zone(name, pipelineStatistics);
+    }
+    ~GpuZoneScope() { m_commandBuffer.end_gpu_zone(); }
+
+    GpuZoneScope(const GpuZoneScope&) = delete;
+    GpuZoneScope& operator=(const GpuZoneScope&) = delete;
+
+private:
+    CommandBuffer& m_commandBuffer;
+};
+
 }
 
 #endif //EAGLE_COMMANDBUFFER_H
@@ -17,14 +17,21 @@ public:
     ComputeShader() = default;
     virtual ~ComputeShader() = default;
 
+    //recorded and submitted without waiting on the GPU, the current frame's graphics submission waits on it
     virtual void dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) = 0;
 
+    //orders the next dispatches after the previous frame's graphics. Only needed when the shader writes resources
+    //graphics reads that aren't duplicated per swapchain image, since those are already waited on by prepare_frame
+    inline void set_wait_for_graphics(bool waitForGraphics) { m_waitForGraphics = waitForGraphics; }
+
     virtual void update_descriptor_items(const std::vector<std::shared_ptr<DescriptorItem>>& descriptorItems) = 0;
     virtual void set_image(const std::string& name, const std::shared_ptr<Image>& image) = 0;
 
     virtual void create_pipeline() = 0;
     virtual void cleanup_pipeline() = 0;
 
+protected:
+    bool m_waitForGraphics = false;
 };
 
 }
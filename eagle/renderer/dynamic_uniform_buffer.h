@@ -0,0 +1,37 @@
+#ifndef EAGLE_DYNAMICUNIFORMBUFFER_H
+#define EAGLE_DYNAMICUNIFORMBUFFER_H
+
+#include "descriptor_item.h"
+
+#include <cstring>
+
+namespace eagle {
+
+//Uniform block whose contents are written every frame into the context's per frame ring, bound with a dynamic offset.
+//The descriptor never changes, so one descriptor set can be rebound with a different offset per object.
+//Allocations are valid until the end of the frame they were made in.
+class DynamicUniformBuffer : public DescriptorItem {
+public:
+    explicit DynamicUniformBuffer(size_t blockSize) : m_blockSize(blockSize) {}
+    virtual ~DynamicUniformBuffer() = default;
+
+    DescriptorType type() const override { return DescriptorType::UNIFORM_BUFFER_DYNAMIC; }
+
+    //room for one block in the current frame, thread safe. The offset is the dynamic offset to bind it with
+    virtual FrameAllocation allocate() = 0;
+
+    inline uint32_t push(const void* data) {
+        FrameAllocation allocation = allocate();
+        std::memcpy(allocation.data, data, m_blockSize);
+        return allocation.offset;
+    }
+
+    inline size_t block_size() const { return m_blockSize; }
+
+protected:
+    size_t m_blockSize;
+};
+
+}
+
+#endif //EAGLE_DYNAMICUNIFORMBUFFER_H
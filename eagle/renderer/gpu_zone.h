@@ -0,0 +1,29 @@
+#ifndef EAGLE_GPUZONE_H
+#define EAGLE_GPUZONE_H
+
+#include <cstdint>
+#include <string>
+
+namespace eagle {
+
+//only filled for zones that asked for them, when the device supports pipeline statistics queries
+struct GpuPipelineStatistics {
+    uint64_t inputAssemblyVertices = 0;
+    uint64_t vertexShaderInvocations = 0;
+    uint64_t clippingPrimitives = 0;
+    uint64_t fragmentShaderInvocations = 0;
+    uint64_t computeShaderInvocations = 0;
+};
+
+struct GpuZoneTiming {
+    std::string name;
+    //how many zones enclose this one in its command buffer
+    uint32_t depth = 0;
+    float milliseconds = 0.0f;
+    bool hasStatistics = false;
+    GpuPipelineStatistics statistics;
+};
+
+}
+
+#endif //EAGLE_GPUZONE_H
@@ -24,6 +24,9 @@ public:
     uint32_t capacity() const { return m_capacity; }
 
     virtual void upload() = 0;
+
+    //false while the buffer contents are still being uploaded asynchronously
+    virtual bool is_ready() const { return true; }
 protected:
     uint8_t* m_data = nullptr;
     uint32_t m_size = 0;
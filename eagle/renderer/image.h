@@ -22,6 +22,12 @@ struct ImageCreateInfo {
     std::vector<ImageAspect> aspects;
 };
 
+//what an image needs from an allocation it shares with other images
+struct ImageMemoryRequirements {
+    uint64_t size = 0;
+    uint64_t alignment = 1;
+};
+
 class Image : public DescriptorItem {
 public:
 
@@ -41,6 +47,8 @@ public:
     inline const std::vector<MemoryProperty>& memory_properties() const { return m_createInfo.memoryProperties; }
     inline const std::vector<ImageAspect>& aspects() const { return m_createInfo.aspects; }
     inline const std::vector<unsigned char>& data() const { return m_createInfo.bufferData; }
+    //false while the image contents are still being uploaded asynchronously
+    virtual bool is_ready() const { return true; }
     inline void resize(uint32_t width, uint32_t height) {
         m_createInfo.width = width;
         m_createInfo.height = height;
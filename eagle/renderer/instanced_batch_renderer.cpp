@@ -0,0 +1,138 @@
+#include <eagle/renderer/instanced_batch_renderer.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace eagle {
+
+size_t InstancedBatchRenderer::BatchKeyHash::operator()(const BatchKey &key) const {
+    size_t hash = std::hash<const void*>()(key.shader);
+    hash ^= std::hash<const void*>()(key.vertexBuffer) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<const void*>()(key.indexBuffer) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<uint32_t>()(key.indexCount) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+InstancedBatchRenderer::InstancedBatchRenderer(RenderingContext *context) : m_context(context) {}
+
+VertexLayout InstancedBatchRenderer::instance_layout(const VertexLayout &meshLayout) {
+    VertexLayout layout = meshLayout;
+    VertexInputBindingDescription instanceBinding = {};
+    instanceBinding.inputRate = VertexInputRate::INSTANCE;
+    //a mat4 takes one location per column
+    instanceBinding.attributes = {
+            Format::R32G32B32A32_SFLOAT,
+            Format::R32G32B32A32_SFLOAT,
+            Format::R32G32B32A32_SFLOAT,
+            Format::R32G32B32A32_SFLOAT,
+            Format::R32G32B32A32_SFLOAT
+    };
+    layout.add(instanceBinding);
+    return layout;
+}
+
+void InstancedBatchRenderer::begin() {
+    auto unused = std::remove_if(m_batches.begin(), m_batches.end(), [](const Batch& batch){
+        return batch.instances.empty();
+    });
+    if (unused != m_batches.end()){
+        m_batches.erase(unused, m_batches.end());
+        m_batchIndices.clear();
+        for (size_t i = 0; i < m_batches.size(); i++){
+            Batch& batch = m_batches[i];
+            BatchKey key = {batch.shader.get(), batch.mesh.vertexBuffer.get(), batch.mesh.indexBuffer.get(), batch.mesh.indexCount};
+            m_batchIndices.emplace(key, i);
+        }
+    }
+    for (auto& batch : m_batches){
+        batch.instances.clear();
+    }
+    m_stats = {};
+}
+
+InstancedBatchRenderer::Batch &InstancedBatchRenderer::find_batch(const std::shared_ptr<Shader> &shader, const InstancedMesh &mesh) {
+    BatchKey key = {shader.get(), mesh.vertexBuffer.get(), mesh.indexBuffer.get(), mesh.indexCount};
+    auto it = m_batchIndices.find(key);
+    if (it != m_batchIndices.end()){
+        return m_batches[it->second];
+    }
+    //instance_layout appends the instance binding after the mesh's bindings
+    auto& bindings = shader->create_info().vertexLayout.bindings();
+    if (bindings.empty() || bindings.back().inputRate != VertexInputRate::INSTANCE){
+        throw std::runtime_error("instanced batch shader must use InstancedBatchRenderer::instance_layout!");
+    }
+    m_batchIndices.emplace(key, m_batches.size());
+    m_batches.emplace_back();
+    Batch& batch = m_batches.back();
+    batch.shader = shader;
+    batch.mesh = mesh;
+    batch.instanceBinding = static_cast<uint32_t>(bindings.size() - 1);
+    return batch;
+}
+
+void InstancedBatchRenderer::submit(const std::shared_ptr<Shader> &shader, const InstancedMesh &mesh, const InstanceData &instance) {
+    find_batch(shader, mesh).instances.emplace_back(instance);
+}
+
+void InstancedBatchRenderer::submit(const std::shared_ptr<Shader> &shader, const InstancedMesh &mesh,
+                                    const InstanceData *instances, size_t count) {
+    auto& batchInstances = find_batch(shader, mesh).instances;
+    batchInstances.insert(batchInstances.end(), instances, instances + count);
+}
+
+void InstancedBatchRenderer::flush(CommandBuffer &commandBuffer) {
+    m_drawOrder.clear();
+    size_t instanceCount = 0;
+    for (size_t i = 0; i < m_batches.size(); i++){
+        if (!m_batches[i].instances.empty()){
+            m_drawOrder.emplace_back(i);
+            instanceCount += m_batches[i].instances.size();
+        }
+    }
+    if (instanceCount == 0){
+        return;
+    }
+    std::sort(m_drawOrder.begin(), m_drawOrder.end(), [this](size_t a, size_t b){
+        return m_batches[a].shader.get() < m_batches[b].shader.get();
+    });
+
+    //one allocation for the whole frame, batches are laid out in draw order
+    FrameAllocation allocation = m_context->allocate_frame_vertices(instanceCount * sizeof(InstanceData));
+    auto stream = static_cast<InstanceData*>(allocation.data);
+
+    const Shader* boundShader = nullptr;
+    uint32_t boundInstanceBinding = UINT32_MAX;
+    const VertexBuffer* boundVertexBuffer = nullptr;
+    const IndexBuffer* boundIndexBuffer = nullptr;
+    uint32_t firstInstance = 0;
+    for (size_t index : m_drawOrder){
+        Batch& batch = m_batches[index];
+        uint32_t count = static_cast<uint32_t>(batch.instances.size());
+        std::memcpy(stream + firstInstance, batch.instances.data(), count * sizeof(InstanceData));
+
+        if (batch.shader.get() != boundShader){
+            commandBuffer.bind_shader(batch.shader);
+            boundShader = batch.shader.get();
+        }
+        if (batch.instanceBinding != boundInstanceBinding){
+            commandBuffer.bind_vertex_buffer(allocation, batch.instanceBinding);
+            boundInstanceBinding = batch.instanceBinding;
+        }
+        if (batch.mesh.vertexBuffer.get() != boundVertexBuffer){
+            commandBuffer.bind_vertex_buffer(batch.mesh.vertexBuffer);
+            boundVertexBuffer = batch.mesh.vertexBuffer.get();
+        }
+        if (batch.mesh.indexBuffer.get() != boundIndexBuffer){
+            commandBuffer.bind_index_buffer(batch.mesh.indexBuffer);
+            boundIndexBuffer = batch.mesh.indexBuffer.get();
+        }
+        commandBuffer.draw_indexed_instanced(batch.mesh.indexCount, count, 0, 0, firstInstance);
+        firstInstance += count;
+    }
+
+    m_stats.batchCount = m_drawOrder.size();
+    m_stats.instanceCount = instanceCount;
+    m_stats.streamBytes = instanceCount * sizeof(InstanceData);
+}
+
+}
@@ -0,0 +1,88 @@
+#ifndef EAGLE_INSTANCEDBATCHRENDERER_H
+#define EAGLE_INSTANCEDBATCHRENDERER_H
+
+#include "rendering_context.h"
+
+#include <unordered_map>
+
+namespace eagle {
+
+//per instance attributes, streamed at the binding after the mesh's (see InstancedBatchRenderer::instance_layout)
+struct InstanceData {
+    float transform[16];    //column major
+    float color[4];
+};
+
+struct InstancedMesh {
+    std::shared_ptr<VertexBuffer> vertexBuffer;
+    std::shared_ptr<IndexBuffer> indexBuffer;
+    uint32_t indexCount = 0;
+};
+
+struct InstancedBatchStats {
+    size_t batchCount = 0;
+    size_t instanceCount = 0;
+    size_t streamBytes = 0;
+};
+
+//Gathers the objects of a frame into batches of the same shader and mesh, then draws each batch with a single
+//instanced draw. The instance attributes of every batch are written back to back into one allocation of the
+//context's frame ring, which is bound once, batches pick their range with firstInstance.
+//Batches are kept across frames so their instance arrays don't reallocate, a batch that receives no instances for a
+//whole frame is dropped so it doesn't keep its shader and mesh alive.
+class InstancedBatchRenderer {
+public:
+    explicit InstancedBatchRenderer(RenderingContext* context);
+
+    //meshLayout followed by the per instance binding at meshLayout.binding_count(), use it to create the batch's shaders
+    static VertexLayout instance_layout(const VertexLayout& meshLayout);
+
+    //forgets last frame's instances and drops the batches that had none
+    void begin();
+
+    void submit(const std::shared_ptr<Shader>& shader, const InstancedMesh& mesh, const InstanceData& instance);
+    void submit(const std::shared_ptr<Shader>& shader, const InstancedMesh& mesh, const InstanceData* instances, size_t count);
+
+    //streams the instances and records one draw per batch, must be inside a render pass
+    void flush(CommandBuffer& commandBuffer);
+
+    inline const InstancedBatchStats& stats() const { return m_stats; }
+
+private:
+    struct Batch {
+        std::shared_ptr<Shader> shader;
+        InstancedMesh mesh;
+        uint32_t instanceBinding;
+        std::vector<InstanceData> instances;
+    };
+
+    struct BatchKey {
+        const Shader* shader;
+        const VertexBuffer* vertexBuffer;
+        const IndexBuffer* indexBuffer;
+        uint32_t indexCount;
+        bool operator==(const BatchKey& other) const {
+            return shader == other.shader && vertexBuffer == other.vertexBuffer &&
+                   indexBuffer == other.indexBuffer && indexCount == other.indexCount;
+        }
+    };
+
+    struct BatchKeyHash {
+        size_t operator()(const BatchKey& key) const;
+    };
+
+private:
+    Batch& find_batch(const std::shared_ptr<Shader>& shader, const InstancedMesh& mesh);
+
+private:
+    RenderingContext* m_context;
+    std::vector<Batch> m_batches;
+    std::unordered_map<BatchKey, size_t, BatchKeyHash> m_batchIndices;
+    //batches with instances this frame, sorted by shader so every shader is bound once
+    std::vector<size_t> m_drawOrder;
+    InstancedBatchStats m_stats;
+};
+
+}
+
+#endif //EAGLE_INSTANCEDBATCHRENDERER_H
@@ -0,0 +1,263 @@
+#include <eagle/renderer/mip_chain_builder.h>
+#include <eagle/worker_pool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EG_MIP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace eagle {
+
+namespace {
+
+constexpr uint32_t PIXEL_SIZE = 4;
+
+//levels with fewer rows are filtered on the calling thread only
+constexpr uint32_t PARALLEL_ROW_THRESHOLD = 64;
+
+constexpr uint32_t LINEAR_TO_SRGB_SIZE = 4096;
+
+struct SrgbTables {
+    float toLinear[256];
+    uint8_t toSrgb[LINEAR_TO_SRGB_SIZE];
+
+    SrgbTables() {
+        for (uint32_t i = 0; i < 256; i++){
+            float c = i / 255.0f;
+            toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (uint32_t i = 0; i < LINEAR_TO_SRGB_SIZE; i++){
+            float l = i / static_cast<float>(LINEAR_TO_SRGB_SIZE - 1);
+            float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            toSrgb[i] = static_cast<uint8_t>(std::min(c * 255.0f + 0.5f, 255.0f));
+        }
+    }
+};
+
+const SrgbTables& srgb_tables() {
+    static SrgbTables tables;
+    return tables;
+}
+
+bool is_srgb(Format format) {
+    return format == Format::R8G8B8A8_SRGB || format == Format::B8G8R8A8_SRGB || format == Format::A8B8G8R8_SRGB_PACK32;
+}
+
+//dst pixels [x, dstWidth) of one row, x1 is clamped for 1 texel wide sources
+void downsample_row_scalar(const uint8_t* row0, const uint8_t* row1, uint32_t srcWidth,
+                           uint8_t* dst, uint32_t x, uint32_t dstWidth, bool srgb) {
+    const SrgbTables& tables = srgb_tables();
+    for (; x < dstWidth; x++){
+        const uint8_t* a0 = row0 + 2 * x * PIXEL_SIZE;
+        const uint8_t* a1 = row0 + std::min(2 * x + 1, srcWidth - 1) * PIXEL_SIZE;
+        const uint8_t* b0 = row1 + 2 * x * PIXEL_SIZE;
+        const uint8_t* b1 = row1 + std::min(2 * x + 1, srcWidth - 1) * PIXEL_SIZE;
+        uint8_t* out = dst + x * PIXEL_SIZE;
+        if (srgb){
+            for (uint32_t c = 0; c < 3; c++){
+                float sum = tables.toLinear[a0[c]] + tables.toLinear[a1[c]] + tables.toLinear[b0[c]] + tables.toLinear[b1[c]];
+                out[c] = tables.toSrgb[static_cast<uint32_t>(sum * 0.25f * (LINEAR_TO_SRGB_SIZE - 1) + 0.5f)];
+            }
+            out[3] = static_cast<uint8_t>((a0[3] + a1[3] + b0[3] + b1[3] + 2) >> 2);
+        }
+        else {
+            for (uint32_t c = 0; c < PIXEL_SIZE; c++){
+                out[c] = static_cast<uint8_t>((a0[c] + a1[c] + b0[c] + b1[c] + 2) >> 2);
+            }
+        }
+    }
+}
+
+#ifdef EG_MIP_SSE2
+
+//4 dst pixels per iteration, channels are widened to 16 bits so the sums can't overflow
+uint32_t downsample_row_unorm_sse2(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, uint32_t dstWidth) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi16(2);
+    uint32_t x = 0;
+    for (; x + 4 <= dstWidth; x += 4){
+        const uint8_t* a = row0 + 2 * x * PIXEL_SIZE;
+        const uint8_t* b = row1 + 2 * x * PIXEL_SIZE;
+        __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+        __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 16));
+        __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+        __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 16));
+
+        //vertical sums, two source pixels per register
+        __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+        __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+        __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+        __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+        //horizontal sums land in the low half of each register
+        s0 = _mm_add_epi16(s0, _mm_srli_si128(s0, 8));
+        s1 = _mm_add_epi16(s1, _mm_srli_si128(s1, 8));
+        s2 = _mm_add_epi16(s2, _mm_srli_si128(s2, 8));
+        s3 = _mm_add_epi16(s3, _mm_srli_si128(s3, 8));
+
+        __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s0, s1), rounding), 2);
+        __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s2, s3), rounding), 2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * PIXEL_SIZE), _mm_packus_epi16(lo, hi));
+    }
+    return x;
+}
+
+inline __m128 load_linear(const uint8_t* pixel, const SrgbTables& tables) {
+    return _mm_set_ps(pixel[3] * (1.0f / 255.0f), tables.toLinear[pixel[2]], tables.toLinear[pixel[1]], tables.toLinear[pixel[0]]);
+}
+
+//decoding goes through the table, the four taps are averaged as one vector
+uint32_t downsample_row_srgb_sse2(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, uint32_t dstWidth) {
+    const SrgbTables& tables = srgb_tables();
+    const __m128 scale = _mm_set_ps(255.0f * 0.25f, (LINEAR_TO_SRGB_SIZE - 1) * 0.25f,
+                                    (LINEAR_TO_SRGB_SIZE - 1) * 0.25f, (LINEAR_TO_SRGB_SIZE - 1) * 0.25f);
+    alignas(16) int32_t indices[4];
+    for (uint32_t x = 0; x < dstWidth; x++){
+        const uint8_t* a = row0 + 2 * x * PIXEL_SIZE;
+        const uint8_t* b = row1 + 2 * x * PIXEL_SIZE;
+        __m128 sum = _mm_add_ps(_mm_add_ps(load_linear(a, tables), load_linear(a + PIXEL_SIZE, tables)),
+                                _mm_add_ps(load_linear(b, tables), load_linear(b + PIXEL_SIZE, tables)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(indices), _mm_cvtps_epi32(_mm_mul_ps(sum, scale)));
+        uint8_t* out = dst + x * PIXEL_SIZE;
+        out[0] = tables.toSrgb[indices[0]];
+        out[1] = tables.toSrgb[indices[1]];
+        out[2] = tables.toSrgb[indices[2]];
+        out[3] = static_cast<uint8_t>(indices[3]);
+    }
+    return dstWidth;
+}
+
+#endif
+
+void downsample_row(const uint8_t* row0, const uint8_t* row1, uint32_t srcWidth, uint8_t* dst, uint32_t dstWidth, bool srgb) {
+    uint32_t x = 0;
+#ifdef EG_MIP_SSE2
+    //every tap is in bounds unless the source is a single column
+    if (srcWidth > 1){
+        x = srgb ? downsample_row_srgb_sse2(row0, row1, dst, dstWidth) : downsample_row_unorm_sse2(row0, row1, dst, dstWidth);
+    }
+#endif
+    downsample_row_scalar(row0, row1, srcWidth, dst, x, dstWidth, srgb);
+}
+
+}
+
+uint32_t MipChainBuilder::level_count(uint32_t width, uint32_t height) {
+    uint32_t levels = 1;
+    uint32_t size = std::max(width, height);
+    while (size > 1){
+        size >>= 1;
+        levels++;
+    }
+    return levels;
+}
+
+bool MipChainBuilder::supports(Format format) {
+    switch (format){
+        case Format::R8G8B8A8_UNORM:
+        case Format::R8G8B8A8_SRGB:
+        case Format::B8G8R8A8_UNORM:
+        case Format::B8G8R8A8_SRGB:
+        case Format::A8B8G8R8_UNORM_PACK32:
+        case Format::A8B8G8R8_SRGB_PACK32:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void MipChainBuilder::downsample(const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight,
+                                 uint8_t *dst, uint32_t dstWidth, uint32_t firstRow, uint32_t rowCount, bool srgb) {
+    size_t srcPitch = static_cast<size_t>(srcWidth) * PIXEL_SIZE;
+    size_t dstPitch = static_cast<size_t>(dstWidth) * PIXEL_SIZE;
+    for (uint32_t y = firstRow; y < firstRow + rowCount; y++){
+        const uint8_t* row0 = src + 2 * y * srcPitch;
+        const uint8_t* row1 = src + std::min(2 * y + 1, srcHeight - 1) * srcPitch;
+        downsample_row(row0, row1, srcWidth, dst + y * dstPitch, dstWidth, srgb);
+    }
+}
+
+void MipChainBuilder::build(ImageCreateInfo &createInfo, WorkerPool *workerPool) {
+    if (!supports(createInfo.format)){
+        throw std::runtime_error("mip chains can only be built for 8 bit RGBA images!");
+    }
+    if (createInfo.mipLevels != 1){
+        throw std::runtime_error("mip chain builder expects a single level image!");
+    }
+
+    uint32_t width = createInfo.width;
+    uint32_t height = createInfo.height;
+    size_t baseSize = static_cast<size_t>(width) * height * PIXEL_SIZE;
+    if (createInfo.bufferData.size() < baseSize){
+        throw std::runtime_error("image buffer data is smaller than its base level!");
+    }
+
+    uint32_t levels = level_count(width, height);
+    size_t totalSize = 0;
+    for (uint32_t level = 0; level < levels; level++){
+        totalSize += static_cast<size_t>(std::max(width >> level, 1u)) * std::max(height >> level, 1u) * PIXEL_SIZE;
+    }
+    createInfo.bufferData.resize(totalSize);
+
+    //a worker waiting on its own pool can take every thread, e.g. when textures are created from pool tasks
+    if (workerPool && workerPool->is_worker_thread()){
+        workerPool = nullptr;
+    }
+
+    bool srgb = is_srgb(createInfo.format);
+    uint8_t* src = createInfo.bufferData.data();
+    for (uint32_t level = 1; level < levels; level++){
+        uint32_t srcWidth = std::max(width >> (level - 1), 1u);
+        uint32_t srcHeight = std::max(height >> (level - 1), 1u);
+        uint32_t dstWidth = std::max(width >> level, 1u);
+        uint32_t dstHeight = std::max(height >> level, 1u);
+        uint8_t* dst = src + static_cast<size_t>(srcWidth) * srcHeight * PIXEL_SIZE;
+
+        if (!workerPool || dstHeight < PARALLEL_ROW_THRESHOLD){
+            downsample(src, srcWidth, srcHeight, dst, dstWidth, 0, dstHeight, srgb);
+            src = dst;
+            continue;
+        }
+
+        //each level reads the previous one, so bands are only parallel within a level
+        uint32_t bandCount = std::min(workerPool->thread_count() + 1, dstHeight);
+        uint32_t rowsPerBand = (dstHeight + bandCount - 1) / bandCount;
+        std::mutex mutex;
+        std::condition_variable finished;
+        uint32_t remaining = 0;
+
+        uint32_t firstRow = rowsPerBand;
+        for (; firstRow < dstHeight; firstRow += rowsPerBand){
+            uint32_t rowCount = std::min(rowsPerBand, dstHeight - firstRow);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                remaining++;
+            }
+            workerPool->submit([&, firstRow, rowCount]{
+                downsample(src, srcWidth, srcHeight, dst, dstWidth, firstRow, rowCount, srgb);
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--remaining == 0){
+                    finished.notify_one();
+                }
+            });
+        }
+
+        //the caller filters the first band instead of idling
+        downsample(src, srcWidth, srcHeight, dst, dstWidth, 0, std::min(rowsPerBand, dstHeight), srgb);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&remaining]{ return remaining == 0; });
+        src = dst;
+    }
+
+    createInfo.mipLevels = levels;
+    //linear images only support a single level
+    createInfo.tiling = ImageTiling::OPTIMAL;
+}
+
+}
@@ -0,0 +1,33 @@
+#ifndef EAGLE_MIPCHAINBUILDER_H
+#define EAGLE_MIPCHAINBUILDER_H
+
+#include "image.h"
+
+namespace eagle {
+
+class WorkerPool;
+
+//Builds the full mip chain of an 8 bit, 4 channel image on the CPU with a 2x2 box filter.
+//sRGB formats are averaged in linear space (alpha stays linear), other formats are averaged as stored.
+//Levels are appended to the image's buffer data back to back, level 0 first, which is the layout
+//VulkanImage expects when mipLevels > 1, so the whole chain goes through a single staging copy.
+class MipChainBuilder {
+public:
+    //levels down to 1x1
+    static uint32_t level_count(uint32_t width, uint32_t height);
+
+    static bool supports(Format format);
+
+    //replaces a single level image with its full chain, rows of large levels are filtered on workerPool when set.
+    //Called from one of workerPool's own tasks it runs inline, waiting on the pool there could deadlock it.
+    //Mip chains need optimal tiling, linear images are switched to it
+    static void build(ImageCreateInfo& createInfo, WorkerPool* workerPool = nullptr);
+
+    //filters rows [firstRow, firstRow + rowCount) of the level below src
+    static void downsample(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight,
+                           uint8_t* dst, uint32_t dstWidth, uint32_t firstRow, uint32_t rowCount, bool srgb);
+};
+
+}
+
+#endif //EAGLE_MIPCHAINBUILDER_H
@@ -0,0 +1,248 @@
+#include <eagle/renderer/render_graph.h>
+#include <eagle/log.h>
+
+#include <algorithm>
+
+namespace eagle {
+
+RenderGraphPassBuilder::RenderGraphPassBuilder(RenderGraph &graph, uint32_t passIndex) :
+    m_graph(graph), m_passIndex(passIndex) {
+
+}
+
+void RenderGraphPassBuilder::read(RenderGraphResource resource, RenderGraphUsage usage) {
+    m_graph.m_planner.add_access(m_passIndex, resource.index, usage, false);
+}
+
+void RenderGraphPassBuilder::write(RenderGraphResource resource, RenderGraphUsage usage) {
+    m_graph.m_planner.add_access(m_passIndex, resource.index, usage, true);
+}
+
+void RenderGraphPassBuilder::side_effect() {
+    m_graph.m_planner.set_side_effect(m_passIndex);
+}
+
+RenderGraph::RenderGraph(RenderingContext *context) :
+    m_context(context) {
+
+}
+
+RenderGraph::~RenderGraph() {
+    for (auto& image : m_physicalImages){
+        if (image){
+            m_context->destroy_image(image);
+        }
+    }
+}
+
+RenderGraphResource RenderGraph::import_image(const std::string &name, const std::shared_ptr<Image> &image,
+                                              ImageLayout initialLayout, ImageLayout finalLayout) {
+    m_planner.import_image(initialLayout, finalLayout);
+    Resource resource;
+    resource.name = name;
+    resource.image = image;
+    m_resources.emplace_back(std::move(resource));
+    m_compiled = false;
+    return {static_cast<uint32_t>(m_resources.size() - 1)};
+}
+
+RenderGraphResource RenderGraph::import_buffer(const std::string &name, const std::shared_ptr<StorageBuffer> &buffer) {
+    m_planner.import_buffer();
+    Resource resource;
+    resource.name = name;
+    resource.buffer = buffer;
+    m_resources.emplace_back(std::move(resource));
+    m_compiled = false;
+    return {static_cast<uint32_t>(m_resources.size() - 1)};
+}
+
+RenderGraphResource RenderGraph::create_image(const std::string &name, const RenderGraphImageDescription &description) {
+    m_planner.create_image(description);
+    Resource resource;
+    resource.name = name;
+    m_resources.emplace_back(std::move(resource));
+    m_compiled = false;
+    return {static_cast<uint32_t>(m_resources.size() - 1)};
+}
+
+void RenderGraph::add_pass(const std::string &name, const RenderGraphSetup &setup, const RenderGraphExecute &execute) {
+    uint32_t passIndex = m_planner.add_pass();
+    Pass pass;
+    pass.name = name;
+    pass.execute = execute;
+    m_passes.emplace_back(std::move(pass));
+    m_compiled = false;
+
+    RenderGraphPassBuilder builder(*this, passIndex);
+    setup(builder);
+}
+
+void RenderGraph::set_output(RenderGraphResource resource) {
+    m_planner.set_output(resource.index);
+    m_compiled = false;
+}
+
+void RenderGraph::compile() {
+    m_planner.plan();
+    create_physical_images();
+
+    auto& plannedPasses = m_planner.passes();
+    for (size_t i = 0; i < m_passes.size(); i++){
+        m_passes[i].barrier = plannedPasses[i].culled ? Barrier{} : resolve_barrier(plannedPasses[i].barrier);
+    }
+    m_finalBarrier = resolve_barrier(m_planner.final_barrier());
+
+    m_compiled = true;
+    auto& stats = m_planner.stats();
+    EG_TRACE("eagle", "Compiled render graph: {0} passes, {1} culled, {2} barriers, {3} transient images on {4} physical images, "
+                      "{5} bytes of images aliased into {6} bytes",
+             stats.passCount, stats.culledPassCount, stats.barrierCount,
+             stats.transientImageCount, stats.physicalImageCount,
+             stats.physicalImageBytes, stats.aliasedMemoryBytes);
+}
+
+void RenderGraph::create_physical_images() {
+    auto& physicalImages = m_planner.physical_images();
+    m_physicalImages.resize(physicalImages.size());
+    m_memoryRequirements.resize(physicalImages.size());
+    m_memoryOffsets.resize(physicalImages.size());
+
+    //placing the images again also computes the barriers between images sharing memory
+    m_planner.place_physical_images(m_memoryRequirements);
+    bool rebuild = false;
+    for (size_t i = 0; i < physicalImages.size(); i++){
+        auto& physical = physicalImages[i];
+        //new images, grown usages or changed lifetimes that moved an image in the shared allocation
+        if (physical.assigned && (physical.recreate || !m_physicalImages[i] || physical.memoryOffset != m_memoryOffsets[i])){
+            rebuild = true;
+        }
+    }
+    if (rebuild){
+        rebuild_physical_images();
+    }
+    m_planner.physical_images_created();
+
+    auto& resources = m_planner.resources();
+    for (size_t i = 0; i < resources.size(); i++){
+        if (!resources[i].imported && resources[i].physical != UINT32_MAX){
+            m_resources[i].image = m_physicalImages[resources[i].physical];
+        }
+    }
+}
+
+void RenderGraph::rebuild_physical_images() {
+    //the images share one allocation so they are created together, the old ones may still be used by frames in flight
+    for (auto& image : m_physicalImages){
+        if (image){
+            m_context->destroy_image(image);
+            image.reset();
+        }
+    }
+
+    auto& physicalImages = m_planner.physical_images();
+    std::vector<ImageCreateInfo> createInfos;
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < physicalImages.size(); i++){
+        auto& physical = physicalImages[i];
+        if (!physical.assigned){
+            continue;
+        }
+        ImageCreateInfo createInfo = {};
+        createInfo.width = physical.description.width;
+        createInfo.height = physical.description.height;
+        createInfo.mipLevels = physical.description.mipLevels;
+        createInfo.arrayLayers = physical.description.arrayLayers;
+        createInfo.format = physical.description.format;
+        createInfo.tiling = ImageTiling::OPTIMAL;
+        createInfo.layout = ImageLayout::UNDEFINED;
+        createInfo.usages = physical.usages;
+        createInfo.memoryProperties = {MemoryProperty::DEVICE_LOCAL};
+        createInfo.aspects = physical.description.aspects;
+        createInfos.emplace_back(createInfo);
+        indices.emplace_back(i);
+    }
+
+    auto images = m_context->create_aliased_images(createInfos, [this, &indices](const std::vector<ImageMemoryRequirements>& requirements){
+        std::fill(m_memoryRequirements.begin(), m_memoryRequirements.end(), ImageMemoryRequirements{});
+        for (size_t i = 0; i < indices.size(); i++){
+            m_memoryRequirements[indices[i]] = requirements[i];
+        }
+        m_planner.place_physical_images(m_memoryRequirements);
+
+        auto& physicalImages = m_planner.physical_images();
+        std::vector<uint64_t> offsets(indices.size());
+        for (size_t i = 0; i < indices.size(); i++){
+            offsets[i] = m_memoryOffsets[indices[i]] = physicalImages[indices[i]].memoryOffset;
+        }
+        return offsets;
+    });
+    for (size_t i = 0; i < indices.size(); i++){
+        m_physicalImages[indices[i]] = images[i].lock();
+    }
+}
+
+RenderGraph::Barrier RenderGraph::resolve_barrier(const RenderGraphPlanner::Barrier &planned) const {
+    Barrier barrier;
+    barrier.srcStages = planned.srcStages;
+    barrier.dstStages = planned.dstStages;
+    barrier.imageBarriers.reserve(planned.images.size());
+    for (auto& transition : planned.images){
+        ImageBarrier imageBarrier;
+        imageBarrier.image = m_resources[transition.resource].image;
+        imageBarrier.oldLayout = transition.oldLayout;
+        imageBarrier.newLayout = transition.newLayout;
+        imageBarrier.srcAccess = transition.srcAccess;
+        imageBarrier.dstAccess = transition.dstAccess;
+        barrier.imageBarriers.emplace_back(std::move(imageBarrier));
+    }
+    barrier.bufferBarriers.reserve(planned.buffers.size());
+    for (auto& dependency : planned.buffers){
+        BufferBarrier bufferBarrier;
+        bufferBarrier.buffer = m_resources[dependency.resource].buffer;
+        bufferBarrier.srcAccess = dependency.srcAccess;
+        bufferBarrier.dstAccess = dependency.dstAccess;
+        barrier.bufferBarriers.emplace_back(std::move(bufferBarrier));
+    }
+    return barrier;
+}
+
+void RenderGraph::execute(CommandBuffer &commandBuffer) const {
+    if (!m_compiled){
+        throw std::runtime_error("render graph executed without being compiled!");
+    }
+    auto& plannedPasses = m_planner.passes();
+    for (size_t i = 0; i < m_passes.size(); i++){
+        if (plannedPasses[i].culled){
+            continue;
+        }
+        record_barrier(commandBuffer, m_passes[i].barrier);
+        m_passes[i].execute(commandBuffer, *this);
+    }
+    record_barrier(commandBuffer, m_finalBarrier);
+}
+
+void RenderGraph::record_barrier(CommandBuffer &commandBuffer, const Barrier &barrier) const {
+    if (barrier.srcStages.empty() && barrier.dstStages.empty() &&
+        barrier.imageBarriers.empty() && barrier.bufferBarriers.empty()){
+        return;
+    }
+    commandBuffer.pipeline_barrier(barrier.srcStages, barrier.dstStages, barrier.imageBarriers, barrier.bufferBarriers);
+}
+
+void RenderGraph::clear() {
+    m_planner.clear();
+    m_passes.clear();
+    m_resources.clear();
+    m_finalBarrier = {};
+    m_compiled = false;
+}
+
+std::shared_ptr<Image> RenderGraph::image(RenderGraphResource resource) const {
+    return m_resources.at(resource.index).image;
+}
+
+std::shared_ptr<StorageBuffer> RenderGraph::buffer(RenderGraphResource resource) const {
+    return m_resources.at(resource.index).buffer;
+}
+
+}
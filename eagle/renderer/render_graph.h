@@ -0,0 +1,115 @@
+#ifndef EAGLE_RENDERGRAPH_H
+#define EAGLE_RENDERGRAPH_H
+
+#include "rendering_context.h"
+#include "render_graph_planner.h"
+
+#include <functional>
+#include <string>
+
+namespace eagle {
+
+struct RenderGraphResource {
+    uint32_t index = UINT32_MAX;
+    inline bool valid() const { return index != UINT32_MAX; }
+};
+
+class RenderGraph;
+
+class RenderGraphPassBuilder {
+public:
+    RenderGraphPassBuilder(RenderGraph& graph, uint32_t passIndex);
+
+    void read(RenderGraphResource resource, RenderGraphUsage usage);
+    void write(RenderGraphResource resource, RenderGraphUsage usage);
+
+    //keeps the pass even if nothing reads what it writes, e.g. it writes to host visible memory
+    void side_effect();
+
+private:
+    RenderGraph& m_graph;
+    uint32_t m_passIndex;
+};
+
+using RenderGraphSetup = std::function<void(RenderGraphPassBuilder&)>;
+using RenderGraphExecute = std::function<void(CommandBuffer&, const RenderGraph&)>;
+
+//Frame graph recorded into a single command buffer, so the whole frame goes out in one submission.
+//Passes declare what they read and write and run in declaration order. compile culls every pass whose writes never
+//reach an imported resource, an output or a side effect, computes the smallest set of barriers and layout transitions
+//between the remaining passes (merged into one vkCmdPipelineBarrier per pass) and reuses one physical image for
+//transient images of the same description whose lifetimes don't overlap. The physical images share one allocation
+//where images of different descriptions that are never alive at the same time alias each other (see RenderGraphPlanner).
+//Physical images are kept across clear() so rebuilding the same graph every frame creates no images.
+class RenderGraph {
+public:
+    explicit RenderGraph(RenderingContext* context);
+    ~RenderGraph();
+
+    //initialLayout is the layout the image is in when the graph starts, the graph leaves it in finalLayout
+    RenderGraphResource import_image(const std::string& name, const std::shared_ptr<Image>& image,
+                                     ImageLayout initialLayout, ImageLayout finalLayout);
+    RenderGraphResource import_buffer(const std::string& name, const std::shared_ptr<StorageBuffer>& buffer);
+
+    //only lives inside the graph, its contents are undefined before its first write
+    RenderGraphResource create_image(const std::string& name, const RenderGraphImageDescription& description);
+
+    void add_pass(const std::string& name, const RenderGraphSetup& setup, const RenderGraphExecute& execute);
+
+    //keeps the passes producing the resource alive, imported resources are always outputs
+    void set_output(RenderGraphResource resource);
+
+    void compile();
+    void execute(CommandBuffer& commandBuffer) const;
+
+    //drops passes and resources, physical images are kept for the next compile
+    void clear();
+
+    std::shared_ptr<Image> image(RenderGraphResource resource) const;
+    std::shared_ptr<StorageBuffer> buffer(RenderGraphResource resource) const;
+
+    inline const RenderGraphStats& stats() const { return m_planner.stats(); }
+
+private:
+    friend class RenderGraphPassBuilder;
+
+    struct Barrier {
+        std::vector<PipelineStage> srcStages;
+        std::vector<PipelineStage> dstStages;
+        std::vector<ImageBarrier> imageBarriers;
+        std::vector<BufferBarrier> bufferBarriers;
+    };
+
+    struct Pass {
+        std::string name;
+        RenderGraphExecute execute;
+        Barrier barrier;
+    };
+
+    struct Resource {
+        std::string name;
+        std::shared_ptr<Image> image;
+        std::shared_ptr<StorageBuffer> buffer;
+    };
+
+private:
+    void create_physical_images();
+    void rebuild_physical_images();
+    Barrier resolve_barrier(const RenderGraphPlanner::Barrier& planned) const;
+    void record_barrier(CommandBuffer& commandBuffer, const Barrier& barrier) const;
+
+private:
+    RenderingContext* m_context;
+    RenderGraphPlanner m_planner;
+    std::vector<Pass> m_passes;
+    std::vector<Resource> m_resources;
+    std::vector<std::shared_ptr<Image>> m_physicalImages;   //image of each of the planner's physical images
+    std::vector<ImageMemoryRequirements> m_memoryRequirements;
+    std::vector<uint64_t> m_memoryOffsets;                  //offset of each physical image in the shared allocation
+    Barrier m_finalBarrier;
+    bool m_compiled = false;
+};
+
+}
+
+#endif //EAGLE_RENDERGRAPH_H
@@ -0,0 +1,518 @@
+#include <eagle/renderer/render_graph_planner.h>
+
+#include <algorithm>
+
+namespace eagle {
+
+namespace {
+
+struct UsageInfo {
+    uint32_t stages;
+    uint32_t readAccess;
+    uint32_t writeAccess;
+    ImageLayout layout;
+    std::vector<ImageUsage> imageUsages;
+};
+
+constexpr uint32_t bit(PipelineStage stage) { return static_cast<uint32_t>(stage); }
+constexpr uint32_t bit(Access access) { return static_cast<uint32_t>(access); }
+
+const UsageInfo& usage_info(RenderGraphUsage usage) {
+    static const UsageInfo colorAttachment = {
+            bit(PipelineStage::COLOR_ATTACHMENT_OUTPUT_BIT),
+            bit(Access::COLOR_ATTACHMENT_READ_BIT),
+            bit(Access::COLOR_ATTACHMENT_READ_BIT) | bit(Access::COLOR_ATTACHMENT_WRITE_BIT),
+            ImageLayout::COLOR_ATTACHMENT_OPTIMAL, {ImageUsage::COLOR_ATTACHMENT}};
+    static const UsageInfo depthStencilAttachment = {
+            bit(PipelineStage::EARLY_FRAGMENT_TESTS_BIT) | bit(PipelineStage::LATE_FRAGMENT_TESTS_BIT),
+            bit(Access::DEPTH_STENCIL_ATTACHMENT_READ_BIT),
+            bit(Access::DEPTH_STENCIL_ATTACHMENT_READ_BIT) | bit(Access::DEPTH_STENCIL_ATTACHMENT_WRITE_BIT),
+            ImageLayout::DEPTH_STENCIL_ATTACHMENT_OPTIMAL, {ImageUsage::DEPTH_STENCIL_ATTACHMENT}};
+    static const UsageInfo sampledFragment = {
+            bit(PipelineStage::FRAGMENT_SHADER_BIT), bit(Access::SHADER_READ_BIT), 0,
+            ImageLayout::SHADER_READ_ONLY_OPTIMAL, {ImageUsage::SAMPLED}};
+    static const UsageInfo sampledCompute = {
+            bit(PipelineStage::COMPUTE_SHADER_BIT), bit(Access::SHADER_READ_BIT), 0,
+            ImageLayout::SHADER_READ_ONLY_OPTIMAL, {ImageUsage::SAMPLED}};
+    static const UsageInfo storageVertex = {
+            bit(PipelineStage::VERTEX_SHADER_BIT), bit(Access::SHADER_READ_BIT), bit(Access::SHADER_WRITE_BIT),
+            ImageLayout::GENERAL, {ImageUsage::STORAGE}};
+    static const UsageInfo storageFragment = {
+            bit(PipelineStage::FRAGMENT_SHADER_BIT), bit(Access::SHADER_READ_BIT), bit(Access::SHADER_WRITE_BIT),
+            ImageLayout::GENERAL, {ImageUsage::STORAGE}};
+    static const UsageInfo storageCompute = {
+            bit(PipelineStage::COMPUTE_SHADER_BIT), bit(Access::SHADER_READ_BIT), bit(Access::SHADER_WRITE_BIT),
+            ImageLayout::GENERAL, {ImageUsage::STORAGE}};
+    static const UsageInfo indirectArgument = {
+            bit(PipelineStage::DRAW_INDIRECT_BIT), bit(Access::INDIRECT_COMMAND_READ_BIT), 0,
+            ImageLayout::UNDEFINED, {}};
+    static const UsageInfo transferSrc = {
+            bit(PipelineStage::TRANSFER_BIT), bit(Access::TRANSFER_READ_BIT), 0,
+            ImageLayout::TRANSFER_SRC_OPTIMAL, {ImageUsage::TRANSFER_SRC}};
+    static const UsageInfo transferDst = {
+            bit(PipelineStage::TRANSFER_BIT), 0, bit(Access::TRANSFER_WRITE_BIT),
+            ImageLayout::TRANSFER_DST_OPTIMAL, {ImageUsage::TRANSFER_DST}};
+    static const UsageInfo present = {
+            bit(PipelineStage::BOTTOM_OF_PIPE_BIT), 0, 0,
+            ImageLayout::PRESENT_SRC_KHR, {}};
+
+    switch(usage){
+        case RenderGraphUsage::COLOR_ATTACHMENT: return colorAttachment;
+        case RenderGraphUsage::DEPTH_STENCIL_ATTACHMENT: return depthStencilAttachment;
+        case RenderGraphUsage::SAMPLED_FRAGMENT: return sampledFragment;
+        case RenderGraphUsage::SAMPLED_COMPUTE: return sampledCompute;
+        case RenderGraphUsage::STORAGE_VERTEX: return storageVertex;
+        case RenderGraphUsage::STORAGE_FRAGMENT: return storageFragment;
+        case RenderGraphUsage::STORAGE_COMPUTE: return storageCompute;
+        case RenderGraphUsage::INDIRECT_ARGUMENT: return indirectArgument;
+        case RenderGraphUsage::TRANSFER_SRC: return transferSrc;
+        case RenderGraphUsage::TRANSFER_DST: return transferDst;
+        case RenderGraphUsage::PRESENT: return present;
+    }
+    throw std::runtime_error("invalid render graph usage!");
+}
+
+template<typename T>
+std::vector<T> flags_to_vector(uint32_t flags) {
+    std::vector<T> result;
+    for (uint32_t i = 0; i < 32; i++){
+        if (flags & (1u << i)){
+            result.emplace_back(static_cast<T>(1u << i));
+        }
+    }
+    return result;
+}
+
+bool same_description(const RenderGraphImageDescription& a, const RenderGraphImageDescription& b) {
+    return a.width == b.width && a.height == b.height &&
+           a.mipLevels == b.mipLevels && a.arrayLayers == b.arrayLayers &&
+           a.format == b.format && a.aspects == b.aspects;
+}
+
+void add_usages(std::vector<ImageUsage>& usages, const std::vector<ImageUsage>& added) {
+    for (auto usage : added){
+        if (std::find(usages.begin(), usages.end(), usage) == usages.end()){
+            usages.emplace_back(usage);
+        }
+    }
+}
+
+bool contains_usages(const std::vector<ImageUsage>& usages, const std::vector<ImageUsage>& required) {
+    return std::all_of(required.begin(), required.end(), [&usages](ImageUsage usage){
+        return std::find(usages.begin(), usages.end(), usage) != usages.end();
+    });
+}
+
+}
+
+uint32_t RenderGraphPlanner::import_image(ImageLayout initialLayout, ImageLayout finalLayout) {
+    Resource resource;
+    resource.imported = true;
+    resource.initialLayout = initialLayout;
+    resource.finalLayout = finalLayout;
+    m_resources.emplace_back(std::move(resource));
+    return static_cast<uint32_t>(m_resources.size() - 1);
+}
+
+uint32_t RenderGraphPlanner::import_buffer() {
+    Resource resource;
+    resource.isImage = false;
+    resource.imported = true;
+    m_resources.emplace_back(std::move(resource));
+    return static_cast<uint32_t>(m_resources.size() - 1);
+}
+
+uint32_t RenderGraphPlanner::create_image(const RenderGraphImageDescription &description) {
+    Resource resource;
+    resource.description = description;
+    m_resources.emplace_back(std::move(resource));
+    return static_cast<uint32_t>(m_resources.size() - 1);
+}
+
+uint32_t RenderGraphPlanner::add_pass() {
+    m_passes.emplace_back();
+    return static_cast<uint32_t>(m_passes.size() - 1);
+}
+
+void RenderGraphPlanner::add_access(uint32_t passIndex, uint32_t resourceIndex, RenderGraphUsage usage, bool write) {
+    if (resourceIndex >= m_resources.size()){
+        throw std::runtime_error("invalid render graph resource!");
+    }
+    const UsageInfo& info = usage_info(usage);
+    if (write && info.writeAccess == 0){
+        throw std::runtime_error("render graph usage can't be written!");
+    }
+    Resource& target = m_resources[resourceIndex];
+    if (!target.imported){
+        add_usages(target.usages, info.imageUsages);
+    }
+    m_passes.at(passIndex).accesses.emplace_back(ResourceAccess{resourceIndex, usage, write});
+}
+
+void RenderGraphPlanner::set_side_effect(uint32_t passIndex) {
+    m_passes.at(passIndex).sideEffect = true;
+}
+
+void RenderGraphPlanner::set_output(uint32_t resourceIndex) {
+    m_resources.at(resourceIndex).output = true;
+}
+
+void RenderGraphPlanner::plan() {
+    m_stats = {};
+    m_stats.passCount = m_passes.size();
+
+    cull_passes();
+    compute_lifetimes();
+    assign_physical_images();
+    compute_barriers();
+}
+
+void RenderGraphPlanner::cull_passes() {
+    //walks the passes backwards, a pass is needed if it writes something that is read later or leaves the graph
+    std::vector<bool> needed(m_resources.size());
+    for (size_t i = 0; i < m_resources.size(); i++){
+        needed[i] = m_resources[i].imported || m_resources[i].output;
+    }
+
+    for (size_t i = m_passes.size(); i-- > 0;){
+        Pass& pass = m_passes[i];
+        bool live = pass.sideEffect;
+        for (auto& access : pass.accesses){
+            if (access.write && needed[access.resource]){
+                live = true;
+                break;
+            }
+        }
+        pass.culled = !live;
+        if (!live){
+            m_stats.culledPassCount++;
+            continue;
+        }
+        for (auto& access : pass.accesses){
+            if (!access.write){
+                needed[access.resource] = true;
+            }
+        }
+    }
+}
+
+void RenderGraphPlanner::compute_lifetimes() {
+    for (auto& resource : m_resources){
+        resource.firstPass = UINT32_MAX;
+        resource.lastPass = 0;
+        resource.physical = UINT32_MAX;
+    }
+    for (uint32_t i = 0; i < m_passes.size(); i++){
+        if (m_passes[i].culled){
+            continue;
+        }
+        for (auto& access : m_passes[i].accesses){
+            Resource& resource = m_resources[access.resource];
+            resource.firstPass = std::min(resource.firstPass, i);
+            resource.lastPass = std::max(resource.lastPass, i);
+        }
+    }
+}
+
+void RenderGraphPlanner::assign_physical_images() {
+    std::vector<uint32_t> transients;
+    for (uint32_t i = 0; i < m_resources.size(); i++){
+        if (!m_resources[i].imported && m_resources[i].firstPass != UINT32_MAX){
+            transients.emplace_back(i);
+        }
+    }
+    std::sort(transients.begin(), transients.end(), [this](uint32_t a, uint32_t b){
+        return m_resources[a].firstPass < m_resources[b].firstPass;
+    });
+
+    for (auto& physical : m_physicalImages){
+        physical.assigned = false;
+        physical.busyUntil = 0;
+        physical.firstPass = UINT32_MAX;
+        physical.lastPass = 0;
+        physical.aliases.clear();
+    }
+
+    //greedy interval assignment, a physical image is reused once the previous image living on it is dead
+    for (auto index : transients){
+        Resource& resource = m_resources[index];
+        uint32_t chosen = UINT32_MAX;
+        for (uint32_t i = 0; i < m_physicalImages.size(); i++){
+            PhysicalImage& physical = m_physicalImages[i];
+            if (!same_description(physical.description, resource.description)){
+                continue;
+            }
+            if (physical.assigned && physical.busyUntil >= resource.firstPass){
+                continue;
+            }
+            //prefer physical images that already support every usage, so nothing has to be created again
+            if (chosen == UINT32_MAX || (!contains_usages(m_physicalImages[chosen].usages, resource.usages) &&
+                                         contains_usages(physical.usages, resource.usages))){
+                chosen = i;
+            }
+        }
+        if (chosen == UINT32_MAX){
+            PhysicalImage physical;
+            physical.description = resource.description;
+            m_physicalImages.emplace_back(std::move(physical));
+            chosen = static_cast<uint32_t>(m_physicalImages.size() - 1);
+        }
+        PhysicalImage& physical = m_physicalImages[chosen];
+        if (!contains_usages(physical.usages, resource.usages)){
+            add_usages(physical.usages, resource.usages);
+            physical.recreate = true;
+        }
+        physical.assigned = true;
+        physical.busyUntil = resource.lastPass;
+        physical.firstPass = std::min(physical.firstPass, resource.firstPass);
+        physical.lastPass = std::max(physical.lastPass, resource.lastPass);
+        resource.physical = chosen;
+        m_stats.transientImageCount++;
+    }
+
+    for (auto& physical : m_physicalImages){
+        if (physical.assigned){
+            m_stats.physicalImageCount++;
+        }
+    }
+}
+
+uint64_t RenderGraphPlanner::place_physical_images(const std::vector<ImageMemoryRequirements> &requirements) {
+    if (requirements.size() != m_physicalImages.size()){
+        throw std::runtime_error("render graph memory requirements don't match its physical images!");
+    }
+
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < m_physicalImages.size(); i++){
+        m_physicalImages[i].memory = requirements[i];
+        m_physicalImages[i].aliases.clear();
+        if (m_physicalImages[i].assigned){
+            order.emplace_back(i);
+        }
+    }
+    //largest first, smaller images then fill the gaps left between them
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b){
+        return m_physicalImages[a].memory.size > m_physicalImages[b].memory.size;
+    });
+
+    auto align = [](uint64_t offset, uint64_t alignment){
+        return alignment > 1 ? (offset + alignment - 1) / alignment * alignment : offset;
+    };
+
+    m_stats.physicalImageBytes = 0;
+    m_stats.aliasedMemoryBytes = 0;
+    std::vector<uint32_t> placed;
+    for (auto index : order){
+        PhysicalImage& physical = m_physicalImages[index];
+
+        //only images alive at the same time can't share memory, the lowest offset clear of all of them is taken
+        std::vector<const PhysicalImage*> live;
+        for (auto other : placed){
+            const PhysicalImage& placedImage = m_physicalImages[other];
+            if (placedImage.firstPass <= physical.lastPass && physical.firstPass <= placedImage.lastPass){
+                live.emplace_back(&placedImage);
+            }
+        }
+        std::sort(live.begin(), live.end(), [](const PhysicalImage* a, const PhysicalImage* b){
+            return a->memoryOffset < b->memoryOffset;
+        });
+        uint64_t offset = 0;
+        for (auto other : live){
+            if (align(offset, physical.memory.alignment) + physical.memory.size <= other->memoryOffset){
+                break;
+            }
+            offset = std::max(offset, other->memoryOffset + other->memory.size);
+        }
+        physical.memoryOffset = align(offset, physical.memory.alignment);
+        placed.emplace_back(index);
+
+        m_stats.physicalImageBytes += physical.memory.size;
+        m_stats.aliasedMemoryBytes = std::max(m_stats.aliasedMemoryBytes, physical.memoryOffset + physical.memory.size);
+    }
+
+    for (auto index : placed){
+        PhysicalImage& physical = m_physicalImages[index];
+        for (auto other : placed){
+            const PhysicalImage& previous = m_physicalImages[other];
+            bool overlaps = previous.memoryOffset < physical.memoryOffset + physical.memory.size &&
+                            physical.memoryOffset < previous.memoryOffset + previous.memory.size;
+            if (other != index && overlaps && previous.lastPass < physical.firstPass){
+                physical.aliases.emplace_back(other);
+            }
+        }
+    }
+
+    compute_barriers();
+    return m_stats.aliasedMemoryBytes;
+}
+
+void RenderGraphPlanner::physical_images_created() {
+    for (auto& physical : m_physicalImages){
+        if (physical.assigned){
+            physical.recreate = false;
+        }
+    }
+}
+
+void RenderGraphPlanner::compute_barriers() {
+    m_stats.barrierCount = 0;
+
+    //transient images share the state of their physical image, so a reuse waits for the previous image to be done
+    std::vector<SyncState> states(m_resources.size() + m_physicalImages.size());
+    auto state_index = [this](uint32_t resourceIndex){
+        const Resource& resource = m_resources[resourceIndex];
+        return resource.imported ? resourceIndex : static_cast<uint32_t>(m_resources.size()) + resource.physical;
+    };
+
+    //imported resources may have been written by anything submitted earlier to the queue
+    for (uint32_t i = 0; i < m_resources.size(); i++){
+        if (m_resources[i].imported){
+            SyncState& state = states[i];
+            state.layout = m_resources[i].initialLayout;
+            state.writeStages = bit(PipelineStage::ALL_COMMANDS_BIT);
+            state.writeAccess = bit(Access::MEMORY_WRITE_BIT);
+        }
+    }
+
+    for (uint32_t passIndex = 0; passIndex < m_passes.size(); passIndex++){
+        Pass& pass = m_passes[passIndex];
+        pass.barrier = {};
+        if (pass.culled){
+            continue;
+        }
+
+        uint32_t srcStages = 0, dstStages = 0;
+        for (auto& access : pass.accesses){
+            Resource& resource = m_resources[access.resource];
+            SyncState& state = states[state_index(access.resource)];
+            const UsageInfo& info = usage_info(access.usage);
+            uint32_t accessMask = access.write ? info.writeAccess : info.readAccess;
+
+            if (!resource.imported && resource.firstPass == passIndex){
+                //the previous contents of the physical image belong to another transient image
+                state.layout = ImageLayout::UNDEFINED;
+            }
+
+            bool layoutChange = resource.isImage && state.layout != info.layout;
+            bool writeHazard = false;
+            uint32_t src = 0, srcAccess = 0;
+
+            if (!resource.imported && m_physicalImages[resource.physical].firstPass == passIndex){
+                //the memory was last used by other physical images, whatever they did must be done first
+                for (auto alias : m_physicalImages[resource.physical].aliases){
+                    const SyncState& aliasState = states[m_resources.size() + alias];
+                    src |= aliasState.writeStages | aliasState.readStages;
+                    srcAccess |= aliasState.writeAccess;
+                    writeHazard = true;
+                }
+            }
+
+            if (access.write){
+                //write after write, write after read
+                if (state.writeStages){
+                    src |= state.writeStages;
+                    srcAccess |= state.writeAccess;
+                    writeHazard = true;
+                }
+                src |= state.readStages;
+            }
+            else if (state.writeStages && ((info.stages & ~state.visibleStages) || (accessMask & ~state.visibleAccess))){
+                //read after write not yet made visible to this stage
+                src |= state.writeStages;
+                srcAccess |= state.writeAccess;
+                writeHazard = true;
+            }
+            if (layoutChange){
+                //transitions write the image, so they wait for every access still in flight
+                src |= state.writeStages | state.readStages;
+                srcAccess |= state.writeAccess;
+            }
+
+            if (src != 0 || layoutChange){
+                srcStages |= src;
+                dstStages |= info.stages;
+
+                if (resource.isImage && (layoutChange || writeHazard)){
+                    ImageTransition barrier;
+                    barrier.resource = access.resource;
+                    barrier.oldLayout = state.layout;
+                    barrier.newLayout = info.layout;
+                    barrier.srcAccess = flags_to_vector<Access>(srcAccess);
+                    barrier.dstAccess = flags_to_vector<Access>(accessMask);
+                    pass.barrier.images.emplace_back(std::move(barrier));
+                }
+                else if (!resource.isImage && writeHazard){
+                    BufferDependency barrier;
+                    barrier.resource = access.resource;
+                    barrier.srcAccess = flags_to_vector<Access>(srcAccess);
+                    barrier.dstAccess = flags_to_vector<Access>(accessMask);
+                    pass.barrier.buffers.emplace_back(std::move(barrier));
+                }
+            }
+
+            if (access.write){
+                state.writeStages = info.stages;
+                state.writeAccess = accessMask;
+                state.readStages = 0;
+                state.visibleStages = 0;
+                state.visibleAccess = 0;
+            }
+            else if (layoutChange){
+                //later readers chain onto the transition instead of the original write
+                state.writeStages = info.stages;
+                state.writeAccess = 0;
+                state.readStages = info.stages;
+                state.visibleStages = info.stages;
+                state.visibleAccess = accessMask;
+            }
+            else {
+                state.readStages |= info.stages;
+                if (writeHazard){
+                    state.visibleStages |= info.stages;
+                    state.visibleAccess |= accessMask;
+                }
+            }
+            if (resource.isImage){
+                state.layout = info.layout;
+            }
+        }
+
+        if (srcStages != 0 || dstStages != 0){
+            pass.barrier.srcStages = flags_to_vector<PipelineStage>(srcStages);
+            pass.barrier.dstStages = flags_to_vector<PipelineStage>(dstStages);
+            m_stats.barrierCount++;
+        }
+    }
+
+    //imported images are handed back in the layout the caller expects
+    m_finalBarrier = {};
+    uint32_t finalSrcStages = 0;
+    for (uint32_t i = 0; i < m_resources.size(); i++){
+        Resource& resource = m_resources[i];
+        SyncState& state = states[i];
+        if (!resource.imported || !resource.isImage || state.layout == resource.finalLayout){
+            continue;
+        }
+        finalSrcStages |= state.writeStages | state.readStages;
+
+        ImageTransition barrier;
+        barrier.resource = i;
+        barrier.oldLayout = state.layout;
+        barrier.newLayout = resource.finalLayout;
+        barrier.srcAccess = flags_to_vector<Access>(state.writeAccess);
+        m_finalBarrier.images.emplace_back(std::move(barrier));
+    }
+    if (!m_finalBarrier.images.empty()){
+        m_finalBarrier.srcStages = flags_to_vector<PipelineStage>(finalSrcStages);
+        m_finalBarrier.dstStages = {PipelineStage::BOTTOM_OF_PIPE_BIT};
+        m_stats.barrierCount++;
+    }
+}
+
+void RenderGraphPlanner::clear() {
+    m_passes.clear();
+    m_resources.clear();
+    m_finalBarrier = {};
+}
+
+}
@@ -0,0 +1,168 @@
+#ifndef EAGLE_RENDERGRAPHPLANNER_H
+#define EAGLE_RENDERGRAPHPLANNER_H
+
+#include "renderer_global_definitions.h"
+#include "image.h"
+
+#include <string>
+
+namespace eagle {
+
+//How a pass touches a resource. Each usage maps to the pipeline stages, access and image layout used for its barriers.
+//Render passes drawing to graph attachments should keep the attachment's initial and final layout equal to the
+//attachment usage's layout, the graph does every other transition.
+enum class RenderGraphUsage {
+    COLOR_ATTACHMENT,
+    DEPTH_STENCIL_ATTACHMENT,
+    SAMPLED_FRAGMENT,
+    SAMPLED_COMPUTE,
+    STORAGE_VERTEX,
+    STORAGE_FRAGMENT,
+    STORAGE_COMPUTE,
+    INDIRECT_ARGUMENT,
+    TRANSFER_SRC,
+    TRANSFER_DST,
+    PRESENT
+};
+
+struct RenderGraphImageDescription {
+    uint32_t width = 0, height = 0;
+    uint32_t mipLevels = 1, arrayLayers = 1;
+    Format format = Format::UNDEFINED;
+    std::vector<ImageAspect> aspects = {ImageAspect::COLOR};
+};
+
+struct RenderGraphStats {
+    size_t passCount = 0;
+    size_t culledPassCount = 0;
+    size_t barrierCount = 0;
+    size_t transientImageCount = 0;
+    size_t physicalImageCount = 0;
+    uint64_t physicalImageBytes = 0;    //what the physical images would take in allocations of their own
+    uint64_t aliasedMemoryBytes = 0;    //what they take sharing one allocation
+};
+
+//CPU side of RenderGraph::compile. It culls passes, assigns transient images to physical images and computes the
+//barriers between passes, all on resource indices, so it runs without a rendering context.
+//Transient images with the same description whose lifetimes don't overlap are assigned the same physical image.
+//place_physical_images then lays the physical images out in one shared allocation: images whose lifetimes don't
+//overlap may take the same memory whatever their descriptions, and the first pass using an image waits for the last
+//accesses to the images whose memory it takes over.
+class RenderGraphPlanner {
+public:
+    struct ResourceAccess {
+        uint32_t resource;
+        RenderGraphUsage usage;
+        bool write;
+    };
+
+    struct ImageTransition {
+        uint32_t resource;
+        ImageLayout oldLayout = ImageLayout::UNDEFINED;
+        ImageLayout newLayout = ImageLayout::UNDEFINED;
+        std::vector<Access> srcAccess;
+        std::vector<Access> dstAccess;
+    };
+
+    struct BufferDependency {
+        uint32_t resource;
+        std::vector<Access> srcAccess;
+        std::vector<Access> dstAccess;
+    };
+
+    struct Barrier {
+        std::vector<PipelineStage> srcStages;
+        std::vector<PipelineStage> dstStages;
+        std::vector<ImageTransition> images;
+        std::vector<BufferDependency> buffers;
+
+        inline bool empty() const { return srcStages.empty() && dstStages.empty() && images.empty() && buffers.empty(); }
+    };
+
+    struct Pass {
+        std::vector<ResourceAccess> accesses;
+        bool sideEffect = false;
+        bool culled = false;
+        Barrier barrier;
+    };
+
+    struct Resource {
+        bool isImage = true;
+        bool imported = false;
+        bool output = false;
+        ImageLayout initialLayout = ImageLayout::UNDEFINED;
+        ImageLayout finalLayout = ImageLayout::UNDEFINED;
+        RenderGraphImageDescription description;
+        std::vector<ImageUsage> usages;
+        uint32_t firstPass = UINT32_MAX;
+        uint32_t lastPass = 0;
+        uint32_t physical = UINT32_MAX;
+    };
+
+    struct PhysicalImage {
+        RenderGraphImageDescription description;
+        std::vector<ImageUsage> usages;
+        uint32_t busyUntil = 0;
+        bool assigned = false;
+        bool recreate = true;   //new physical image or its usages grew, the owner has to create its image again
+        uint32_t firstPass = UINT32_MAX, lastPass = 0;      //lifetime of the transient images assigned to it
+        ImageMemoryRequirements memory;
+        uint64_t memoryOffset = 0;
+        std::vector<uint32_t> aliases;      //physical images that used its memory earlier in the graph
+    };
+
+public:
+    uint32_t import_image(ImageLayout initialLayout, ImageLayout finalLayout);
+    uint32_t import_buffer();
+    uint32_t create_image(const RenderGraphImageDescription& description);
+    uint32_t add_pass();
+
+    void add_access(uint32_t passIndex, uint32_t resourceIndex, RenderGraphUsage usage, bool write);
+    void set_side_effect(uint32_t passIndex);
+    void set_output(uint32_t resourceIndex);
+
+    void plan();
+
+    //places the assigned physical images in one allocation and returns its size, requirements are indexed like
+    //physical_images(). Barriers are computed again so they also order the images sharing memory
+    uint64_t place_physical_images(const std::vector<ImageMemoryRequirements>& requirements);
+
+    //called once the owner created the image of every physical image flagged for recreation
+    void physical_images_created();
+
+    //drops passes and resources, physical images are kept for the next plan
+    void clear();
+
+    inline const std::vector<Pass>& passes() const { return m_passes; }
+    inline const std::vector<Resource>& resources() const { return m_resources; }
+    inline const std::vector<PhysicalImage>& physical_images() const { return m_physicalImages; }
+    inline const Barrier& final_barrier() const { return m_finalBarrier; }
+    inline const RenderGraphStats& stats() const { return m_stats; }
+
+private:
+    //what the last accesses to a resource did, barriers are only emitted against these
+    struct SyncState {
+        ImageLayout layout = ImageLayout::UNDEFINED;
+        uint32_t writeStages = 0;
+        uint32_t writeAccess = 0;
+        uint32_t readStages = 0;
+        uint32_t visibleStages = 0;
+        uint32_t visibleAccess = 0;
+    };
+
+    void cull_passes();
+    void compute_lifetimes();
+    void assign_physical_images();
+    void compute_barriers();
+
+private:
+    std::vector<Pass> m_passes;
+    std::vector<Resource> m_resources;
+    std::vector<PhysicalImage> m_physicalImages;
+    Barrier m_finalBarrier;
+    RenderGraphStats m_stats;
+};
+
+}
+
+#endif //EAGLE_RENDERGRAPHPLANNER_H
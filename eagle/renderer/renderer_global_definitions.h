@@ -15,7 +15,8 @@ enum class DescriptorType {
     STORAGE_BUFFER = 1,
     SAMPLED_IMAGE = 2,
     COMBINED_IMAGE_SAMPLER = 3,
-    STORAGE_IMAGE = 4
+    STORAGE_IMAGE = 4,
+    UNIFORM_BUFFER_DYNAMIC = 5
 };
 
 enum class UpdateType {
@@ -23,6 +24,34 @@ enum class UpdateType {
     DYNAMIC = 1,
 };
 
+//memory in the context's per frame ring, valid until the end of the frame it was allocated in
+struct FrameAllocation {
+    void* data = nullptr;
+    uint32_t offset = 0;
+};
+
+//layouts read from indirect argument buffers, they match VkDrawIndirectCommand and friends
+struct DrawIndirectCommand {
+    uint32_t vertexCount;
+    uint32_t instanceCount;
+    uint32_t firstVertex;
+    uint32_t firstInstance;
+};
+
+struct DrawIndexedIndirectCommand {
+    uint32_t indexCount;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    uint32_t firstInstance;
+};
+
+struct DispatchIndirectCommand {
+    uint32_t groupCountX;
+    uint32_t groupCountY;
+    uint32_t groupCountZ;
+};
+
 enum TextureUsage {
     READ,
     STORAGE
@@ -70,6 +99,26 @@ enum class PipelineStage {
     ACCELERATION_STRUCTURE_BUILD_BIT_NV = ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
 };
 
+enum class Access {
+    INDIRECT_COMMAND_READ_BIT = 0x00000001,
+    INDEX_READ_BIT = 0x00000002,
+    VERTEX_ATTRIBUTE_READ_BIT = 0x00000004,
+    UNIFORM_READ_BIT = 0x00000008,
+    INPUT_ATTACHMENT_READ_BIT = 0x00000010,
+    SHADER_READ_BIT = 0x00000020,
+    SHADER_WRITE_BIT = 0x00000040,
+    COLOR_ATTACHMENT_READ_BIT = 0x00000080,
+    COLOR_ATTACHMENT_WRITE_BIT = 0x00000100,
+    DEPTH_STENCIL_ATTACHMENT_READ_BIT = 0x00000200,
+    DEPTH_STENCIL_ATTACHMENT_WRITE_BIT = 0x00000400,
+    TRANSFER_READ_BIT = 0x00000800,
+    TRANSFER_WRITE_BIT = 0x00001000,
+    HOST_READ_BIT = 0x00002000,
+    HOST_WRITE_BIT = 0x00004000,
+    MEMORY_READ_BIT = 0x00008000,
+    MEMORY_WRITE_BIT = 0x00010000
+};
+
 
 enum class Filter {
     LINEAR = 1,
@@ -494,6 +543,55 @@ static uint32_t format_size(Format format){
     return result;
 }
 
+//bytes per 4x4 block of block compressed formats, 0 for every other format
+static uint32_t format_block_size(Format format){
+    switch (format) {
+        case Format::BC1_RGB_UNORM_BLOCK:
+        case Format::BC1_RGB_SRGB_BLOCK:
+        case Format::BC1_RGBA_UNORM_BLOCK:
+        case Format::BC1_RGBA_SRGB_BLOCK:
+        case Format::BC4_UNORM_BLOCK:
+        case Format::BC4_SNORM_BLOCK:
+        case Format::ETC2_R8G8B8_UNORM_BLOCK:
+        case Format::ETC2_R8G8B8_SRGB_BLOCK:
+        case Format::ETC2_R8G8B8A1_UNORM_BLOCK:
+        case Format::ETC2_R8G8B8A1_SRGB_BLOCK:
+        case Format::EAC_R11_UNORM_BLOCK:
+        case Format::EAC_R11_SNORM_BLOCK:
+            return 8;
+        case Format::BC2_UNORM_BLOCK:
+        case Format::BC2_SRGB_BLOCK:
+        case Format::BC3_UNORM_BLOCK:
+        case Format::BC3_SRGB_BLOCK:
+        case Format::BC5_UNORM_BLOCK:
+        case Format::BC5_SNORM_BLOCK:
+        case Format::BC6H_UFLOAT_BLOCK:
+        case Format::BC6H_SFLOAT_BLOCK:
+        case Format::BC7_UNORM_BLOCK:
+        case Format::BC7_SRGB_BLOCK:
+        case Format::ETC2_R8G8B8A8_UNORM_BLOCK:
+        case Format::ETC2_R8G8B8A8_SRGB_BLOCK:
+        case Format::EAC_R11G11_UNORM_BLOCK:
+        case Format::EAC_R11G11_SNORM_BLOCK:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+static inline bool is_block_compressed(Format format){
+    return format_block_size(format) != 0;
+}
+
+//bytes of a tightly packed width x height level, partial blocks at the edges count as whole blocks
+static inline size_t image_level_size(Format format, uint32_t width, uint32_t height){
+    uint32_t blockSize = format_block_size(format);
+    if (blockSize != 0){
+        return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+    }
+    return static_cast<size_t>(width) * height * format_size(format);
+}
+
 enum class AttachmentLoadOperator {
     LOAD = 0,
     CLEAR = 1,
@@ -12,6 +12,7 @@
 #include "vertex_buffer.h"
 #include "index_buffer.h"
 #include "uniform_buffer.h"
+#include "dynamic_uniform_buffer.h"
 #include "descriptor_set.h"
 #include "descriptor_set_layout.h"
 #include "texture.h"
@@ -22,6 +23,8 @@
 #include "framebuffer.h"
 #include "render_pass.h"
 
+#include <functional>
+
 namespace eagle {
 
 class Window;
@@ -53,6 +56,14 @@ public:
     virtual std::weak_ptr<StorageBuffer>
     create_storage_buffer(size_t size, void *data, UpdateType usage) = 0;
 
+    //blocks live in a ring owned by the context, see DynamicUniformBuffer
+    virtual std::weak_ptr<DynamicUniformBuffer>
+    create_dynamic_uniform_buffer(size_t blockSize) = 0;
+
+    //vertex data written every frame, e.g. per instance attributes, see CommandBuffer::bind_vertex_buffer. Thread safe
+    virtual FrameAllocation
+    allocate_frame_vertices(size_t size) = 0;
+
     virtual std::weak_ptr<CommandBuffer> create_command_buffer(const CommandBufferCreateInfo& createInfo) = 0;
 
     virtual std::weak_ptr<DescriptorSetLayout>
@@ -65,6 +76,18 @@ public:
     virtual std::weak_ptr<Texture>
     create_texture(const TextureCreateInfo &createInfo) = 0;
 
+    //starts with the file's low levels, finer ones are streamed in from disk as requested (see Texture::request_screen_size)
+    virtual std::weak_ptr<Texture>
+    create_streaming_texture(const StreamingTextureCreateInfo &createInfo) = 0;
+
+    //residentBytes bounds the VRAM of every streamed texture, least recently requested levels are evicted first.
+    //uploadBytesPerFrame caps the levels streamed in each frame
+    virtual void
+    set_texture_streaming_budget(size_t residentBytes, size_t uploadBytesPerFrame) = 0;
+
+    virtual TextureStreamingStats
+    texture_streaming_stats() const = 0;
+
     virtual std::weak_ptr<RenderPass>
     create_render_pass(const std::vector<RenderAttachmentDescription>& colorAttachments, const RenderAttachmentDescription& depthAttachment) = 0;
 
@@ -74,12 +97,43 @@ public:
     virtual std::weak_ptr<Image>
     create_image(const ImageCreateInfo& createInfo) = 0;
 
+    //images sharing one allocation, e.g. transient render graph images. place receives the memory requirements of
+    //every image and returns the offset of each in the allocation, images used at the same time must not overlap
+    virtual std::vector<std::weak_ptr<Image>>
+    create_aliased_images(const std::vector<ImageCreateInfo>& createInfos,
+                          const std::function<std::vector<uint64_t>(const std::vector<ImageMemoryRequirements>&)>& place) = 0;
+
     virtual std::weak_ptr<ComputeShader>
     create_compute_shader(const std::string& path) = 0;
 
+    //returns immediately, reflection and pipeline creation run on worker threads (see Shader::is_ready)
+    virtual std::weak_ptr<Shader>
+    create_shader_async(const ShaderCreateInfo &createInfo) { return create_shader(createInfo); }
+
+    //records taskCount secondary command buffers for the render pass in parallel and returns them in task order,
+    //ready for CommandBuffer::execute_commands in the current frame.
+    //recordTask runs on worker threads and may only record into the command buffer it receives
+    virtual const std::vector<std::shared_ptr<CommandBuffer>>&
+    record_secondary_parallel(const std::shared_ptr<RenderPass>& renderPass, const std::shared_ptr<Framebuffer>& framebuffer,
+                              uint32_t taskCount, const std::function<void(CommandBuffer&, uint32_t)>& recordTask) = 0;
+
+    //GPU duration of every zone of the last frame whose results are available, usually MAX_FRAMES_IN_FLIGHT frames
+    //behind, followed by the last result of every compute dispatch
+    virtual const std::vector<GpuZoneTiming>&
+    gpu_zone_timings() const = 0;
+
+    //true when images of this format can be sampled with optimal tiling, e.g. to pick a compressed texture variant
+    virtual bool
+    supports_sampled_format(Format format) const = 0;
+
+    //the texture is released once the frames in flight that may sample it have finished
     virtual void
     destroy_texture_2d(const std::shared_ptr<Texture>& texture) = 0;
 
+    //the image is released once the frames in flight that may use it have finished
+    virtual void
+    destroy_image(const std::shared_ptr<Image>& image) = 0;
+
 public:
     ImmediateEvent<RenderingContext*> context_recreated;
 };
@@ -22,9 +22,12 @@ struct ShaderCreateInfo {
     std::unordered_map<ShaderStage, std::string> shaderStages;
     bool blendEnable = false;
     bool depthTesting = false;
-    bool dynamicStates = false;
+    //viewport and scissor are set when the shader is bound, so resizing never rebuilds the pipeline
+    bool dynamicStates = true;
     VertexLayout vertexLayout;
     PrimitiveTopology primitiveTopology = PrimitiveTopology::TRIANGLE_LIST;
+    //instance names of the uniform blocks bound as UNIFORM_BUFFER_DYNAMIC, SPIR-V can't tell them apart from plain uniform buffers
+    std::vector<std::string> dynamicUniformBuffers;
     struct{
         float x = 0, y = 0;
         float widthPercent = 1, heightPercent = 1;
@@ -39,6 +42,11 @@ public:
 
     virtual const std::vector<std::weak_ptr<DescriptorSetLayout>> get_descriptor_set_layouts() = 0;
     virtual const std::weak_ptr<DescriptorSetLayout> get_descriptor_set_layout(uint32_t index) = 0;
+
+    inline const ShaderCreateInfo& create_info() const { return m_createInfo; }
+
+    //false while an asynchronously created shader is still being built, draws using it are skipped
+    virtual bool is_ready() const { return true; }
 protected:
     ShaderCreateInfo m_createInfo;
 
@@ -18,6 +18,7 @@ public:
 
     virtual void copy_from(void *data, size_t size, size_t offset) = 0;
     virtual void upload() = 0;
+    virtual bool is_ready() const { return true; }
 
     inline size_t size() const {return m_bytes.size();}
     inline const std::vector<char>& data() const { return m_bytes; }
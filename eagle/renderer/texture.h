@@ -17,6 +17,22 @@ namespace eagle {
 struct TextureCreateInfo {
     ImageCreateInfo imageCreateInfo;
     Filter filter = Filter::LINEAR;
+    //builds the mip chain of the single level in imageCreateInfo.bufferData on the CPU (see MipChainBuilder)
+    bool generateMipmaps = false;
+};
+
+struct StreamingTextureCreateInfo {
+    std::string path;       //KTX2 or DDS file holding the full mip chain
+    Filter filter = Filter::LINEAR;
+};
+
+struct TextureStreamingStats {
+    size_t residentBytes = 0;
+    size_t budgetBytes = 0;
+    size_t uploadedBytes = 0;       //last frame
+    size_t evictedLevels = 0;       //since the start
+    uint32_t pendingReads = 0;
+    uint32_t streamedTextures = 0;
 };
 
 class Texture : public DescriptorItem {
@@ -27,6 +43,13 @@ public:
 
     virtual void resize(uint32_t width, uint32_t height) = 0;
     virtual std::shared_ptr<Image> image() const = 0;
+    virtual bool is_ready() const { return image()->is_ready(); }
+
+    //streamed textures only: the largest extent in pixels the texture covers on screen, called every frame it is
+    //visible. Picks the finest level worth keeping resident
+    virtual void request_screen_size(float pixels) {}
+    //finest level currently sampled, always 0 for regular textures
+    virtual uint32_t resident_level() const { return 0; }
 
 protected:
     TextureCreateInfo m_createInfo;
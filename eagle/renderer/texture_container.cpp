@@ -0,0 +1,242 @@
+#include <eagle/renderer/texture_container.h>
+#include <eagle/renderer/rendering_context.h>
+#include <eagle/file_system.h>
+#include <eagle/log.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace eagle {
+
+namespace {
+
+constexpr uint8_t KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+constexpr size_t KTX2_HEADER_SIZE = 80;
+constexpr size_t KTX2_LEVEL_ENTRY_SIZE = 24;
+
+//enough for the KTX2 level index of any 2D image
+constexpr size_t HEADER_READ_SIZE = 4096;
+
+constexpr size_t DDS_HEADER_SIZE = 128;     //magic included
+constexpr size_t DDS_DX10_HEADER_SIZE = 20;
+constexpr uint32_t DDPF_FOURCC = 0x4;
+constexpr uint32_t DDPF_RGB = 0x40;
+constexpr uint32_t DDSCAPS2_CUBEMAP = 0x200;
+constexpr uint32_t DDSCAPS2_VOLUME = 0x200000;
+
+constexpr uint32_t fourcc(char a, char b, char c, char d) {
+    return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+           (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+template<typename T>
+T read(const std::vector<uint8_t>& bytes, size_t offset) {
+    if (offset + sizeof(T) > bytes.size()){
+        throw std::runtime_error("texture container is truncated!");
+    }
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+Format from_dxgi(uint32_t dxgiFormat) {
+    switch (dxgiFormat){
+        case 28: return Format::R8G8B8A8_UNORM;
+        case 29: return Format::R8G8B8A8_SRGB;
+        case 71: return Format::BC1_RGBA_UNORM_BLOCK;
+        case 72: return Format::BC1_RGBA_SRGB_BLOCK;
+        case 74: return Format::BC2_UNORM_BLOCK;
+        case 75: return Format::BC2_SRGB_BLOCK;
+        case 77: return Format::BC3_UNORM_BLOCK;
+        case 78: return Format::BC3_SRGB_BLOCK;
+        case 80: return Format::BC4_UNORM_BLOCK;
+        case 81: return Format::BC4_SNORM_BLOCK;
+        case 83: return Format::BC5_UNORM_BLOCK;
+        case 84: return Format::BC5_SNORM_BLOCK;
+        case 87: return Format::B8G8R8A8_UNORM;
+        case 91: return Format::B8G8R8A8_SRGB;
+        case 95: return Format::BC6H_UFLOAT_BLOCK;
+        case 96: return Format::BC6H_SFLOAT_BLOCK;
+        case 98: return Format::BC7_UNORM_BLOCK;
+        case 99: return Format::BC7_SRGB_BLOCK;
+        default: return Format::UNDEFINED;
+    }
+}
+
+//format of a DDS without the DX10 extension header
+Format from_dds_pixel_format(uint32_t flags, uint32_t fourCC, uint32_t bitCount, uint32_t redMask) {
+    if (flags & DDPF_FOURCC){
+        switch (fourCC){
+            case fourcc('D', 'X', 'T', '1'): return Format::BC1_RGBA_UNORM_BLOCK;
+            case fourcc('D', 'X', 'T', '3'): return Format::BC2_UNORM_BLOCK;
+            case fourcc('D', 'X', 'T', '5'): return Format::BC3_UNORM_BLOCK;
+            case fourcc('A', 'T', 'I', '1'):
+            case fourcc('B', 'C', '4', 'U'): return Format::BC4_UNORM_BLOCK;
+            case fourcc('A', 'T', 'I', '2'):
+            case fourcc('B', 'C', '5', 'U'): return Format::BC5_UNORM_BLOCK;
+            default: return Format::UNDEFINED;
+        }
+    }
+    if ((flags & DDPF_RGB) && bitCount == 32){
+        return redMask == 0x000000ff ? Format::R8G8B8A8_UNORM : Format::B8G8R8A8_UNORM;
+    }
+    return Format::UNDEFINED;
+}
+
+}
+
+ImageCreateInfo TextureContainer::load(const std::vector<uint8_t> &bytes) {
+    return make_create_info(bytes, parse(bytes));
+}
+
+ImageCreateInfo TextureContainer::load(const std::string &path) {
+    return load(FileSystem::instance()->read_bytes(path));
+}
+
+ImageCreateInfo TextureContainer::load_supported(const RenderingContext &context, const std::vector<std::string> &paths) {
+    for (auto& path : paths){
+        std::vector<uint8_t> bytes = FileSystem::instance()->read_bytes(path);
+        TextureContainerLayout layout = parse(bytes);
+        if (context.supports_sampled_format(layout.format)){
+            return make_create_info(bytes, layout);
+        }
+        EG_TRACE("eagle", "Skipping texture {0}, its format {1} is not supported", path, static_cast<uint32_t>(layout.format));
+    }
+    throw std::runtime_error("no texture variant has a format supported by the device!");
+}
+
+TextureContainerLayout TextureContainer::read_layout(const std::string &path) {
+    return parse_header(FileSystem::instance()->read_bytes(path, 0, HEADER_READ_SIZE));
+}
+
+TextureContainerLayout TextureContainer::parse(const std::vector<uint8_t> &bytes) {
+    TextureContainerLayout layout = parse_header(bytes);
+    for (auto& level : layout.levels){
+        if (level.offset + level.size > bytes.size()){
+            throw std::runtime_error("texture container is truncated!");
+        }
+    }
+    return layout;
+}
+
+TextureContainerLayout TextureContainer::parse_header(const std::vector<uint8_t> &bytes) {
+    TextureContainerLayout layout;
+    if (bytes.size() >= sizeof(KTX2_IDENTIFIER) && std::memcmp(bytes.data(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0){
+        layout = parse_ktx2(bytes);
+    }
+    else if (bytes.size() >= 4 && read<uint32_t>(bytes, 0) == fourcc('D', 'D', 'S', ' ')){
+        layout = parse_dds(bytes);
+    }
+    else {
+        throw std::runtime_error("texture is neither a KTX2 nor a DDS file!");
+    }
+
+    if (layout.width == 0 || layout.height == 0){
+        throw std::runtime_error("texture container has an empty image!");
+    }
+    return layout;
+}
+
+TextureContainerLayout TextureContainer::parse_ktx2(const std::vector<uint8_t> &bytes) {
+    TextureContainerLayout layout;
+    layout.format = static_cast<Format>(read<uint32_t>(bytes, 12));     //KTX2 stores VkFormat values, same as Format
+    layout.width = read<uint32_t>(bytes, 20);
+    layout.height = read<uint32_t>(bytes, 24);
+    uint32_t depth = read<uint32_t>(bytes, 28);
+    uint32_t layerCount = read<uint32_t>(bytes, 32);
+    uint32_t faceCount = read<uint32_t>(bytes, 36);
+    uint32_t levelCount = std::max(read<uint32_t>(bytes, 40), 1u);
+    uint32_t supercompression = read<uint32_t>(bytes, 44);
+
+    if (supercompression != 0 || layout.format == Format::UNDEFINED){
+        throw std::runtime_error("supercompressed KTX2 textures need transcoding, which is not supported!");
+    }
+    if (depth > 1 || layerCount > 1 || faceCount != 1){
+        throw std::runtime_error("only single 2D KTX2 images are supported!");
+    }
+    if (image_level_size(layout.format, 1, 1) == 0){
+        throw std::runtime_error("KTX2 texture format is not supported!");
+    }
+
+    //the level index is ordered from the base level, even though the data is stored smallest level first
+    layout.levels.resize(levelCount);
+    for (uint32_t level = 0; level < levelCount; level++){
+        size_t entry = KTX2_HEADER_SIZE + level * KTX2_LEVEL_ENTRY_SIZE;
+        uint64_t byteOffset = read<uint64_t>(bytes, entry);
+        uint64_t byteLength = read<uint64_t>(bytes, entry + 8);
+        size_t size = image_level_size(layout.format, std::max(layout.width >> level, 1u), std::max(layout.height >> level, 1u));
+        if (byteLength < size){
+            throw std::runtime_error("KTX2 level is smaller than its image!");
+        }
+        layout.levels[level] = {static_cast<size_t>(byteOffset), size};
+    }
+    return layout;
+}
+
+TextureContainerLayout TextureContainer::parse_dds(const std::vector<uint8_t> &bytes) {
+    TextureContainerLayout layout;
+    layout.height = read<uint32_t>(bytes, 12);
+    layout.width = read<uint32_t>(bytes, 16);
+    uint32_t levelCount = std::max(read<uint32_t>(bytes, 28), 1u);
+    uint32_t pixelFormatFlags = read<uint32_t>(bytes, 80);
+    uint32_t fourCC = read<uint32_t>(bytes, 84);
+    uint32_t caps2 = read<uint32_t>(bytes, 112);
+
+    if (caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)){
+        throw std::runtime_error("only single 2D DDS images are supported!");
+    }
+
+    size_t offset = DDS_HEADER_SIZE;
+    if ((pixelFormatFlags & DDPF_FOURCC) && fourCC == fourcc('D', 'X', '1', '0')){
+        layout.format = from_dxgi(read<uint32_t>(bytes, DDS_HEADER_SIZE));
+        if (read<uint32_t>(bytes, DDS_HEADER_SIZE + 12) > 1){
+            throw std::runtime_error("only single 2D DDS images are supported!");
+        }
+        offset += DDS_DX10_HEADER_SIZE;
+    }
+    else {
+        layout.format = from_dds_pixel_format(pixelFormatFlags, fourCC, read<uint32_t>(bytes, 88), read<uint32_t>(bytes, 92));
+    }
+
+    if (layout.format == Format::UNDEFINED){
+        throw std::runtime_error("DDS texture format is not supported!");
+    }
+
+    //levels are stored base level first, tightly packed
+    layout.levels.resize(levelCount);
+    for (uint32_t level = 0; level < levelCount; level++){
+        size_t size = image_level_size(layout.format, std::max(layout.width >> level, 1u), std::max(layout.height >> level, 1u));
+        layout.levels[level] = {offset, size};
+        offset += size;
+    }
+    return layout;
+}
+
+ImageCreateInfo TextureContainer::image_create_info(const TextureContainerLayout &layout, uint32_t firstLevel) {
+    ImageCreateInfo createInfo = {};
+    createInfo.width = std::max(layout.width >> firstLevel, 1u);
+    createInfo.height = std::max(layout.height >> firstLevel, 1u);
+    createInfo.mipLevels = static_cast<uint32_t>(layout.levels.size()) - firstLevel;
+    createInfo.format = layout.format;
+    createInfo.tiling = ImageTiling::OPTIMAL;
+    createInfo.layout = ImageLayout::SHADER_READ_ONLY_OPTIMAL;
+    createInfo.usages = {ImageUsage::SAMPLED, ImageUsage::TRANSFER_DST};
+    createInfo.aspects = {ImageAspect::COLOR};
+    return createInfo;
+}
+
+ImageCreateInfo TextureContainer::make_create_info(const std::vector<uint8_t> &bytes, const TextureContainerLayout &layout) {
+    ImageCreateInfo createInfo = image_create_info(layout);
+
+    size_t totalSize = 0;
+    for (auto& level : layout.levels){
+        totalSize += level.size;
+    }
+    createInfo.bufferData.reserve(totalSize);
+    for (auto& level : layout.levels){
+        createInfo.bufferData.insert(createInfo.bufferData.end(), bytes.begin() + level.offset, bytes.begin() + level.offset + level.size);
+    }
+    return createInfo;
+}
+
+}
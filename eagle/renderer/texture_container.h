@@ -0,0 +1,51 @@
+#ifndef EAGLE_TEXTURECONTAINER_H
+#define EAGLE_TEXTURECONTAINER_H
+
+#include "image.h"
+
+namespace eagle {
+
+class RenderingContext;
+
+struct TextureContainerLevel {
+    size_t offset;      //in the file
+    size_t size;
+};
+
+struct TextureContainerLayout {
+    Format format = Format::UNDEFINED;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<TextureContainerLevel> levels;     //level 0 first
+};
+
+//Reads KTX2 and DDS files into an ImageCreateInfo ready for RenderingContext::create_texture.
+//Every level stored in the file is kept as is, level 0 first, so pre-compressed mips (BC, ETC2) are uploaded
+//without transcoding. Only single 2D images are supported, no arrays, cubemaps or supercompressed KTX2.
+class TextureContainer {
+public:
+    //the container type is detected from the file's magic
+    static ImageCreateInfo load(const std::vector<uint8_t>& bytes);
+    static ImageCreateInfo load(const std::string& path);
+
+    //loads the first file whose format the context can sample. Meant for the same texture encoded for
+    //several platforms, e.g. BC7 for desktop, then ETC2 for mobile and an RGBA8 copy as last resort
+    static ImageCreateInfo load_supported(const RenderingContext& context, const std::vector<std::string>& paths);
+
+    //reads only the header, used to stream levels in individually
+    static TextureContainerLayout read_layout(const std::string& path);
+
+    //every field but bufferData, for an image holding levels [firstLevel, levelCount)
+    static ImageCreateInfo image_create_info(const TextureContainerLayout& layout, uint32_t firstLevel = 0);
+
+private:
+    static TextureContainerLayout parse(const std::vector<uint8_t>& bytes);
+    static TextureContainerLayout parse_header(const std::vector<uint8_t>& bytes);
+    static TextureContainerLayout parse_ktx2(const std::vector<uint8_t>& bytes);
+    static TextureContainerLayout parse_dds(const std::vector<uint8_t>& bytes);
+    static ImageCreateInfo make_create_info(const std::vector<uint8_t>& bytes, const TextureContainerLayout& layout);
+};
+
+}
+
+#endif //EAGLE_TEXTURECONTAINER_H
@@ -14,7 +14,7 @@ namespace eagle {
 
 struct VertexInputBindingDescription {
     std::vector<Format> attributes;
-    VertexInputRate inputRate;
+    VertexInputRate inputRate = VertexInputRate::VERTEX;
     size_t stride() const;
 };
 
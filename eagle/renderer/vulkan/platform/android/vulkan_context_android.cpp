@@ -6,6 +6,7 @@
 #include <eagle/platform/android/android_window.h>
 #include <vulkan/vulkan_android.h>
 #include <eagle/renderer/vulkan/vulkan_context.h>
+#include <eagle/renderer/vulkan/vulkan_deletion_queue.h>
 
 eagle::VulkanContextAndroid::VulkanContextAndroid(eagle::AndroidWindow *window) {
     m_window = window;
@@ -45,6 +46,9 @@ void eagle::VulkanContextAndroid::destroy_surface() {
 
     m_present.framebuffer.reset();
 
+    //the device is idle, the image views are destroyed before the swapchain owning their images
+    VulkanDeletionQueue::flush();
+
     VK_CALL vkDestroySwapchainKHR(m_device, m_present.swapchain, nullptr);
 
     VK_CALL vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
@@ -62,6 +66,7 @@ void eagle::VulkanContextAndroid::init() {
     bind_physical_device();
     create_logical_device();
     load_device_functions(m_device);
+    create_pipeline_cache();
     create_sync_objects();
 
     create_surface();
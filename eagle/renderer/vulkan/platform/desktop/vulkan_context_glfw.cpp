@@ -35,6 +35,7 @@ void eagle::VulkanContextGLFW::init() {
     create_surface();
     bind_physical_device();
     create_logical_device();
+    create_pipeline_cache();
     create_sync_objects();
     create_command_pool();
 
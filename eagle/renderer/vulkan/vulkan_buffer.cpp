@@ -4,6 +4,8 @@
 #include <assert.h>
 #include "vulkan_buffer.h"
 #include "vulkan_helper.h"
+#include "vulkan_uploader.h"
+#include "vulkan_deletion_queue.h"
 
 #include "eagle/log.h"
 
@@ -18,39 +20,44 @@ VulkanBuffer::VulkanBuffer(VkDevice device, const VulkanBufferCreateInfo& create
 
 }
 
+//memory blocks are persistently mapped by the allocator, mapping only hands out the pointer to this buffer's range
 VkResult
 VulkanBuffer::map(VkDeviceSize size, VkDeviceSize offset) {
-    return vkMapMemory(m_device, m_memory, offset, size, 0, &m_mapped);
+    if (!m_allocation.mapped) {
+        return VK_ERROR_MEMORY_MAP_FAILED;
+    }
+    m_mapped = static_cast<uint8_t*>(m_allocation.mapped) + offset;
+    return VK_SUCCESS;
 }
 
 void
 VulkanBuffer::unmap() {
-    if (m_mapped) {
-        vkUnmapMemory(m_device, m_memory);
-        m_mapped = nullptr;
-    }
+    m_mapped = nullptr;
 }
 
 VkResult
 VulkanBuffer::bind(VkDeviceSize offset) {
-    return vkBindBufferMemory(m_device, m_buffer, m_memory, offset);
+    return vkBindBufferMemory(m_device, m_buffer, m_allocation.memory, m_allocation.offset + offset);
 }
 
 void
 VulkanBuffer::destroy() {
-    if (m_buffer) {
-        vkDestroyBuffer(m_device, m_buffer, nullptr);
-    }
-
-    if (m_memory) {
-        vkFreeMemory(m_device, m_memory, nullptr);
-    }
+    m_mapped = nullptr;
+    //frames still in flight may read the buffer, e.g. when it is destroyed to be recreated bigger
+    VulkanDeletionQueue::push([device = m_device, buffer = m_buffer, allocation = m_allocation]() mutable {
+        if (buffer) {
+            vkDestroyBuffer(device, buffer, nullptr);
+        }
+        VulkanMemoryAllocator::free(allocation);
+    });
+    m_buffer = VK_NULL_HANDLE;
+    m_allocation = {};
 }
 
 void
-VulkanBuffer::copy_to(void *data, VkDeviceSize size) {
+VulkanBuffer::copy_to(void *data, VkDeviceSize size, VkDeviceSize offset) {
     assert(m_mapped);
-    memcpy(m_mapped, data, size);
+    memcpy(static_cast<uint8_t*>(m_mapped) + offset, data, size);
 }
 
 VkResult
@@ -75,18 +82,7 @@ VulkanBuffer::create_buffer(VkPhysicalDevice physicalDevice, VkDevice device, st
 
     buffer->m_alignment = memRequirements.alignment;
     buffer->m_size = memRequirements.size;
-    VkMemoryAllocateInfo allocInfo = {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = VulkanHelper::find_memory_type(
-            physicalDevice, memRequirements.memoryTypeBits, info.memoryFlags
-            );
-
-    //TODO --- implementar solução top de alocação de memória (ver vulkan tutorial)
-    if ((result = vkAllocateMemory(device, &allocInfo, nullptr, &buffer->get_memory())) != VK_SUCCESS) {
-        EG_ERROR("eagle", "Failed allocate memory for vulkan buffer");
-        return result;
-    }
+    buffer->m_allocation = VulkanMemoryAllocator::allocate(memRequirements, info.memoryFlags, VulkanResourceKind::LINEAR);
 
     if (data != nullptr) {
         if ((result = buffer->map()) != VK_SUCCESS) {
@@ -94,6 +90,7 @@ VulkanBuffer::create_buffer(VkPhysicalDevice physicalDevice, VkDevice device, st
             return result;
         }
         memcpy(buffer->get_data(), data, size);
+        buffer->flush();
         buffer->unmap();
     }
 
@@ -124,15 +121,29 @@ void VulkanBuffer::copy_buffer(
 }
 
 void VulkanBuffer::flush(VkDeviceSize size, VkDeviceSize offset) {
+    auto& memoryType = VulkanMemoryAllocator::memory_properties().memoryTypes[m_allocation.memoryTypeIndex];
+    if (memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) {
+        return;
+    }
+
+    //ranges must be aligned to nonCoherentAtomSize and stay inside the buffer's allocation
+    VkDeviceSize atom = VulkanMemoryAllocator::non_coherent_atom_size();
+    VkDeviceSize begin = m_allocation.offset + offset;
+    VkDeviceSize end = size == VK_WHOLE_SIZE ? m_allocation.offset + m_allocation.size : begin + size;
+    begin -= begin % atom;
+    end = ((end + atom - 1) / atom) * atom;
+
     VkMappedMemoryRange memoryRange = {};
     memoryRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-    memoryRange.size = size;
-    memoryRange.offset = offset;
-    memoryRange.memory = m_memory;
+    memoryRange.memory = m_allocation.memory;
+    memoryRange.offset = begin;
+    memoryRange.size = m_allocation.block ? end - begin : VK_WHOLE_SIZE;
     vkFlushMappedMemoryRanges(m_device, 1, &memoryRange);
 }
 
 
+bool VulkanBuffer::is_ready() const {
+    return VulkanUploader::is_ready(m_readyToken);
 }
 
-
+}
\ No newline at end of file
@@ -6,6 +6,7 @@
 #define EAGLE_VULKANBUFFER_H
 
 #include "vulkan_global_definitions.h"
+#include "vulkan_memory_allocator.h"
 
 namespace eagle {
 
@@ -26,13 +27,14 @@ public:
     VkResult map(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
     VkResult bind(VkDeviceSize offset = 0);
     void unmap();
-    void copy_to(void *data, VkDeviceSize size);
+    void copy_to(void *data, VkDeviceSize size, VkDeviceSize offset = 0);
     void flush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
     void destroy();
 
     inline VkBuffer&       native_buffer() { return m_buffer; }
-    inline VkDeviceMemory& get_memory()        { return m_memory; }
+    inline VkDeviceMemory& get_memory()        { return m_allocation.memory; }
     inline void*           get_data()          { return m_mapped; }
+    inline const VulkanMemoryAllocation& allocation() const { return m_allocation; }
 
 
     static VkResult
@@ -52,15 +54,21 @@ public:
 
     VkDeviceSize size() const { return m_size; }
 
+    //readiness token of the last async upload, see VulkanUploader
+    inline uint64_t ready_token() const { return m_readyToken; }
+    inline void set_ready_token(uint64_t token) { m_readyToken = token; }
+    bool is_ready() const;
+
 private:
 
     VkDevice m_device = VK_NULL_HANDLE;
 
     VkBuffer m_buffer = VK_NULL_HANDLE;
-    VkDeviceMemory m_memory = VK_NULL_HANDLE;
+    VulkanMemoryAllocation m_allocation;
     void* m_mapped = nullptr;
     VkDeviceSize m_alignment = 0;
     VkDeviceSize m_size = 0;
+    uint64_t m_readyToken = 0;
 
     VkBufferUsageFlags m_usageFlags = VK_BUFFER_USAGE_FLAG_BITS_MAX_ENUM;
     VkMemoryPropertyFlags m_memoryFlags = VK_MEMORY_PROPERTY_FLAG_BITS_MAX_ENUM;
@@ -9,27 +9,81 @@ namespace eagle {
 
 std::vector<VulkanCleanable*> VulkanCleaner::m_dirtyObjects;
 
+VulkanCleanable::~VulkanCleanable() {
+    VulkanCleaner::remove(this);
+}
+
+void VulkanDirtyRanges::add(size_t begin, size_t end) {
+    if (begin >= end){
+        return;
+    }
+    auto it = std::lower_bound(m_ranges.begin(), m_ranges.end(), begin, [](const Range& range, size_t value){
+        return range.end < value;
+    });
+    //it is the first range that touches or follows the new one, everything it overlaps is folded into it
+    auto last = it;
+    while (last != m_ranges.end() && last->begin <= end){
+        begin = std::min(begin, last->begin);
+        end = std::max(end, last->end);
+        ++last;
+    }
+    it = m_ranges.erase(it, last);
+    m_ranges.insert(it, Range{begin, end});
+
+    if (m_ranges.size() > MAX_RANGES){
+        Range merged = {m_ranges.front().begin, m_ranges.back().end};
+        m_ranges.clear();
+        m_ranges.emplace_back(merged);
+    }
+}
+
+void VulkanDirtyRanges::add(const VulkanDirtyRanges &other) {
+    for (auto& range : other.m_ranges){
+        add(range.begin, range.end);
+    }
+}
+
 void VulkanCleaner::flush(uint32_t index){
 
-    std::vector<VulkanCleanable*> dirtyObjects;
-    for (auto cleanable : m_dirtyObjects){
+    size_t kept = 0;
+    for (size_t i = 0; i < m_dirtyObjects.size(); i++){
+        VulkanCleanable* cleanable = m_dirtyObjects[i];
         cleanable->flush(index);
         if (cleanable->is_dirty()){
-            dirtyObjects.emplace_back(cleanable);
+            cleanable->m_cleanerIndex = kept;
+            m_dirtyObjects[kept++] = cleanable;
+        }
+        else {
+            cleanable->m_cleanerIndex = VulkanCleanable::NOT_QUEUED;
         }
     }
-    std::swap(m_dirtyObjects, dirtyObjects);
+    m_dirtyObjects.resize(kept);
 
 }
 
 void VulkanCleaner::push(VulkanCleanable* object){
-    auto it = std::find(m_dirtyObjects.begin(), m_dirtyObjects.end(), object);
-    if (it == m_dirtyObjects.end()){
-        m_dirtyObjects.emplace_back(object);
+    if (object->m_cleanerIndex != VulkanCleanable::NOT_QUEUED){
+        return;
     }
+    object->m_cleanerIndex = m_dirtyObjects.size();
+    m_dirtyObjects.emplace_back(object);
+}
+
+void VulkanCleaner::remove(VulkanCleanable *object) {
+    if (object->m_cleanerIndex == VulkanCleanable::NOT_QUEUED){
+        return;
+    }
+    VulkanCleanable* last = m_dirtyObjects.back();
+    m_dirtyObjects[object->m_cleanerIndex] = last;
+    last->m_cleanerIndex = object->m_cleanerIndex;
+    m_dirtyObjects.pop_back();
+    object->m_cleanerIndex = VulkanCleanable::NOT_QUEUED;
 }
 
 void VulkanCleaner::clear() {
+    for (auto cleanable : m_dirtyObjects){
+        cleanable->m_cleanerIndex = VulkanCleanable::NOT_QUEUED;
+    }
     m_dirtyObjects.clear();
 }
 
@@ -13,8 +13,37 @@ class VulkanCleaner;
 
 class VulkanCleanable {
 public:
+    virtual ~VulkanCleanable();
     virtual bool is_dirty() const = 0;
     virtual void flush(uint32_t index) = 0;
+
+private:
+    friend class VulkanCleaner;
+    static constexpr size_t NOT_QUEUED = SIZE_MAX;
+    //position in the cleaner's dirty list, pushing and removing never search it
+    size_t m_cleanerIndex = NOT_QUEUED;
+};
+
+//Byte ranges written since the last flush, sorted and merged.
+//Past MAX_RANGES they collapse into a single range, one larger copy is cheaper than many small ones.
+class VulkanDirtyRanges {
+public:
+    struct Range {
+        size_t begin;
+        size_t end;
+    };
+
+    static constexpr size_t MAX_RANGES = 16;
+
+    void add(size_t begin, size_t end);
+    void add(const VulkanDirtyRanges& other);
+
+    inline void clear() { m_ranges.clear(); }
+    inline bool empty() const { return m_ranges.empty(); }
+    inline const std::vector<Range>& ranges() const { return m_ranges; }
+
+private:
+    std::vector<Range> m_ranges;
 };
 
 
@@ -24,6 +53,8 @@ public:
 
     static void push(VulkanCleanable* object);
 
+    static void remove(VulkanCleanable* object);
+
     static void clear();
 private:
     static std::vector<VulkanCleanable*> m_dirtyObjects;
@@ -11,9 +11,29 @@
 #include <eagle/renderer/vulkan/vulkan_compute_shader.h>
 #include <eagle/renderer/vulkan/vulkan_render_pass.h>
 #include <eagle/renderer/vulkan/vulkan_framebuffer.h>
+#include <eagle/renderer/vulkan/vulkan_frame_command_pool.h>
+#include <eagle/renderer/vulkan/vulkan_storage_buffer.h>
+#include <eagle/renderer/vulkan/vulkan_gpu_profiler.h>
+#include <eagle/renderer/vulkan/vulkan_frame_ring.h>
 
 namespace eagle {
 
+bool VulkanCommandBuffer::s_multiDrawIndirect = false;
+PFN_vkCmdDrawIndirectCountKHR VulkanCommandBuffer::s_drawIndirectCount = nullptr;
+PFN_vkCmdDrawIndexedIndirectCountKHR VulkanCommandBuffer::s_drawIndexedIndirectCount = nullptr;
+
+void VulkanCommandBuffer::init_indirect_draws(VkDevice device, bool multiDrawIndirect, bool drawIndirectCount) {
+    s_multiDrawIndirect = multiDrawIndirect;
+    s_drawIndirectCount = nullptr;
+    s_drawIndexedIndirectCount = nullptr;
+    if (drawIndirectCount){
+        s_drawIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndirectCountKHR>(
+                vkGetDeviceProcAddr(device, "vkCmdDrawIndirectCountKHR"));
+        s_drawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+                vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR"));
+    }
+}
+
 VulkanCommandBuffer::VulkanCommandBuffer(const CommandBufferCreateInfo &createInfo,
                                          const VulkanCommandBufferCreateInfo &vkCreateInfo) :
                                          CommandBuffer(createInfo),
@@ -29,11 +49,13 @@ void VulkanCommandBuffer::begin() {
     assert(m_createInfo.level == CommandBufferLevel::PRIMARY || m_createInfo.level == CommandBufferLevel::MASTER);
     VkCommandBufferBeginInfo beginInfo = {};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+    beginInfo.flags = usage_flags();
 
-    VK_CALL vkBeginCommandBuffer(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], &beginInfo);
+    VK_CALL vkBeginCommandBuffer(begin_native(), &beginInfo);
 
     m_finished = false;
+    m_skipDraws = false;
+    reset_pending_resources();
 }
 
 void VulkanCommandBuffer::begin(const std::shared_ptr<RenderPass> &renderPass,
@@ -51,20 +73,38 @@ void VulkanCommandBuffer::begin(const std::shared_ptr<RenderPass> &renderPass,
 
     VkCommandBufferBeginInfo beginInfo = {};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | usage_flags();
     beginInfo.pInheritanceInfo = &inheritanceInfo;
 
     inheritanceInfo.framebuffer = vfb->native_framebuffers()[*m_vkCreateInfo.currentImageIndex];
-    VK_CALL vkBeginCommandBuffer(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], &beginInfo);
+    m_renderArea = {vfb->width(), vfb->height()};
+    m_viewportSet = m_scissorSet = false;
+    VK_CALL vkBeginCommandBuffer(begin_native(), &beginInfo);
     m_finished = false;
+    m_skipDraws = false;
+    reset_pending_resources();
 }
 
 
 void VulkanCommandBuffer::end() {
+    if (!m_gpuZones.empty()){
+        EG_WARNING("eagle", "Command buffer ended with {0} open gpu zones, closing them", m_gpuZones.size());
+        while (!m_gpuZones.empty()){
+            end_gpu_zone();
+        }
+    }
     VK_CALL vkEndCommandBuffer(m_commandBuffers[*m_vkCreateInfo.currentImageIndex]);
 
     m_finished = true;
     m_boundShader.reset();
+    m_skipDraws = false;
+    reset_pending_resources();
+}
+
+void VulkanCommandBuffer::reset_pending_resources() {
+    m_pendingVertices = m_pendingIndices = false;
+    m_pendingSets = 0;
+    m_pendingComputeSets = 0;
 }
 
 void VulkanCommandBuffer::execute_commands(const std::vector<std::shared_ptr<CommandBuffer>> &commandBuffers) {
@@ -95,6 +135,8 @@ void VulkanCommandBuffer::begin_render_pass(const std::shared_ptr<RenderPass> &r
     renderPassInfo.framebuffer = vf->native_framebuffers()[*m_vkCreateInfo.currentImageIndex];
     renderPassInfo.renderArea.offset = {0, 0};
     renderPassInfo.renderArea.extent = {vf->width(), vf->height()};
+    m_renderArea = renderPassInfo.renderArea.extent;
+    m_viewportSet = m_scissorSet = false;
     auto& clearValues = vrp->clear_values();
     renderPassInfo.clearValueCount = clearValues.size();
     renderPassInfo.pClearValues = clearValues.data();
@@ -114,9 +156,38 @@ void VulkanCommandBuffer::end_render_pass() {
 }
 
 void VulkanCommandBuffer::bind_shader(const std::shared_ptr<Shader> &shader) {
+    m_skipDraws = !shader->is_ready();
+    if (m_skipDraws){
+        m_boundShader.reset();
+        return;
+    }
     m_boundShader = std::static_pointer_cast<VulkanShader>(shader);
 
     VK_CALL vkCmdBindPipeline(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, m_boundShader->get_pipeline());
+
+    //derives viewport and scissor from the render area unless they were set explicitly for this pass
+    auto& shaderInfo = m_boundShader->create_info();
+    if (shaderInfo.dynamicStates){
+        VkExtent2D extent = {};
+        extent.width = m_renderArea.width * shaderInfo.viewport.widthPercent;
+        extent.height = m_renderArea.height * shaderInfo.viewport.heightPercent;
+        if (!m_viewportSet){
+            VkViewport viewport = {};
+            viewport.x = shaderInfo.viewport.x;
+            viewport.y = shaderInfo.viewport.y;
+            viewport.width = (float)extent.width;
+            viewport.height = (float)extent.height;
+            viewport.minDepth = 0.0f;
+            viewport.maxDepth = 1.0f;
+            VK_CALL vkCmdSetViewport(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], 0, 1, &viewport);
+        }
+        if (!m_scissorSet){
+            VkRect2D scissor = {};
+            scissor.offset = {static_cast<int32_t>(shaderInfo.viewport.x), static_cast<int32_t>(shaderInfo.viewport.y)};
+            scissor.extent = extent;
+            VK_CALL vkCmdSetScissor(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], 0, 1, &scissor);
+        }
+    }
 }
 
 void VulkanCommandBuffer::bind_compute_shader(const std::shared_ptr<ComputeShader> &shader) {
@@ -128,6 +199,7 @@ void VulkanCommandBuffer::bind_compute_shader(const std::shared_ptr<ComputeShade
 void VulkanCommandBuffer::bind_vertex_buffer(const std::shared_ptr<VertexBuffer> &vertexBuffer) {
     std::shared_ptr<VulkanVertexBuffer> vvb = std::static_pointer_cast<VulkanVertexBuffer>(vertexBuffer);
     VkDeviceSize offsets[] = {0};
+    m_pendingVertices = !vvb->is_ready();
 
     VK_CALL vkCmdBindVertexBuffers(
             m_commandBuffers[*m_vkCreateInfo.currentImageIndex],
@@ -137,8 +209,15 @@ void VulkanCommandBuffer::bind_vertex_buffer(const std::shared_ptr<VertexBuffer>
             offsets);
 }
 
+void VulkanCommandBuffer::bind_vertex_buffer(const FrameAllocation &allocation, uint32_t binding) {
+    VkBuffer buffer = VulkanFrameRing::native_buffer();
+    VkDeviceSize offset = allocation.offset;
+    VK_CALL vkCmdBindVertexBuffers(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], binding, 1, &buffer, &offset);
+}
+
 void VulkanCommandBuffer::bind_index_buffer(const std::shared_ptr<IndexBuffer> &indexBuffer) {
     std::shared_ptr<VulkanIndexBuffer> vib = std::static_pointer_cast<VulkanIndexBuffer>(indexBuffer);
+    m_pendingIndices = !vib->is_ready();
 
     VK_CALL vkCmdBindIndexBuffer(
             m_commandBuffers[*m_vkCreateInfo.currentImageIndex],
@@ -148,7 +227,16 @@ void VulkanCommandBuffer::bind_index_buffer(const std::shared_ptr<IndexBuffer> &
 }
 
 void VulkanCommandBuffer::bind_descriptor_sets(const std::shared_ptr<DescriptorSet> &descriptorSet, uint32_t setIndex) {
+    if (m_skipDraws){
+        return;
+    }
     std::shared_ptr<VulkanDescriptorSet> vds = std::static_pointer_cast<VulkanDescriptorSet>(descriptorSet);
+    if (vds->is_ready()){
+        m_pendingSets &= ~(1u << setIndex);
+    }
+    else {
+        m_pendingSets |= 1u << setIndex;
+    }
 
     VK_CALL vkCmdBindDescriptorSets(
             m_commandBuffers[*m_vkCreateInfo.currentImageIndex],
@@ -161,9 +249,39 @@ void VulkanCommandBuffer::bind_descriptor_sets(const std::shared_ptr<DescriptorS
             nullptr);
 }
 
+void VulkanCommandBuffer::bind_descriptor_sets(const std::shared_ptr<DescriptorSet> &descriptorSet, uint32_t setIndex,
+                                               const std::vector<uint32_t> &dynamicOffsets) {
+    if (m_skipDraws){
+        return;
+    }
+    std::shared_ptr<VulkanDescriptorSet> vds = std::static_pointer_cast<VulkanDescriptorSet>(descriptorSet);
+    if (vds->is_ready()){
+        m_pendingSets &= ~(1u << setIndex);
+    }
+    else {
+        m_pendingSets |= 1u << setIndex;
+    }
+
+    VK_CALL vkCmdBindDescriptorSets(
+            m_commandBuffers[*m_vkCreateInfo.currentImageIndex],
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            m_boundShader->get_layout(),
+            setIndex,
+            1,
+            &vds->get_descriptors()[*m_vkCreateInfo.currentImageIndex],
+            static_cast<uint32_t>(dynamicOffsets.size()),
+            dynamicOffsets.data());
+}
+
 void VulkanCommandBuffer::bind_descriptor_sets(const std::shared_ptr<ComputeShader> &shader, const std::shared_ptr<DescriptorSet> &descriptorSet, uint32_t setIndex) {
     std::shared_ptr<VulkanComputeShader> vcs = std::static_pointer_cast<VulkanComputeShader>(shader);
     std::shared_ptr<VulkanDescriptorSet> vds = std::static_pointer_cast<VulkanDescriptorSet>(descriptorSet);
+    if (vds->is_ready()){
+        m_pendingComputeSets &= ~(1u << setIndex);
+    }
+    else {
+        m_pendingComputeSets |= 1u << setIndex;
+    }
 
     VK_CALL vkCmdBindDescriptorSets(
             m_commandBuffers[*m_vkCreateInfo.currentImageIndex],
@@ -177,6 +295,9 @@ void VulkanCommandBuffer::bind_descriptor_sets(const std::shared_ptr<ComputeShad
 }
 
 void VulkanCommandBuffer::push_constants(ShaderStage stage, uint32_t offset, size_t size, void *data) {
+    if (m_skipDraws){
+        return;
+    }
 
     VK_CALL vkCmdPushConstants(
             m_commandBuffers[*m_vkCreateInfo.currentImageIndex],
@@ -188,13 +309,36 @@ void VulkanCommandBuffer::push_constants(ShaderStage stage, uint32_t offset, siz
 }
 
 void VulkanCommandBuffer::draw(uint32_t vertexCount) {
+    if (skip_draws()){
+        return;
+    }
     VK_CALL vkCmdDraw(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], vertexCount, 1, 0, 0);
 }
 
 void VulkanCommandBuffer::draw_indexed(uint32_t indicesCount, uint32_t indexOffset, uint32_t vertexOffset) {
+    if (skip_draws()){
+        return;
+    }
     VK_CALL vkCmdDrawIndexed(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], indicesCount, 1, indexOffset, vertexOffset, 0);
 }
 
+void VulkanCommandBuffer::draw_instanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex,
+                                         uint32_t firstInstance) {
+    if (skip_draws()){
+        return;
+    }
+    VK_CALL vkCmdDraw(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], vertexCount, instanceCount, firstVertex, firstInstance);
+}
+
+void VulkanCommandBuffer::draw_indexed_instanced(uint32_t indicesCount, uint32_t instanceCount, uint32_t indexOffset,
+                                                 uint32_t vertexOffset, uint32_t firstInstance) {
+    if (skip_draws()){
+        return;
+    }
+    VK_CALL vkCmdDrawIndexed(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], indicesCount, instanceCount, indexOffset,
+                             vertexOffset, firstInstance);
+}
+
 void VulkanCommandBuffer::set_viewport(float w, float h, float x, float y, float minDepth, float maxDepth) {
     VkViewport viewport ={};
     viewport.width = w;
@@ -205,6 +349,7 @@ void VulkanCommandBuffer::set_viewport(float w, float h, float x, float y, float
     viewport.maxDepth = maxDepth;
 
     VK_CALL vkCmdSetViewport(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], 0, 1, &viewport);
+    m_viewportSet = true;
 }
 
 void VulkanCommandBuffer::set_scissor(uint32_t w, uint32_t h, uint32_t x, uint32_t y) {
@@ -213,6 +358,7 @@ void VulkanCommandBuffer::set_scissor(uint32_t w, uint32_t h, uint32_t x, uint32
     scissor.offset = {static_cast<int32_t>(x), static_cast<int32_t>(y)};
 
     VK_CALL vkCmdSetScissor(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], 0, 1, &scissor);
+    m_scissorSet = true;
 }
 
 void VulkanCommandBuffer::pipeline_barrier(const std::shared_ptr<Image> &image, const std::vector<PipelineStage> &srcPipelineStages,
@@ -241,15 +387,194 @@ void VulkanCommandBuffer::pipeline_barrier(const std::shared_ptr<Image> &image,
             1, &imageMemoryBarrier);
 }
 
+void VulkanCommandBuffer::pipeline_barrier(const std::vector<PipelineStage> &srcPipelineStages,
+                                           const std::vector<PipelineStage> &dstPipelineStages,
+                                           const std::vector<ImageBarrier> &imageBarriers,
+                                           const std::vector<BufferBarrier> &bufferBarriers) {
+    uint32_t imageIndex = *m_vkCreateInfo.currentImageIndex;
+
+    std::vector<VkImageMemoryBarrier> imageMemoryBarriers;
+    imageMemoryBarriers.reserve(imageBarriers.size());
+    for (auto& barrier : imageBarriers){
+        auto vkImage = std::static_pointer_cast<VulkanImage>(barrier.image);
+
+        VkImageMemoryBarrier imageMemoryBarrier = {};
+        imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageMemoryBarrier.oldLayout = VulkanConverter::to_vk(barrier.oldLayout);
+        imageMemoryBarrier.newLayout = VulkanConverter::to_vk(barrier.newLayout);
+        imageMemoryBarrier.srcAccessMask = VulkanConverter::to_vk_flags<VkAccessFlags>(barrier.srcAccess);
+        imageMemoryBarrier.dstAccessMask = VulkanConverter::to_vk_flags<VkAccessFlags>(barrier.dstAccess);
+        imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageMemoryBarrier.image = vkImage->native_images()[imageIndex];
+        imageMemoryBarrier.subresourceRange.aspectMask = barrier.image->aspects().empty() ?
+                VK_IMAGE_ASPECT_COLOR_BIT : VulkanConverter::to_vk_flags<VkImageAspectFlags>(barrier.image->aspects());
+        imageMemoryBarrier.subresourceRange.baseMipLevel = 0;
+        imageMemoryBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+        imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
+        imageMemoryBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+        imageMemoryBarriers.emplace_back(imageMemoryBarrier);
+    }
+
+    std::vector<VkBufferMemoryBarrier> bufferMemoryBarriers;
+    bufferMemoryBarriers.reserve(bufferBarriers.size());
+    for (auto& barrier : bufferBarriers){
+        auto vkBuffer = std::static_pointer_cast<VulkanStorageBuffer>(barrier.buffer);
+
+        VkBufferMemoryBarrier bufferMemoryBarrier = {};
+        bufferMemoryBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        bufferMemoryBarrier.srcAccessMask = VulkanConverter::to_vk_flags<VkAccessFlags>(barrier.srcAccess);
+        bufferMemoryBarrier.dstAccessMask = VulkanConverter::to_vk_flags<VkAccessFlags>(barrier.dstAccess);
+        bufferMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferMemoryBarrier.buffer = vkBuffer->get_buffers()[imageIndex]->native_buffer();
+        bufferMemoryBarrier.offset = 0;
+        bufferMemoryBarrier.size = VK_WHOLE_SIZE;
+        bufferMemoryBarriers.emplace_back(bufferMemoryBarrier);
+    }
+
+    VkPipelineStageFlags srcStageMask = VulkanConverter::to_vk_flags<VkPipelineStageFlags>(srcPipelineStages);
+    VkPipelineStageFlags dstStageMask = VulkanConverter::to_vk_flags<VkPipelineStageFlags>(dstPipelineStages);
+
+    VK_CALL vkCmdPipelineBarrier(
+            m_commandBuffers[imageIndex],
+            srcStageMask ? srcStageMask : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            dstStageMask ? dstStageMask : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            0,
+            0, nullptr,
+            static_cast<uint32_t>(bufferMemoryBarriers.size()), bufferMemoryBarriers.data(),
+            static_cast<uint32_t>(imageMemoryBarriers.size()), imageMemoryBarriers.data());
+}
+
 void VulkanCommandBuffer::dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+    if (m_pendingComputeSets != 0){
+        return;
+    }
     VK_CALL vkCmdDispatch(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], groupCountX, groupCountY, groupCountZ);
 }
 
+VkBuffer VulkanCommandBuffer::native_buffer(const std::shared_ptr<StorageBuffer> &buffer) const {
+    return std::static_pointer_cast<VulkanStorageBuffer>(buffer)->get_buffers()[*m_vkCreateInfo.currentImageIndex]->native_buffer();
+}
+
+void VulkanCommandBuffer::draw_indirect(const std::shared_ptr<StorageBuffer> &buffer, size_t offset, uint32_t drawCount,
+                                        uint32_t stride) {
+    if (skip_draws() || drawCount == 0 || !buffer->is_ready()){
+        return;
+    }
+    VkCommandBuffer commandBuffer = m_commandBuffers[*m_vkCreateInfo.currentImageIndex];
+    if (s_multiDrawIndirect || drawCount == 1){
+        VK_CALL vkCmdDrawIndirect(commandBuffer, native_buffer(buffer), offset, drawCount, stride);
+        return;
+    }
+    for (uint32_t i = 0; i < drawCount; i++){
+        VK_CALL vkCmdDrawIndirect(commandBuffer, native_buffer(buffer), offset + i * stride, 1, stride);
+    }
+}
+
+void VulkanCommandBuffer::draw_indexed_indirect(const std::shared_ptr<StorageBuffer> &buffer, size_t offset,
+                                                uint32_t drawCount, uint32_t stride) {
+    if (skip_draws() || drawCount == 0 || !buffer->is_ready()){
+        return;
+    }
+    VkCommandBuffer commandBuffer = m_commandBuffers[*m_vkCreateInfo.currentImageIndex];
+    if (s_multiDrawIndirect || drawCount == 1){
+        VK_CALL vkCmdDrawIndexedIndirect(commandBuffer, native_buffer(buffer), offset, drawCount, stride);
+        return;
+    }
+    for (uint32_t i = 0; i < drawCount; i++){
+        VK_CALL vkCmdDrawIndexedIndirect(commandBuffer, native_buffer(buffer), offset + i * stride, 1, stride);
+    }
+}
+
+void VulkanCommandBuffer::draw_indirect_count(const std::shared_ptr<StorageBuffer> &buffer, size_t offset,
+                                              const std::shared_ptr<StorageBuffer> &countBuffer, size_t countOffset,
+                                              uint32_t maxDrawCount, uint32_t stride) {
+    if (!s_drawIndirectCount){
+        throw std::runtime_error("draw_indirect_count requires VK_KHR_draw_indirect_count!");
+    }
+    if (skip_draws() || !buffer->is_ready() || !countBuffer->is_ready()){
+        return;
+    }
+    VK_CALL s_drawIndirectCount(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], native_buffer(buffer), offset,
+                                native_buffer(countBuffer), countOffset, maxDrawCount, stride);
+}
+
+void VulkanCommandBuffer::draw_indexed_indirect_count(const std::shared_ptr<StorageBuffer> &buffer, size_t offset,
+                                                      const std::shared_ptr<StorageBuffer> &countBuffer, size_t countOffset,
+                                                      uint32_t maxDrawCount, uint32_t stride) {
+    if (!s_drawIndexedIndirectCount){
+        throw std::runtime_error("draw_indexed_indirect_count requires VK_KHR_draw_indirect_count!");
+    }
+    if (skip_draws() || !buffer->is_ready() || !countBuffer->is_ready()){
+        return;
+    }
+    VK_CALL s_drawIndexedIndirectCount(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], native_buffer(buffer), offset,
+                                       native_buffer(countBuffer), countOffset, maxDrawCount, stride);
+}
+
+bool VulkanCommandBuffer::supports_indirect_count() const {
+    return s_drawIndirectCount != nullptr;
+}
+
+void VulkanCommandBuffer::dispatch_indirect(const std::shared_ptr<StorageBuffer> &buffer, size_t offset) {
+    //the arguments may still be uploading like any bound resource
+    if (m_pendingComputeSets != 0 || !buffer->is_ready()){
+        return;
+    }
+    VK_CALL vkCmdDispatchIndirect(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], native_buffer(buffer), offset);
+}
+
+void VulkanCommandBuffer::begin_gpu_zone(const std::string &name, bool pipelineStatistics) {
+    //pipeline statistics queries of the same pool can't nest, and secondary command buffers would have to inherit them
+    bool statistics = pipelineStatistics && m_gpuZones.empty() && m_createInfo.level != CommandBufferLevel::SECONDARY;
+    m_gpuZones.emplace_back(VulkanGpuProfiler::begin_zone(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], name,
+                                                          static_cast<uint32_t>(m_gpuZones.size()), statistics));
+}
+
+void VulkanCommandBuffer::end_gpu_zone() {
+    if (m_gpuZones.empty()){
+        EG_WARNING("eagle", "end_gpu_zone called without an open zone");
+        return;
+    }
+    VulkanGpuProfiler::end_zone(m_commandBuffers[*m_vkCreateInfo.currentImageIndex], m_gpuZones.back());
+    m_gpuZones.pop_back();
+}
+
+VkCommandBuffer& VulkanCommandBuffer::begin_native() {
+    VkCommandBuffer& commandBuffer = m_commandBuffers[*m_vkCreateInfo.currentImageIndex];
+    if (is_transient()){
+        commandBuffer = VulkanFrameCommandPool::acquire(VulkanConverter::to_vk(m_createInfo.level));
+    }
+    return commandBuffer;
+}
+
+VkCommandBufferUsageFlags VulkanCommandBuffer::usage_flags() const {
+    //buffers from per-image pools are recycled with their pool before being recorded again
+    if (is_transient() || !m_vkCreateInfo.commandPools.empty()){
+        return VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    }
+    return VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+}
+
 void VulkanCommandBuffer::cleanup() {
     if (m_cleared){
         return;
     }
-    VK_CALL vkFreeCommandBuffers(m_vkCreateInfo.device, m_vkCreateInfo.commandPool, m_vkCreateInfo.imageCount, m_commandBuffers.data());
+    if (is_transient()){
+        //owned by VulkanFrameCommandPool
+        m_commandBuffers.clear();
+        m_cleared = true;
+        return;
+    }
+    if (m_vkCreateInfo.commandPools.empty()){
+        VK_CALL vkFreeCommandBuffers(m_vkCreateInfo.device, m_vkCreateInfo.commandPool, m_vkCreateInfo.imageCount, m_commandBuffers.data());
+    }
+    else {
+        for (uint32_t i = 0; i < m_vkCreateInfo.imageCount; i++){
+            VK_CALL vkFreeCommandBuffers(m_vkCreateInfo.device, m_vkCreateInfo.commandPools[i], 1, &m_commandBuffers[i]);
+        }
+    }
     m_cleared = true;
 }
 
@@ -263,8 +588,24 @@ void VulkanCommandBuffer::recreate(uint32_t imageCount) {
 
     m_commandBuffers.resize(imageCount);
 
-    VK_CALL_ASSERT(vkAllocateCommandBuffers(m_vkCreateInfo.device, &allocInfo, m_commandBuffers.data())) {
-        throw std::runtime_error("failed to allocate command buffer!");
+    if (is_transient()){
+        //acquired on begin
+        std::fill(m_commandBuffers.begin(), m_commandBuffers.end(), VK_NULL_HANDLE);
+    }
+    else if (m_vkCreateInfo.commandPools.empty()){
+        VK_CALL_ASSERT(vkAllocateCommandBuffers(m_vkCreateInfo.device, &allocInfo, m_commandBuffers.data())) {
+            throw std::runtime_error("failed to allocate command buffer!");
+        }
+    }
+    else {
+        assert(m_vkCreateInfo.commandPools.size() == imageCount);
+        allocInfo.commandBufferCount = 1;
+        for (uint32_t i = 0; i < imageCount; i++){
+            allocInfo.commandPool = m_vkCreateInfo.commandPools[i];
+            VK_CALL_ASSERT(vkAllocateCommandBuffers(m_vkCreateInfo.device, &allocInfo, &m_commandBuffers[i])) {
+                throw std::runtime_error("failed to allocate command buffer!");
+            }
+        }
     }
     m_cleared = false;
 }
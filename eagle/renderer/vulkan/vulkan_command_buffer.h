@@ -15,6 +15,7 @@ namespace eagle {
 struct VulkanCommandBufferCreateInfo {
     VkDevice device;
     VkCommandPool commandPool;
+    std::vector<VkCommandPool> commandPools;   //one pool per image, overrides commandPool when not empty
     uint32_t imageCount;
     uint32_t* currentImageIndex = nullptr;
 };
@@ -34,29 +35,76 @@ public:
     void end_render_pass() override;
     void bind_shader(const std::shared_ptr<Shader> &shader) override;
     void bind_vertex_buffer(const std::shared_ptr<VertexBuffer> &vertexBuffer) override;
+    void bind_vertex_buffer(const FrameAllocation &allocation, uint32_t binding) override;
     void bind_index_buffer(const std::shared_ptr<IndexBuffer> &indexBuffer) override;
     void push_constants(ShaderStage stage, uint32_t offset, size_t size, void *data) override;
     void bind_descriptor_sets(const std::shared_ptr<DescriptorSet> &descriptorSet, uint32_t setIndex) override;
+    void bind_descriptor_sets(const std::shared_ptr<DescriptorSet> &descriptorSet, uint32_t setIndex,
+                              const std::vector<uint32_t> &dynamicOffsets) override;
     void draw(uint32_t vertexCount) override;
     void draw_indexed(uint32_t indicesCount, uint32_t indexOffset, uint32_t vertexOffset) override;
+    void draw_instanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) override;
+    void draw_indexed_instanced(uint32_t indicesCount, uint32_t instanceCount, uint32_t indexOffset, uint32_t vertexOffset,
+                                uint32_t firstInstance) override;
     void set_viewport(float w, float h, float x, float y, float minDepth, float maxDepth) override;
     void set_scissor(uint32_t w, uint32_t h, uint32_t x, uint32_t y) override;
     void pipeline_barrier(const std::shared_ptr<Image> &image, const std::vector<PipelineStage> &srcPipelineStages, const std::vector<PipelineStage> &dstPipelineStages) override;
+    void pipeline_barrier(const std::vector<PipelineStage> &srcPipelineStages, const std::vector<PipelineStage> &dstPipelineStages,
+                          const std::vector<ImageBarrier> &imageBarriers, const std::vector<BufferBarrier> &bufferBarriers) override;
     void dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override;
+    void draw_indirect(const std::shared_ptr<StorageBuffer> &buffer, size_t offset, uint32_t drawCount, uint32_t stride) override;
+    void draw_indexed_indirect(const std::shared_ptr<StorageBuffer> &buffer, size_t offset, uint32_t drawCount, uint32_t stride) override;
+    void draw_indirect_count(const std::shared_ptr<StorageBuffer> &buffer, size_t offset,
+                             const std::shared_ptr<StorageBuffer> &countBuffer, size_t countOffset, uint32_t maxDrawCount,
+                             uint32_t stride) override;
+    void draw_indexed_indirect_count(const std::shared_ptr<StorageBuffer> &buffer, size_t offset,
+                                     const std::shared_ptr<StorageBuffer> &countBuffer, size_t countOffset, uint32_t maxDrawCount,
+                                     uint32_t stride) override;
+    bool supports_indirect_count() const override;
+    void dispatch_indirect(const std::shared_ptr<StorageBuffer> &buffer, size_t offset) override;
     void bind_compute_shader(const std::shared_ptr<ComputeShader> &shader) override;
     void bind_descriptor_sets(const std::shared_ptr<ComputeShader> &shader, const std::shared_ptr<DescriptorSet> &descriptorSet, uint32_t setIndex) override;
+    void begin_gpu_zone(const std::string &name, bool pipelineStatistics) override;
+    void end_gpu_zone() override;
 
     void cleanup();
     void recreate(uint32_t imageCount);
 
+    inline bool is_transient() const { return m_createInfo.transient; }
+
     inline const std::vector<VkCommandBuffer>& native_command_buffers() { return m_commandBuffers; }
 
+    //device capabilities for indirect draws, set once the device is created
+    static void init_indirect_draws(VkDevice device, bool multiDrawIndirect, bool drawIndirectCount);
+
+private:
+    //transient buffers take a new command buffer from the frame's pool each time they begin
+    VkCommandBuffer& begin_native();
+    VkCommandBufferUsageFlags usage_flags() const;
+    VkBuffer native_buffer(const std::shared_ptr<StorageBuffer> &buffer) const;
+    //draws are dropped while the shader is building or a bound resource is still being uploaded
+    inline bool skip_draws() const { return m_skipDraws || m_pendingVertices || m_pendingIndices || m_pendingSets != 0; }
+    void reset_pending_resources();
+
 private:
     VulkanCommandBufferCreateInfo m_vkCreateInfo;
     std::vector<VkCommandBuffer> m_commandBuffers;
     std::shared_ptr<VulkanShader> m_boundShader;
+    VkExtent2D m_renderArea = {};
+    bool m_viewportSet = false, m_scissorSet = false;
+    bool m_skipDraws = false;   //the bound shader is still being built
+    //bound resources whose async upload hasn't been acquired by the graphics queue yet
+    bool m_pendingVertices = false, m_pendingIndices = false;
+    uint32_t m_pendingSets = 0;  //bit per set index
+    uint32_t m_pendingComputeSets = 0;  //same for the compute bind point, dispatches are dropped while any is set
+    std::vector<uint32_t> m_gpuZones;   //open zones, innermost last
     bool m_finished = false;
     bool m_cleared = true;
+
+    //without multiDrawIndirect every draw of an indirect call is recorded on its own
+    static bool s_multiDrawIndirect;
+    static PFN_vkCmdDrawIndirectCountKHR s_drawIndirectCount;
+    static PFN_vkCmdDrawIndexedIndirectCountKHR s_drawIndexedIndirectCount;
 };
 
 }
@@ -5,12 +5,14 @@
 #include <eagle/renderer/vulkan/vulkan_compute_shader.h>
 #include <eagle/renderer/vulkan/vulkan_shader_utils.h>
 #include <eagle/renderer/vulkan/vulkan_converter.h>
+#include <eagle/renderer/vulkan/vulkan_uploader.h>
+#include <eagle/renderer/vulkan/vulkan_compute_sync.h>
 #include <eagle/file_system.h>
 
 namespace eagle {
 
 VulkanComputeShader::VulkanComputeShader(const std::string &path, const VulkanComputeShaderCreateInfo &createInfo)
-        : m_createInfo(createInfo) {
+        : m_createInfo(createInfo), m_name(path) {
 
     std::vector<uint8_t> byteCode = std::move(FileSystem::instance()->read_bytes(path));
     m_code.resize(byteCode.size() / sizeof(uint32_t));
@@ -19,13 +21,16 @@ VulkanComputeShader::VulkanComputeShader(const std::string &path, const VulkanCo
     create_pipeline_layout();
     create_pipeline();
     create_descriptor_sets();
-    create_command_buffer();
-    create_fence();
+    m_frames.resize(m_createInfo.frameCount);
 }
 
 VulkanComputeShader::~VulkanComputeShader(){
-    VK_CALL vkDestroyFence(m_createInfo.device, m_fence, nullptr);
-    VK_CALL vkFreeCommandBuffers(m_createInfo.device, m_createInfo.commandPool, 1, &m_commandBuffer);
+    for (auto& frame : m_frames){
+        for (auto& submission : frame.submissions){
+            destroy_submission(submission);
+        }
+    }
+    m_frames.clear();
     cleanup_pipeline();
     VK_CALL vkDestroyPipelineLayout(m_createInfo.device, m_pipelineLayout, nullptr);
     clear_descriptor_set();
@@ -84,7 +89,7 @@ void VulkanComputeShader::create_pipeline(){
     computePipelineCreateInfo.layout = m_pipelineLayout;
     computePipelineCreateInfo.stage = vertShaderStageInfo;
 
-    VK_CALL_ASSERT(vkCreateComputePipelines(m_createInfo.device, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, nullptr, &m_computePipeline)){
+    VK_CALL_ASSERT(vkCreateComputePipelines(m_createInfo.device, m_createInfo.pipelineCache, 1, &computePipelineCreateInfo, nullptr, &m_computePipeline)){
         throw std::runtime_error("Failed to create compute pipeline!");
     }
 
@@ -103,28 +108,52 @@ void VulkanComputeShader::create_descriptor_sets() {
 }
 
 
-void VulkanComputeShader::create_command_buffer() {
-    EG_TRACE("eagle","BEGIN");
+void VulkanComputeShader::create_submission(Submission &submission) {
     VkCommandBufferAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocInfo.commandPool = m_createInfo.commandPool;
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
     allocInfo.commandBufferCount = 1;
 
-    VK_CALL_ASSERT(vkAllocateCommandBuffers(m_createInfo.device, &allocInfo, &m_commandBuffer)) {
+    VK_CALL_ASSERT(vkAllocateCommandBuffers(m_createInfo.device, &allocInfo, &submission.commandBuffer)) {
         throw std::runtime_error("failed to allocate compute shader command buffer!");
     }
-    EG_TRACE("eagle","END");
-}
 
-void VulkanComputeShader::create_fence() {
-    EG_TRACE("eagle","BEGIN");
     VkFenceCreateInfo fenceCreateInfo = {};
     fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-    VK_CALL vkCreateFence(m_createInfo.device, &fenceCreateInfo, nullptr, &m_fence);
-    EG_TRACE("eagle","END");
+    VK_CALL vkCreateFence(m_createInfo.device, &fenceCreateInfo, nullptr, &submission.fence);
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    VK_CALL vkCreateSemaphore(m_createInfo.device, &semaphoreCreateInfo, nullptr, &submission.uploadSemaphore);
+    VK_CALL vkCreateSemaphore(m_createInfo.device, &semaphoreCreateInfo, nullptr, &submission.finishedSemaphore);
+
+    submission.queryPool = VulkanGpuProfiler::create_compute_query_pool(1);
+}
+
+void VulkanComputeShader::destroy_submission(Submission &submission) {
+    VK_CALL vkWaitForFences(m_createInfo.device, 1, &submission.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+    VK_CALL vkDestroyFence(m_createInfo.device, submission.fence, nullptr);
+    VK_CALL vkDestroySemaphore(m_createInfo.device, submission.uploadSemaphore, nullptr);
+    VK_CALL vkDestroySemaphore(m_createInfo.device, submission.finishedSemaphore, nullptr);
+    VK_CALL vkFreeCommandBuffers(m_createInfo.device, m_createInfo.commandPool, 1, &submission.commandBuffer);
+    submission.queryPool.reset();
+}
+
+VulkanComputeShader::Submission& VulkanComputeShader::next_submission() {
+    Frame& frame = m_frames[VulkanComputeSync::current_frame()];
+    if (frame.frameNumber != VulkanComputeSync::frame_number()){
+        frame.frameNumber = VulkanComputeSync::frame_number();
+        frame.used = 0;
+    }
+    if (frame.used == frame.submissions.size()){
+        frame.submissions.emplace_back();
+        create_submission(frame.submissions.back());
+    }
+    return frame.submissions[frame.used++];
 }
 
 void VulkanComputeShader::cleanup_pipeline(){
@@ -141,33 +170,76 @@ void VulkanComputeShader::cleanup_pipeline(){
 
 void VulkanComputeShader::dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
 
-    VK_CALL vkQueueWaitIdle(m_createInfo.computeQueue);
+    Submission& submission = next_submission();
+
+    //submitted a whole frame slot ago and waited on by that frame's graphics, whose fence prepare_frame already
+    //waited on, so this never stalls
+    VK_CALL vkWaitForFences(m_createInfo.device, 1, &submission.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+
+    if (submission.queryPool){
+        VulkanGpuProfiler::resolve_query_pool(*submission.queryPool);
+    }
 
     VkCommandBufferBeginInfo beginInfo = {};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VK_CALL vkBeginCommandBuffer(submission.commandBuffer, &beginInfo);
+
+    uint32_t zone = VulkanGpuQueryPool::INVALID_ZONE;
+    if (submission.queryPool){
+        submission.queryPool->record_reset(submission.commandBuffer, 1);
+        zone = submission.queryPool->begin_zone(submission.commandBuffer, m_name, 0, true);
+    }
 
-    VK_CALL vkBeginCommandBuffer(m_commandBuffer, &beginInfo);
+    VK_CALL vkCmdBindPipeline(submission.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
 
-    VK_CALL vkCmdBindPipeline(m_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
+    VK_CALL vkCmdBindDescriptorSets(submission.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &m_descriptorSet->get_descriptors()[*m_createInfo.imageIndex], 0, nullptr);
 
-    VK_CALL vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &m_descriptorSet->get_descriptors()[*m_createInfo.imageIndex], 0, nullptr);
+    VK_CALL vkCmdDispatch(submission.commandBuffer, groupCountX, groupCountY, groupCountZ);
 
-    VK_CALL vkCmdDispatch(m_commandBuffer, groupCountX, groupCountY, groupCountZ);
+    if (submission.queryPool){
+        submission.queryPool->end_zone(submission.commandBuffer, zone);
+    }
+
+    VK_CALL vkEndCommandBuffer(submission.commandBuffer);
 
-    VK_CALL vkEndCommandBuffer(m_commandBuffer);
+    VkSemaphore waitSemaphores[2];
+    VkPipelineStageFlags waitStages[2];
+    uint32_t waitCount = 0;
 
-    VK_CALL vkWaitForFences(m_createInfo.device, 1, &m_fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
-    VK_CALL vkResetFences(m_createInfo.device, 1, &m_fence);
+    //pending uploads are flushed here since the compute queue is not ordered with the upload queue
+    VulkanUploader::poll();
+    if (VulkanUploader::submit(submission.uploadSemaphore)){
+        waitSemaphores[waitCount] = submission.uploadSemaphore;
+        waitStages[waitCount++] = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    }
+
+    if (m_waitForGraphics){
+        VkSemaphore graphicsSemaphore = VulkanComputeSync::take_graphics_signal();
+        if (graphicsSemaphore != VK_NULL_HANDLE){
+            waitSemaphores[waitCount] = graphicsSemaphore;
+            waitStages[waitCount++] = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        }
+    }
 
     VkSubmitInfo computeSubmitInfo = {};
     computeSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     computeSubmitInfo.commandBufferCount = 1;
-    computeSubmitInfo.pCommandBuffers = &m_commandBuffer;
+    computeSubmitInfo.pCommandBuffers = &submission.commandBuffer;
+    computeSubmitInfo.waitSemaphoreCount = waitCount;
+    computeSubmitInfo.pWaitSemaphores = waitSemaphores;
+    computeSubmitInfo.pWaitDstStageMask = waitStages;
+    computeSubmitInfo.signalSemaphoreCount = 1;
+    computeSubmitInfo.pSignalSemaphores = &submission.finishedSemaphore;
+
+    VK_CALL vkResetFences(m_createInfo.device, 1, &submission.fence);
 
-    VK_CALL_ASSERT(vkQueueSubmit(m_createInfo.computeQueue, 1, &computeSubmitInfo, m_fence)){
+    VK_CALL_ASSERT(vkQueueSubmit(m_createInfo.computeQueue, 1, &computeSubmitInfo, submission.fence)){
         throw std::runtime_error("Failed to submit compute command buffer!");
     }
+
+    VulkanComputeSync::add_compute_signal(submission.finishedSemaphore);
 }
 
 void VulkanComputeShader::clear_descriptor_set() {
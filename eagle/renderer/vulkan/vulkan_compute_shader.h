@@ -9,13 +9,16 @@
 #include <eagle/renderer/vulkan/vulkan_global_definitions.h>
 #include <eagle/renderer/vulkan/vulkan_descriptor_set_layout.h>
 #include <eagle/renderer/vulkan/vulkan_descriptor_set.h>
+#include <eagle/renderer/vulkan/vulkan_gpu_profiler.h>
 
 namespace eagle {
 
 struct VulkanComputeShaderCreateInfo{
     VkDevice device;
+    VkPipelineCache pipelineCache;
     VkCommandPool commandPool;
     VkQueue computeQueue;
+    uint32_t frameCount;
     uint32_t bufferCount;
     uint32_t* imageIndex;
 };
@@ -47,8 +50,26 @@ private:
 
     void create_pipeline_layout();
     void create_descriptor_sets();
-    void create_command_buffer();
-    void create_fence();
+
+private:
+    struct Submission {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        VkSemaphore uploadSemaphore = VK_NULL_HANDLE;
+        VkSemaphore finishedSemaphore = VK_NULL_HANDLE;   //waited on by the frame's graphics submission
+        std::unique_ptr<VulkanGpuQueryPool> queryPool;
+    };
+
+    //submissions of one frame slot, reused once the slot comes around again
+    struct Frame {
+        std::vector<Submission> submissions;
+        size_t used = 0;
+        uint64_t frameNumber = 0;
+    };
+
+    Submission& next_submission();
+    void create_submission(Submission& submission);
+    void destroy_submission(Submission& submission);
 
 private:
 
@@ -59,8 +80,8 @@ private:
     std::vector<DescriptorBindingDescription> m_bindingDescriptions;
     std::shared_ptr<VulkanDescriptorSetLayout> m_descriptorLayout;
     std::shared_ptr<VulkanDescriptorSet> m_descriptorSet;
-    VkCommandBuffer m_commandBuffer;
-    VkFence m_fence;
+    std::vector<Frame> m_frames;
+    std::string m_name;
 
     bool m_cleared = true;
 };
@@ -0,0 +1,94 @@
+#include <eagle/renderer/vulkan/vulkan_compute_sync.h>
+#include <eagle/log.h>
+
+namespace eagle {
+
+VkDevice VulkanComputeSync::s_device = VK_NULL_HANDLE;
+uint32_t VulkanComputeSync::s_currentFrame = 0;
+uint64_t VulkanComputeSync::s_frameNumber = 0;
+std::vector<VkSemaphore> VulkanComputeSync::s_computeSignals;
+std::vector<VkSemaphore> VulkanComputeSync::s_graphicsSignals;
+std::vector<bool> VulkanComputeSync::s_graphicsSignaled;
+uint32_t VulkanComputeSync::s_lastGraphicsSignal = VulkanComputeSync::NO_SIGNAL;
+bool VulkanComputeSync::s_signalGraphics = false;
+
+void VulkanComputeSync::init(VkDevice device, uint32_t frameCount) {
+    EG_TRACE("eagle","Initializing vulkan compute sync!");
+    s_device = device;
+    s_currentFrame = 0;
+    s_frameNumber = 0;
+    s_lastGraphicsSignal = NO_SIGNAL;
+    s_signalGraphics = false;
+    s_graphicsSignals.resize(frameCount);
+    s_graphicsSignaled.assign(frameCount, false);
+    for (auto& semaphore : s_graphicsSignals){
+        create_semaphore(semaphore);
+    }
+}
+
+void VulkanComputeSync::destroy() {
+    for (auto& semaphore : s_graphicsSignals){
+        VK_CALL vkDestroySemaphore(s_device, semaphore, nullptr);
+    }
+    s_graphicsSignals.clear();
+    s_graphicsSignaled.clear();
+    s_computeSignals.clear();
+    s_device = VK_NULL_HANDLE;
+}
+
+void VulkanComputeSync::create_semaphore(VkSemaphore &semaphore) {
+    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    VK_CALL_ASSERT(vkCreateSemaphore(s_device, &semaphoreCreateInfo, nullptr, &semaphore)) {
+        throw std::runtime_error("failed to create compute sync semaphore!");
+    }
+}
+
+void VulkanComputeSync::begin_frame(uint32_t frameIndex) {
+    s_currentFrame = frameIndex;
+    s_frameNumber++;
+    if (s_lastGraphicsSignal == frameIndex){
+        s_lastGraphicsSignal = NO_SIGNAL;
+    }
+    if (s_graphicsSignaled[frameIndex]){
+        //no compute submission waited on it, a signaled binary semaphore can't be signaled again.
+        //the fence covering its signal has completed, so it can be replaced
+        VK_CALL vkDestroySemaphore(s_device, s_graphicsSignals[frameIndex], nullptr);
+        create_semaphore(s_graphicsSignals[frameIndex]);
+        s_graphicsSignaled[frameIndex] = false;
+    }
+}
+
+void VulkanComputeSync::add_compute_signal(VkSemaphore semaphore) {
+    s_computeSignals.emplace_back(semaphore);
+}
+
+VkSemaphore VulkanComputeSync::take_graphics_signal() {
+    //from now on every graphics submission signals, the first dispatch asking has nothing to wait on yet
+    s_signalGraphics = true;
+    if (s_lastGraphicsSignal == NO_SIGNAL){
+        return VK_NULL_HANDLE;
+    }
+    uint32_t frame = s_lastGraphicsSignal;
+    s_lastGraphicsSignal = NO_SIGNAL;
+    s_graphicsSignaled[frame] = false;
+    return s_graphicsSignals[frame];
+}
+
+void VulkanComputeSync::prepare_graphics_submit(std::vector<VkSemaphore> &waitSemaphores,
+                                                std::vector<VkPipelineStageFlags> &waitStages,
+                                                std::vector<VkSemaphore> &signalSemaphores) {
+    for (auto& semaphore : s_computeSignals){
+        waitSemaphores.emplace_back(semaphore);
+        waitStages.emplace_back(GRAPHICS_WAIT_STAGES);
+    }
+    s_computeSignals.clear();
+
+    if (s_signalGraphics && !s_graphicsSignaled[s_currentFrame]){
+        signalSemaphores.emplace_back(s_graphicsSignals[s_currentFrame]);
+        s_graphicsSignaled[s_currentFrame] = true;
+        s_lastGraphicsSignal = s_currentFrame;
+    }
+}
+
+}
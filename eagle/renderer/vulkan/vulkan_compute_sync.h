@@ -0,0 +1,59 @@
+#ifndef EAGLE_VULKANCOMPUTESYNC_H
+#define EAGLE_VULKANCOMPUTESYNC_H
+
+#include "vulkan_global_definitions.h"
+
+namespace eagle {
+
+//Orders async compute submissions against the frame's graphics submission with semaphores instead of CPU waits.
+//Every compute submission signals a semaphore the next graphics submission waits on. Compute submissions that
+//ask for it wait on a semaphore signaled by the previous graphics submission. That semaphore is only signaled once
+//some dispatch asked for it, and a signal nobody waited on is dropped when its frame slot begins again.
+//Only used from the thread that drives the frame.
+class VulkanComputeSync {
+public:
+    //stages of the graphics submission that wait on compute results
+    static constexpr VkPipelineStageFlags GRAPHICS_WAIT_STAGES =
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+            VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+    static void init(VkDevice device, uint32_t frameCount);
+    static void destroy();
+
+    //called once the frame's fence has signaled
+    static void begin_frame(uint32_t frameIndex);
+
+    static inline uint32_t current_frame() { return s_currentFrame; }
+    //increases every frame, tells apart two uses of the same frame slot
+    static inline uint64_t frame_number() { return s_frameNumber; }
+
+    //the next graphics submission waits on the semaphore before its vertex stages
+    static void add_compute_signal(VkSemaphore semaphore);
+
+    //semaphore signaled by the last graphics submission, VK_NULL_HANDLE if there is none to wait on.
+    //the caller's submission has to wait on it, it is only handed out once
+    static VkSemaphore take_graphics_signal();
+
+    //appends the waits and signals of the frame's graphics submission
+    static void prepare_graphics_submit(std::vector<VkSemaphore>& waitSemaphores, std::vector<VkPipelineStageFlags>& waitStages,
+                                        std::vector<VkSemaphore>& signalSemaphores);
+
+private:
+    static void create_semaphore(VkSemaphore& semaphore);
+
+private:
+    static constexpr uint32_t NO_SIGNAL = UINT32_MAX;
+
+    static VkDevice s_device;
+    static uint32_t s_currentFrame;
+    static uint64_t s_frameNumber;
+    static std::vector<VkSemaphore> s_computeSignals;
+    static std::vector<VkSemaphore> s_graphicsSignals;
+    static std::vector<bool> s_graphicsSignaled;
+    static uint32_t s_lastGraphicsSignal;
+    static bool s_signalGraphics;
+};
+
+}
+
+#endif //EAGLE_VULKANCOMPUTESYNC_H
@@ -3,15 +3,22 @@
 //
 
 #include <set>
+#include <cstring>
 
 #include "vulkan_context.h"
 #include "vulkan_helper.h"
+#include "vulkan_uploader.h"
+#include "vulkan_descriptor_allocator.h"
+#include "vulkan_frame_command_pool.h"
+#include "vulkan_gpu_profiler.h"
+#include "vulkan_deletion_queue.h"
 #include <eagle/renderer/vulkan/vulkan_command_buffer.h>
 #include "eagle/window.h"
 
 
 #include "eagle/log.h"
 #include <eagle/renderer/vulkan/vulkan_converter.h>
+#include <eagle/renderer/mip_chain_builder.h>
 
 namespace eagle {
 
@@ -27,8 +34,16 @@ void VulkanContext::destroy() {
 
     EG_TRACE("eagle", "Terminating vulkan!");
 
+    if (m_workerPool){
+        m_workerPool->wait_idle();
+    }
+
     VK_CALL vkDeviceWaitIdle(m_device);
 
+    if (m_pipelineCache){
+        m_pipelineCache->save();
+    }
+
     m_vertexBuffers.clear();
     m_indexBuffers.clear();
 
@@ -39,9 +54,14 @@ void VulkanContext::destroy() {
     m_textures.clear();
     m_shaders.clear();
     m_computeShaders.clear();
+    m_parallelRecorder.reset();
+    m_workerPool.reset();
     m_present.renderPass.reset();
     m_renderPasses.clear();
     m_framebuffers.clear();
+    m_storageBuffers.clear();
+    m_dynamicUniformBuffers.clear();
+    m_images.clear();
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
         VK_CALL
@@ -59,6 +79,17 @@ void VulkanContext::destroy() {
     VK_CALL
     vkDestroyCommandPool(m_device, m_computeCommandPool, nullptr);
 
+    m_pipelineCache.reset();
+    VulkanTextureStreamer::destroy();
+    VulkanDeletionQueue::destroy();
+    VulkanDescriptorAllocator::destroy();
+    VulkanFrameRing::destroy();
+    VulkanComputeSync::destroy();
+    VulkanGpuProfiler::destroy();
+    VulkanFrameCommandPool::destroy();
+    VulkanUploader::destroy();
+    VulkanMemoryAllocator::destroy();
+
     VK_CALL
     vkDestroyDevice(m_device, nullptr);
 
@@ -364,6 +395,17 @@ VulkanContext::QueueFamilyIndices VulkanContext::find_family_indices(VkPhysicalD
         }
     }
 
+    //transfer only families usually map to the dedicated copy engines
+    i = 0;
+    for (const auto &queueFamily : queueFamilies) {
+        bool transferOnly = (queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0;
+        if (queueFamily.queueCount > 0 && (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) && transferOnly){
+            indices.transferFamily = i;
+            break;
+        }
+        i++;
+    }
+
     return indices;
 }
 
@@ -393,6 +435,36 @@ bool VulkanContext::check_device_extension_support(VkPhysicalDevice device) {
     return requiredExtensions.empty();
 }
 
+bool VulkanContext::is_device_extension_available(VkPhysicalDevice device, const char *extensionName) {
+    uint32_t extensionCount;
+    VK_CALL vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    VK_CALL vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+    for (const auto &extension : availableExtensions) {
+        if (strcmp(extension.extensionName, extensionName) == 0){
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VulkanContext::is_instance_extension_available(const char *extensionName) {
+    uint32_t extensionCount;
+    VK_CALL vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    VK_CALL vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, availableExtensions.data());
+
+    for (const auto &extension : availableExtensions) {
+        if (strcmp(extension.extensionName, extensionName) == 0){
+            return true;
+        }
+    }
+    return false;
+}
+
 VulkanContext::SwapChainSupportDetails VulkanContext::query_swapchain_support(VkPhysicalDevice device) {
 
     EG_TRACE("eagle","Querying swapchain support!");
@@ -434,6 +506,9 @@ void VulkanContext::create_logical_device() {
 
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value(), indices.computeFamily.value()};
+    if (indices.transferFamily.has_value()){
+        uniqueQueueFamilies.insert(indices.transferFamily.value());
+    }
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -445,8 +520,19 @@ void VulkanContext::create_logical_device() {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    VkPhysicalDeviceFeatures supportedFeatures = {};
+    VK_CALL vkGetPhysicalDeviceFeatures(m_physicalDevice, &supportedFeatures);
+
     VkPhysicalDeviceFeatures deviceFeatures = {};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    //lets gpu zones report vertex, fragment and compute invocations
+    deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+    //indirect calls with more than one draw, and firstInstance in indirect arguments
+    deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+    deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+    //block compressed textures, desktop devices usually support BC and mobile ones ETC2
+    deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    deviceFeatures.textureCompressionETC2 = supportedFeatures.textureCompressionETC2;
 
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -456,8 +542,34 @@ void VulkanContext::create_logical_device() {
 
     createInfo.pEnabledFeatures = &deviceFeatures;
 
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    std::vector<const char*> enabledExtensions = deviceExtensions;
+
+    //timeline semaphores let the renderer query transfer completion without a fence per batch,
+    //the extension depends on VK_KHR_get_physical_device_properties2, without it the uploader falls back to fences
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures = {};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+    timelineFeatures.timelineSemaphore = VK_TRUE;
+    bool timelineSemaphoreSupported = indices.transferFamily.has_value() && m_physicalDeviceProperties2Enabled &&
+            is_device_extension_available(m_physicalDevice, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    if (timelineSemaphoreSupported){
+        enabledExtensions.emplace_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+        createInfo.pNext = &timelineFeatures;
+    }
+
+    //lets descriptor sets be written with a single call from a packed array of infos
+    bool descriptorUpdateTemplateSupported = is_device_extension_available(m_physicalDevice, VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME);
+    if (descriptorUpdateTemplateSupported){
+        enabledExtensions.emplace_back(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME);
+    }
+
+    //lets GPU generated draw lists decide how many draws they issue
+    bool drawIndirectCountSupported = is_device_extension_available(m_physicalDevice, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    if (drawIndirectCountSupported){
+        enabledExtensions.emplace_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    }
+
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
     if (enableValidationLayers) {
         createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -473,10 +585,41 @@ void VulkanContext::create_logical_device() {
     VK_CALL vkGetDeviceQueue(m_device, indices.graphicsFamily.value(), 0, &m_graphicsQueue);
     VK_CALL vkGetDeviceQueue(m_device, indices.presentFamily.value(), 0, &m_presentQueue);
     VK_CALL vkGetDeviceQueue(m_device, indices.computeFamily.value(), 0, &m_computeQueue);
+    if (indices.transferFamily.has_value()){
+        VK_CALL vkGetDeviceQueue(m_device, indices.transferFamily.value(), 0, &m_transferQueue);
+    }
+
+    VulkanMemoryAllocator::init(m_physicalDevice, m_device);
+
+    VulkanUploaderCreateInfo uploaderCreateInfo = {};
+    uploaderCreateInfo.physicalDevice = m_physicalDevice;
+    uploaderCreateInfo.device = m_device;
+    uploaderCreateInfo.graphicsQueue = m_graphicsQueue;
+    uploaderCreateInfo.graphicsFamilyIndex = indices.graphicsFamily.value();
+    uploaderCreateInfo.transferQueue = m_transferQueue;
+    uploaderCreateInfo.transferFamilyIndex = indices.transferFamily.value_or(0);
+    uploaderCreateInfo.timelineSemaphoreSupported = timelineSemaphoreSupported;
+    VulkanUploader::init(uploaderCreateInfo);
+
+    VulkanGpuProfiler::init(m_physicalDevice, m_device, indices.graphicsFamily.value(), indices.computeFamily.value(),
+                            MAX_FRAMES_IN_FLIGHT, deviceFeatures.pipelineStatisticsQuery == VK_TRUE);
+    VulkanDescriptorAllocator::init(m_device, MAX_FRAMES_IN_FLIGHT, descriptorUpdateTemplateSupported);
+    VulkanFrameRing::init(m_physicalDevice, m_device, MAX_FRAMES_IN_FLIGHT);
+    VulkanComputeSync::init(m_device, MAX_FRAMES_IN_FLIGHT);
+    VulkanDeletionQueue::init(MAX_FRAMES_IN_FLIGHT);
+    VulkanCommandBuffer::init_indirect_draws(m_device, deviceFeatures.multiDrawIndirect == VK_TRUE, drawIndirectCountSupported);
 
     EG_TRACE("eagle","Logical device created!");
 }
 
+void VulkanContext::create_pipeline_cache() {
+    VulkanPipelineCacheCreateInfo createInfo = {};
+    createInfo.physicalDevice = m_physicalDevice;
+    createInfo.device = m_device;
+    createInfo.path = m_pipelineCachePath;
+    m_pipelineCache = std::make_shared<VulkanPipelineCache>(createInfo);
+}
+
 VkSurfaceFormatKHR VulkanContext::choose_swap_surface_format(const std::vector<VkSurfaceFormatKHR> &formats) {
 
     if (formats.size() == 1 && formats[0].format == VK_FORMAT_UNDEFINED) {
@@ -496,7 +639,7 @@ VkSurfaceFormatKHR VulkanContext::choose_swap_surface_format(const std::vector<V
     return formats[0];
 }
 
-void VulkanContext::create_swapchain() {
+void VulkanContext::create_swapchain(VkSwapchainKHR oldSwapchain) {
 
     EG_TRACE("eagle","Creating swapchain!");
     //Verifica o suporte de swapChains
@@ -557,11 +700,15 @@ void VulkanContext::create_swapchain() {
     createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE;
 
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    createInfo.oldSwapchain = oldSwapchain;
 
     VK_CALL_ASSERT(vkCreateSwapchainKHR(m_device, &createInfo, nullptr, &m_present.swapchain)) {
         throw std::runtime_error("failed to create swap chain!");
     }
+
+    m_windowWidth = m_window->width();
+    m_windowHeight = m_window->height();
+    m_resizeRequested = false;
 }
 
 VkPresentModeKHR VulkanContext::choose_swap_present_mode(const std::vector<VkPresentModeKHR> &presentModes) {
@@ -639,6 +786,9 @@ void VulkanContext::create_framebuffers() {
 
     VK_CALL vkGetSwapchainImagesKHR(m_device, m_present.swapchain, &m_present.imageCount, swapchainImages.data());
 
+    //per image resources outlive the swapchain, so do the fences of the frames still using them
+    m_imagesInFlight.resize(m_present.imageCount, VK_NULL_HANDLE);
+
     ImageCreateInfo imageCreateInfo = {};
     imageCreateInfo.width = m_present.extent2D.width;
     imageCreateInfo.height = m_present.extent2D.height;
@@ -702,6 +852,8 @@ void VulkanContext::create_command_pool() {
         throw std::runtime_error("failed to create graphics command pool!");
     }
 
+    VulkanFrameCommandPool::init(m_device, queueFamilyIndices.graphicsFamily.value(), MAX_FRAMES_IN_FLIGHT);
+
     poolInfo.queueFamilyIndex = queueFamilyIndices.computeFamily.value();
 
     VK_CALL_ASSERT(vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_computeCommandPool)){
@@ -743,23 +895,68 @@ void VulkanContext::create_sync_objects() {
 void VulkanContext::recreate_swapchain() {
     EG_TRACE("eagle","Recreating swapchain!");
 
-    VK_CALL
-    vkDeviceWaitIdle(m_device);
-
     //Waits until window is visible
     while (m_window->is_minimized()) {
         m_window->wait_native_events();
     }
 
-    cleanup_swapchain();
+    uint32_t previousImageCount = m_present.imageCount;
 
-    create_swapchain();
+    //frames in flight may still render to and present the old images, they are released through the deletion
+    //queue instead of waiting for the device to idle. Views and framebuffers go before the swapchain owning the images
+    VkSwapchainKHR oldSwapchain = m_present.swapchain;
+    m_present.framebuffer.reset();
+
+    create_swapchain(oldSwapchain);
+    VulkanDeletionQueue::push([device = m_device, oldSwapchain]{
+        VK_CALL vkDestroySwapchainKHR(device, oldSwapchain, nullptr);
+    });
     create_framebuffers();
-    recreate_objects();
+
+    //per image resources only have to be rebuilt when the swapchain image count changes, which is rare enough
+    //to still rebuild them on an idle device
+    if (m_present.imageCount != previousImageCount){
+        VK_CALL vkDeviceWaitIdle(m_device);
+        clear_objects();
+        recreate_objects();
+    }
+    else {
+        recreate_size_dependent_objects();
+    }
 
     EG_TRACE("eagle","Swapchain recreated!");
 }
 
+bool VulkanContext::swapchain_resize_due(bool suboptimal) {
+    auto now = std::chrono::steady_clock::now();
+    uint32_t width = m_window->width();
+    uint32_t height = m_window->height();
+
+    bool resized = width != m_windowWidth || height != m_windowHeight;
+    if (resized || (suboptimal && !m_resizeRequested)){
+        if (!m_resizeRequested){
+            m_resizeRequested = true;
+            m_firstResizeTime = now;
+        }
+        m_lastResizeTime = now;
+        m_windowWidth = width;
+        m_windowHeight = height;
+    }
+
+    return m_resizeRequested && (now - m_lastResizeTime >= RESIZE_DEBOUNCE || now - m_firstResizeTime >= RESIZE_MAX_DELAY);
+}
+
+void VulkanContext::recreate_size_dependent_objects() {
+    for (auto &shader : m_shaders) {
+        if (!shader->create_info().dynamicStates){
+            shader->cleanup_pipeline();
+            shader->create_pipeline();
+        }
+    }
+
+    context_recreated(this);
+}
+
 void VulkanContext::recreate_objects() {
     for (auto &shader : m_shaders) {
         shader->create_pipeline();
@@ -785,6 +982,10 @@ void VulkanContext::recreate_objects() {
         commandBuffer->recreate(m_present.imageCount);
     }
 
+    if (m_parallelRecorder){
+        m_parallelRecorder->recreate(m_present.imageCount);
+    }
+
     context_recreated(this);
 }
 
@@ -795,6 +996,10 @@ void VulkanContext::clear_objects() {
         commandBuffer->cleanup();
     }
 
+    if (m_parallelRecorder){
+        m_parallelRecorder->cleanup();
+    }
+
     for (auto& computeShader : m_computeShaders){
         computeShader->clear_descriptor_set();
     }
@@ -824,6 +1029,9 @@ void VulkanContext::cleanup_swapchain() {
 
     m_present.framebuffer.reset();
 
+    //the device is idle, the image views are destroyed before the swapchain owning their images
+    VulkanDeletionQueue::flush();
+
     VK_CALL vkDestroySwapchainKHR(m_device, m_present.swapchain, nullptr);
     EG_TRACE("eagle","Swapchain cleared!");
 }
@@ -834,23 +1042,71 @@ VulkanContext::create_shader(const ShaderCreateInfo &createInfo) {
 
     VulkanShaderCreateInfo nativeCreateInfo = {};
     nativeCreateInfo.device = m_device;
+    nativeCreateInfo.pipelineCache = m_pipelineCache->native_cache();
+    nativeCreateInfo.pExtent = &m_present.extent2D;
+    m_shaders.emplace_back(std::make_shared<VulkanShader>(createInfo, nativeCreateInfo));
+    return m_shaders.back();
+}
+
+std::weak_ptr<Shader>
+VulkanContext::create_shader_async(const ShaderCreateInfo &createInfo) {
+    EG_TRACE("eagle","Creating a vulkan shader asynchronously!");
+
+    VulkanShaderCreateInfo nativeCreateInfo = {};
+    nativeCreateInfo.device = m_device;
+    nativeCreateInfo.pipelineCache = m_pipelineCache->native_cache();
     nativeCreateInfo.pExtent = &m_present.extent2D;
+    nativeCreateInfo.workerPool = &worker_pool();
     m_shaders.emplace_back(std::make_shared<VulkanShader>(createInfo, nativeCreateInfo));
     return m_shaders.back();
 }
 
+const std::vector<std::shared_ptr<CommandBuffer>>&
+VulkanContext::record_secondary_parallel(const std::shared_ptr<RenderPass> &renderPass, const std::shared_ptr<Framebuffer> &framebuffer,
+                                         uint32_t taskCount, const std::function<void(CommandBuffer&, uint32_t)> &recordTask) {
+    if (!m_parallelRecorder){
+        VulkanParallelRecorderCreateInfo createInfo = {};
+        createInfo.device = m_device;
+        createInfo.queueFamilyIndex = find_family_indices(m_physicalDevice).graphicsFamily.value();
+        createInfo.imageCount = m_present.imageCount;
+        createInfo.currentImageIndex = &m_present.imageIndex;
+        createInfo.workerPool = &worker_pool();
+        m_parallelRecorder = std::make_unique<VulkanParallelRecorder>(createInfo);
+    }
+    return m_parallelRecorder->record(renderPass, framebuffer, taskCount, recordTask);
+}
+
+WorkerPool& VulkanContext::worker_pool() {
+    if (!m_workerPool){
+        m_workerPool = std::make_unique<WorkerPool>();
+    }
+    return *m_workerPool;
+}
+
 std::weak_ptr<ComputeShader>
 VulkanContext::create_compute_shader(const std::string &path) {
     VulkanComputeShaderCreateInfo createInfo = {};
     createInfo.device = m_device;
+    createInfo.pipelineCache = m_pipelineCache->native_cache();
     createInfo.commandPool = m_computeCommandPool;
     createInfo.imageIndex = &m_present.imageIndex;
     createInfo.bufferCount = m_present.imageCount;
     createInfo.computeQueue = m_computeQueue;
+    createInfo.frameCount = MAX_FRAMES_IN_FLIGHT;
     m_computeShaders.emplace_back(std::make_shared<VulkanComputeShader>(path, createInfo));
     return m_computeShaders.back();
 }
 
+const std::vector<GpuZoneTiming>& VulkanContext::gpu_zone_timings() const {
+    return VulkanGpuProfiler::timings();
+}
+
+bool VulkanContext::supports_sampled_format(Format format) const {
+    VkFormatProperties properties = {};
+    VK_CALL vkGetPhysicalDeviceFormatProperties(m_physicalDevice, VulkanConverter::to_vk(format), &properties);
+    return (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+}
+
 std::weak_ptr<VertexBuffer>
 VulkanContext::create_vertex_buffer(const VertexBufferCreateInfo& createInfo) {
     EG_TRACE("eagle","Creating a vulkan vertex buffer!");
@@ -901,6 +1157,17 @@ VulkanContext::create_storage_buffer(size_t size, void *data, UpdateType usage)
     return m_storageBuffers.back();
 }
 
+std::weak_ptr<DynamicUniformBuffer>
+VulkanContext::create_dynamic_uniform_buffer(size_t blockSize) {
+    EG_TRACE("eagle","Creating a vulkan dynamic uniform buffer!");
+    m_dynamicUniformBuffers.emplace_back(std::make_shared<VulkanDynamicUniformBuffer>(blockSize));
+    return m_dynamicUniformBuffers.back();
+}
+
+
+FrameAllocation VulkanContext::allocate_frame_vertices(size_t size) {
+    return VulkanFrameRing::allocate(size);
+}
 
 std::weak_ptr<DescriptorSetLayout>
 VulkanContext::create_descriptor_set_layout(const std::vector<DescriptorBindingDescription> &bindings) {
@@ -937,10 +1204,50 @@ VulkanContext::create_texture(const TextureCreateInfo &createInfo) {
     vulkanTextureCreateInfo.graphicsQueue = m_graphicsQueue;
     vulkanTextureCreateInfo.imageCount = m_present.imageCount;
 
+    if (createInfo.generateMipmaps && createInfo.imageCreateInfo.mipLevels == 1){
+        TextureCreateInfo mippedCreateInfo = createInfo;
+        MipChainBuilder::build(mippedCreateInfo.imageCreateInfo, &worker_pool());
+        m_textures.emplace_back(std::make_shared<VulkanTexture>(mippedCreateInfo, vulkanTextureCreateInfo));
+        return m_textures.back();
+    }
+
     m_textures.emplace_back(std::make_shared<VulkanTexture>(createInfo, vulkanTextureCreateInfo));
     return m_textures.back();
 }
 
+std::weak_ptr<Texture>
+VulkanContext::create_streaming_texture(const StreamingTextureCreateInfo &createInfo) {
+    EG_TRACE("eagle","Creating a streamed vulkan texture!");
+    VulkanTextureCreateInfo vulkanTextureCreateInfo = {};
+    vulkanTextureCreateInfo.device = m_device;
+    vulkanTextureCreateInfo.physicalDevice = m_physicalDevice;
+    vulkanTextureCreateInfo.commandPool = m_graphicsCommandPool;
+    vulkanTextureCreateInfo.graphicsQueue = m_graphicsQueue;
+    vulkanTextureCreateInfo.imageCount = m_present.imageCount;
+
+    if (!VulkanTextureStreamer::initialized()){
+        VulkanTextureStreamerCreateInfo streamerCreateInfo = {};
+        streamerCreateInfo.workerPool = &worker_pool();
+        streamerCreateInfo.imageCreateInfo.device = m_device;
+        streamerCreateInfo.imageCreateInfo.physicalDevice = m_physicalDevice;
+        streamerCreateInfo.imageCreateInfo.commandPool = m_graphicsCommandPool;
+        streamerCreateInfo.imageCreateInfo.graphicsQueue = m_graphicsQueue;
+        streamerCreateInfo.imageCreateInfo.imageCount = m_present.imageCount;
+        VulkanTextureStreamer::init(streamerCreateInfo);
+    }
+
+    m_textures.emplace_back(std::make_shared<VulkanTexture>(createInfo, vulkanTextureCreateInfo));
+    return m_textures.back();
+}
+
+void VulkanContext::set_texture_streaming_budget(size_t residentBytes, size_t uploadBytesPerFrame) {
+    VulkanTextureStreamer::set_budget(residentBytes, uploadBytesPerFrame);
+}
+
+TextureStreamingStats VulkanContext::texture_streaming_stats() const {
+    return VulkanTextureStreamer::stats();
+}
+
 std::weak_ptr<Image>
 VulkanContext::create_image(const ImageCreateInfo &createInfo) {
     EG_TRACE("eagle","Creating a vulkan image!");
@@ -955,6 +1262,73 @@ VulkanContext::create_image(const ImageCreateInfo &createInfo) {
     return m_images.back();
 }
 
+std::vector<std::weak_ptr<Image>>
+VulkanContext::create_aliased_images(const std::vector<ImageCreateInfo> &createInfos,
+                                     const std::function<std::vector<uint64_t>(const std::vector<ImageMemoryRequirements>&)> &place) {
+    EG_TRACE("eagle","Creating aliased vulkan images!");
+    VulkanImageCreateInfo vulkanImageCreateInfo = {};
+    vulkanImageCreateInfo.device = m_device;
+    vulkanImageCreateInfo.physicalDevice = m_physicalDevice;
+    vulkanImageCreateInfo.commandPool = m_graphicsCommandPool;
+    vulkanImageCreateInfo.graphicsQueue = m_graphicsQueue;
+    vulkanImageCreateInfo.imageCount = m_present.imageCount;
+
+    //the shared allocation has to suit every image in it
+    VkMemoryRequirements memoryRequirements = {};
+    memoryRequirements.alignment = 1;
+    memoryRequirements.memoryTypeBits = UINT32_MAX;
+    VkMemoryPropertyFlags memoryProperties = 0;
+
+    std::vector<std::shared_ptr<VulkanImage>> images;
+    std::vector<ImageMemoryRequirements> requirements;
+    images.reserve(createInfos.size());
+    requirements.reserve(createInfos.size());
+    for (auto& createInfo : createInfos){
+        if (createInfo.tiling != ImageTiling::OPTIMAL){
+            throw std::runtime_error("aliased images must use optimal tiling!");
+        }
+        auto image = std::make_shared<VulkanImage>(createInfo, vulkanImageCreateInfo, true);
+        VkMemoryRequirements imageRequirements = image->memory_requirements();
+        requirements.push_back({imageRequirements.size, imageRequirements.alignment});
+        memoryRequirements.alignment = std::max(memoryRequirements.alignment, imageRequirements.alignment);
+        memoryRequirements.memoryTypeBits &= imageRequirements.memoryTypeBits;
+        memoryProperties |= VulkanConverter::to_vk_flags<VkMemoryPropertyFlags>(createInfo.memoryProperties);
+        images.emplace_back(std::move(image));
+    }
+
+    if (images.empty()){
+        return {};
+    }
+
+    if (memoryRequirements.memoryTypeBits == 0){
+        throw std::runtime_error("aliased images have no memory type in common!");
+    }
+
+    std::vector<uint64_t> offsets = place(requirements);
+    if (offsets.size() != images.size()){
+        throw std::runtime_error("aliased image placement does not match the images!");
+    }
+    for (size_t i = 0; i < images.size(); i++){
+        memoryRequirements.size = std::max<VkDeviceSize>(memoryRequirements.size, offsets[i] + requirements[i].size);
+    }
+
+    auto memory = std::make_shared<VulkanAliasedMemory>();
+    memory->allocations.reserve(m_present.imageCount);
+    for (uint32_t i = 0; i < m_present.imageCount; i++){
+        memory->allocations.emplace_back(VulkanMemoryAllocator::allocate(memoryRequirements, memoryProperties, VulkanResourceKind::OPTIMAL));
+    }
+
+    std::vector<std::weak_ptr<Image>> result;
+    result.reserve(images.size());
+    for (size_t i = 0; i < images.size(); i++){
+        images[i]->bind_aliased_memory(memory, offsets[i]);
+        m_images.emplace_back(images[i]);
+        result.emplace_back(images[i]);
+    }
+    EG_TRACE("eagle","{0} aliased vulkan images created in {1} bytes!", images.size(), memoryRequirements.size);
+    return result;
+}
+
 
 std::weak_ptr<RenderPass> VulkanContext::create_render_pass(const std::vector<RenderAttachmentDescription> &colorAttachments,
                                                      const RenderAttachmentDescription &depthAttachment) {
@@ -989,20 +1363,47 @@ std::weak_ptr<CommandBuffer> VulkanContext::create_command_buffer(const CommandB
 bool VulkanContext::prepare_frame() {
     VK_CALL vkWaitForFences(m_device, 1, &m_inFlightFences[m_currentFrame], VK_TRUE, std::numeric_limits<uint64_t>::max());
 
+    //transient descriptor sets and command buffers of this frame slot are no longer in use
+    VulkanDescriptorAllocator::reset_frame(m_currentFrame);
+    VulkanFrameCommandPool::begin_frame(m_currentFrame);
+    VulkanGpuProfiler::begin_frame(m_currentFrame);
+    VulkanFrameRing::begin_frame(m_currentFrame);
+    VulkanComputeSync::begin_frame(m_currentFrame);
+    VulkanDeletionQueue::begin_frame(m_currentFrame);
+
     VkResult result;
     VK_CALL
     result = vkAcquireNextImageKHR(m_device, m_present.swapchain, std::numeric_limits<uint64_t>::max(),
                                    m_imageAvailableSemaphores[m_currentFrame], VK_NULL_HANDLE, &m_present.imageIndex);
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+        //nothing can be acquired from it, the old swapchain is retired without idling so the frame still renders
         recreate_swapchain();
+        VK_CALL
+        result = vkAcquireNextImageKHR(m_device, m_present.swapchain, std::numeric_limits<uint64_t>::max(),
+                                       m_imageAvailableSemaphores[m_currentFrame], VK_NULL_HANDLE, &m_present.imageIndex);
+    }
+
+    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
         return false;
     } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
         throw std::runtime_error("failed to acquire swapchain image!");
     }
 
+    //images can be acquired out of order, per image resources are only reusable once the frame that last used them finished
+    if (m_imagesInFlight[m_present.imageIndex] != VK_NULL_HANDLE && m_imagesInFlight[m_present.imageIndex] != m_inFlightFences[m_currentFrame]){
+        VK_CALL vkWaitForFences(m_device, 1, &m_imagesInFlight[m_present.imageIndex], VK_TRUE, std::numeric_limits<uint64_t>::max());
+    }
+    m_imagesInFlight[m_present.imageIndex] = m_inFlightFences[m_currentFrame];
+
     //updates dirty buffers-------------------------
     VulkanCleaner::flush(m_present.imageIndex);
+
+    //acquires finished async uploads into this frame's upload batch
+    VulkanUploader::poll();
+
+    //swaps in streamed levels whose uploads just completed and starts this frame's
+    VulkanTextureStreamer::update();
     return true;
 }
 
@@ -1014,18 +1415,28 @@ void VulkanContext::present_frame(const std::shared_ptr<CommandBuffer> &commandB
         VkSubmitInfo submitInfo = {};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-        VkSemaphore waitSemaphores[] = {m_imageAvailableSemaphores[m_currentFrame]};
-        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-        submitInfo.waitSemaphoreCount = 1;
-        submitInfo.pWaitSemaphores = waitSemaphores;
-        submitInfo.pWaitDstStageMask = waitStages;
+        m_submitWaitSemaphores.assign(1, m_imageAvailableSemaphores[m_currentFrame]);
+        m_submitWaitStages.assign(1, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+        m_submitSignalSemaphores.assign(1, m_renderFinishedSemaphores[m_currentFrame]);
+
+        //async compute dispatched this frame runs on its own queue, only the stages reading its results wait on it
+        VulkanComputeSync::prepare_graphics_submit(m_submitWaitSemaphores, m_submitWaitStages, m_submitSignalSemaphores);
 
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &vcb->native_command_buffers()[m_present.imageIndex];
+        submitInfo.waitSemaphoreCount = static_cast<uint32_t>(m_submitWaitSemaphores.size());
+        submitInfo.pWaitSemaphores = m_submitWaitSemaphores.data();
+        submitInfo.pWaitDstStageMask = m_submitWaitStages.data();
 
-        VkSemaphore signalSemaphores[] = {m_renderFinishedSemaphores[m_currentFrame]};
-        submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores = signalSemaphores;
+        //the queries of the frame's gpu zones are reset ahead of the frame's commands
+        VkCommandBuffer commandBuffers[] = {VulkanGpuProfiler::reset_command_buffer(), vcb->native_command_buffers()[m_present.imageIndex]};
+        bool resetQueries = commandBuffers[0] != VK_NULL_HANDLE;
+        submitInfo.commandBufferCount = resetQueries ? 2 : 1;
+        submitInfo.pCommandBuffers = resetQueries ? commandBuffers : commandBuffers + 1;
+
+        submitInfo.signalSemaphoreCount = static_cast<uint32_t>(m_submitSignalSemaphores.size());
+        submitInfo.pSignalSemaphores = m_submitSignalSemaphores.data();
+
+        //every upload recorded during the frame goes in a single submission ahead of the frame's commands
+        VulkanUploader::submit();
 
         VK_CALL
         vkResetFences(m_device, 1, &m_inFlightFences[m_currentFrame]);
@@ -1035,6 +1446,9 @@ void VulkanContext::present_frame(const std::shared_ptr<CommandBuffer> &commandB
         if (result != VK_SUCCESS) {
             throw std::runtime_error("failed to submit command buffer!");
         }
+
+        //resources released up to here are destroyed once this frame's fence signals
+        VulkanDeletionQueue::submit_frame(m_currentFrame);
     }
 
     //present
@@ -1054,11 +1468,13 @@ void VulkanContext::present_frame(const std::shared_ptr<CommandBuffer> &commandB
         VK_CALL
         VkResult result = vkQueuePresentKHR(m_presentQueue, &presentInfo);
 
-        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_windowResized) {
-            m_windowResized = false;
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            //nothing can be presented to it anymore
             recreate_swapchain();
-        } else if (result != VK_SUCCESS) {
+        } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
             throw std::runtime_error("failed to present swapchain image!");
+        } else if (swapchain_resize_due(result == VK_SUBOPTIMAL_KHR)) {
+            recreate_swapchain();
         }
 
         m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
@@ -1066,7 +1482,23 @@ void VulkanContext::present_frame(const std::shared_ptr<CommandBuffer> &commandB
 }
 
 void VulkanContext::destroy_texture_2d(const std::shared_ptr<Texture> &texture) {
-    m_textures.erase(std::find(m_textures.begin(), m_textures.end(), std::static_pointer_cast<VulkanTexture>(texture)));
+    auto it = std::find(m_textures.begin(), m_textures.end(), std::static_pointer_cast<VulkanTexture>(texture));
+    if (it == m_textures.end()){
+        return;
+    }
+    //frames in flight may still sample the texture
+    VulkanDeletionQueue::push(std::move(*it));
+    m_textures.erase(it);
+}
+
+void VulkanContext::destroy_image(const std::shared_ptr<Image> &image) {
+    auto it = std::find(m_images.begin(), m_images.end(), std::static_pointer_cast<VulkanImage>(image));
+    if (it == m_images.end()){
+        return;
+    }
+    //frames in flight may still use the image
+    VulkanDeletionQueue::push(std::move(*it));
+    m_images.erase(it);
 }
 
 std::shared_ptr<RenderPass> VulkanContext::main_render_pass() {
@@ -1083,6 +1515,10 @@ std::vector<const char*> VulkanContext::get_extensions() {
     if (enableValidationLayers) {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
     }
+    m_physicalDeviceProperties2Enabled = is_instance_extension_available(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+    if (m_physicalDeviceProperties2Enabled){
+        extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+    }
     return extensions;
 }
 
@@ -7,6 +7,7 @@
 
 #include <optional>
 #include <functional>
+#include <chrono>
 
 #include "eagle/renderer/rendering_context.h"
 #include "eagle/events/window_events.h"
@@ -22,8 +23,13 @@
 #include "vulkan_command_buffer.h"
 #include "vulkan_compute_shader.h"
 #include "vulkan_storage_buffer.h"
+#include "vulkan_dynamic_uniform_buffer.h"
+#include "vulkan_compute_sync.h"
 #include "vulkan_render_pass.h"
 #include "vulkan_framebuffer.h"
+#include "vulkan_pipeline_cache.h"
+#include "vulkan_parallel_recorder.h"
+#include "eagle/worker_pool.h"
 
 namespace eagle {
 
@@ -45,6 +51,7 @@ protected:
         std::optional<uint32_t> graphicsFamily;
         std::optional<uint32_t> presentFamily;
         std::optional<uint32_t> computeFamily;
+        std::optional<uint32_t> transferFamily;
 
         bool isComplete() {
             return graphicsFamily.has_value() && computeFamily.has_value();
@@ -73,6 +80,9 @@ public:
     std::shared_ptr<Framebuffer> main_frambuffer() override;
     //------
 
+    //must be called before init, defaults to the working directory
+    inline void set_pipeline_cache_path(const std::string& path) { m_pipelineCachePath = path; }
+
     static VKAPI_ATTR VkBool32 VKAPI_CALL debug_callback(
             VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
             VkDebugUtilsMessageTypeFlagsEXT messageType,
@@ -95,7 +105,10 @@ protected:
 
     virtual void create_surface() = 0;//implemented per platform
 
-    virtual void create_swapchain();
+    virtual void create_pipeline_cache();
+
+    //the old swapchain is handed to the new one, so the presentation engine can reuse its resources
+    virtual void create_swapchain(VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
 
     virtual void create_command_pool();
 
@@ -107,10 +120,16 @@ protected:
 
     virtual void recreate_swapchain();
 
+    //true once the window stopped resizing for a moment, suboptimal presents count as a resize.
+    //out of date swapchains can't be used at all and are recreated right away instead
+    bool swapchain_resize_due(bool suboptimal);
+
     virtual void cleanup_swapchain();
 
     virtual void recreate_objects();
 
+    virtual void recreate_size_dependent_objects();
+
     virtual void clear_objects();
 
     bool validation_layers_supported();
@@ -126,7 +145,11 @@ protected:
 
     QueueFamilyIndices find_family_indices(VkPhysicalDevice device);
 
+    WorkerPool& worker_pool();
+
     bool check_device_extension_support(VkPhysicalDevice device);
+    bool is_device_extension_available(VkPhysicalDevice device, const char* extensionName);
+    bool is_instance_extension_available(const char* extensionName);
 
     SwapChainSupportDetails query_swapchain_support(VkPhysicalDevice device);
 
@@ -141,6 +164,13 @@ public:
     std::weak_ptr<Shader>
     create_shader(const ShaderCreateInfo &pipelineInfo) override;
 
+    std::weak_ptr<Shader>
+    create_shader_async(const ShaderCreateInfo &pipelineInfo) override;
+
+    const std::vector<std::shared_ptr<CommandBuffer>>&
+    record_secondary_parallel(const std::shared_ptr<RenderPass>& renderPass, const std::shared_ptr<Framebuffer>& framebuffer,
+                              uint32_t taskCount, const std::function<void(CommandBuffer&, uint32_t)>& recordTask) override;
+
     std::weak_ptr<VertexBuffer>
     create_vertex_buffer(const VertexBufferCreateInfo& usage) override;
 
@@ -160,6 +190,13 @@ public:
     std::weak_ptr<Texture>
     create_texture(const TextureCreateInfo &createInfo) override;
 
+    std::weak_ptr<Texture>
+    create_streaming_texture(const StreamingTextureCreateInfo &createInfo) override;
+
+    void set_texture_streaming_budget(size_t residentBytes, size_t uploadBytesPerFrame) override;
+
+    TextureStreamingStats texture_streaming_stats() const override;
+
     std::weak_ptr<RenderPass>
     create_render_pass(const std::vector<RenderAttachmentDescription>& colorAttachments, const RenderAttachmentDescription& depthAttachment) override;
 
@@ -169,9 +206,18 @@ public:
     std::weak_ptr<Image>
     create_image(const ImageCreateInfo& createInfo) override;
 
+    std::vector<std::weak_ptr<Image>>
+    create_aliased_images(const std::vector<ImageCreateInfo>& createInfos,
+                          const std::function<std::vector<uint64_t>(const std::vector<ImageMemoryRequirements>&)>& place) override;
+
     std::weak_ptr<StorageBuffer>
     create_storage_buffer(size_t size, void *data, UpdateType usage) override;
 
+    std::weak_ptr<DynamicUniformBuffer>
+    create_dynamic_uniform_buffer(size_t blockSize) override;
+
+    FrameAllocation allocate_frame_vertices(size_t size) override;
+
     std::weak_ptr<ComputeShader>
     create_compute_shader(const std::string& path) override;
 
@@ -180,11 +226,19 @@ public:
 
     void destroy_texture_2d(const std::shared_ptr<Texture> &texture) override;
 
+    void destroy_image(const std::shared_ptr<Image> &image) override;
+
+    const std::vector<GpuZoneTiming>& gpu_zone_timings() const override;
+
+    bool supports_sampled_format(Format format) const override;
+
 protected:
 
     Window* m_window;
 
     VkInstance m_instance;
+    //the 1.0 instance needs it for any device extension that chains feature structs, e.g. timeline semaphores
+    bool m_physicalDeviceProperties2Enabled = false;
     VkSurfaceKHR m_surface;
     VkPhysicalDevice m_physicalDevice;
     VkDevice m_device;
@@ -206,16 +260,31 @@ protected:
     std::vector<VkSemaphore> m_imageAvailableSemaphores;
     std::vector<VkSemaphore> m_renderFinishedSemaphores;
     std::vector<VkFence> m_inFlightFences;
+    std::vector<VkFence> m_imagesInFlight;  //fence of the frame that last rendered each swapchain image
+    //scratch storage for the frame's graphics submission
+    std::vector<VkSemaphore> m_submitWaitSemaphores, m_submitSignalSemaphores;
+    std::vector<VkPipelineStageFlags> m_submitWaitStages;
     VkQueue m_presentQueue;
 
 
     //compute
     VkQueue m_computeQueue;
 
+    std::shared_ptr<VulkanPipelineCache> m_pipelineCache;
+    std::string m_pipelineCachePath = "pipeline_cache.bin";
+
+    //async shader builds and parallel recording, created on first use
+    std::unique_ptr<WorkerPool> m_workerPool;
+    std::unique_ptr<VulkanParallelRecorder> m_parallelRecorder;
+
+    //async uploads, null when the device has no dedicated transfer family
+    VkQueue m_transferQueue = VK_NULL_HANDLE;
+
     std::vector<std::shared_ptr<VulkanVertexBuffer>> m_vertexBuffers;
     std::vector<std::shared_ptr<VulkanIndexBuffer>> m_indexBuffers;
     std::vector<std::shared_ptr<VulkanUniformBuffer>> m_uniformBuffers;
     std::vector<std::shared_ptr<VulkanStorageBuffer>> m_storageBuffers;
+    std::vector<std::shared_ptr<VulkanDynamicUniformBuffer>> m_dynamicUniformBuffers;
     std::vector<std::shared_ptr<VulkanDescriptorSet>> m_descriptorSets;
     std::vector<std::shared_ptr<VulkanDescriptorSetLayout>> m_descriptorSetsLayouts;
     std::vector<std::shared_ptr<VulkanShader>> m_shaders;
@@ -238,7 +307,14 @@ protected:
 
     const int MAX_FRAMES_IN_FLIGHT = 2;
 
-    bool m_windowResized = false;
+    //dragging a window edge resizes it every frame, the swapchain follows once the size settles
+    //or, during a long drag, at most every RESIZE_MAX_DELAY
+    static constexpr std::chrono::milliseconds RESIZE_DEBOUNCE{100};
+    static constexpr std::chrono::milliseconds RESIZE_MAX_DELAY{500};
+
+    bool m_resizeRequested = false;
+    uint32_t m_windowWidth = 0, m_windowHeight = 0;     //window size when the swapchain was last checked
+    std::chrono::steady_clock::time_point m_firstResizeTime, m_lastResizeTime;
 
 };
 
@@ -512,6 +512,7 @@ VkDescriptorType VulkanConverter::to_vk(DescriptorType type) {
         case DescriptorType::STORAGE_IMAGE: result = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; break;
         case DescriptorType::STORAGE_BUFFER: result = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER; break;
         case DescriptorType::COMBINED_IMAGE_SAMPLER: result = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER; break;
+        case DescriptorType::UNIFORM_BUFFER_DYNAMIC: result = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC; break;
     }
     return result;
 }
@@ -524,6 +525,7 @@ DescriptorType VulkanConverter::to_eg(VkDescriptorType type) {
         case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER: result = DescriptorType::UNIFORM_BUFFER; break;
         case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE: result = DescriptorType::STORAGE_IMAGE; break;
         case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER: result = DescriptorType::STORAGE_BUFFER; break;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC: result = DescriptorType::UNIFORM_BUFFER_DYNAMIC; break;
         default: throw std::runtime_error("Invalid VkDescriptorType (not yet supported!)");
     }
     return result;
@@ -889,6 +891,56 @@ VkPipelineStageFlagBits VulkanConverter::to_vk(PipelineStage stage) {
     return result;
 }
 
+Access VulkanConverter::to_eg(VkAccessFlagBits access) {
+    Access result;
+    switch(access){
+        case VK_ACCESS_INDIRECT_COMMAND_READ_BIT: result = Access::INDIRECT_COMMAND_READ_BIT; break;
+        case VK_ACCESS_INDEX_READ_BIT: result = Access::INDEX_READ_BIT; break;
+        case VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT: result = Access::VERTEX_ATTRIBUTE_READ_BIT; break;
+        case VK_ACCESS_UNIFORM_READ_BIT: result = Access::UNIFORM_READ_BIT; break;
+        case VK_ACCESS_INPUT_ATTACHMENT_READ_BIT: result = Access::INPUT_ATTACHMENT_READ_BIT; break;
+        case VK_ACCESS_SHADER_READ_BIT: result = Access::SHADER_READ_BIT; break;
+        case VK_ACCESS_SHADER_WRITE_BIT: result = Access::SHADER_WRITE_BIT; break;
+        case VK_ACCESS_COLOR_ATTACHMENT_READ_BIT: result = Access::COLOR_ATTACHMENT_READ_BIT; break;
+        case VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT: result = Access::COLOR_ATTACHMENT_WRITE_BIT; break;
+        case VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT: result = Access::DEPTH_STENCIL_ATTACHMENT_READ_BIT; break;
+        case VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT: result = Access::DEPTH_STENCIL_ATTACHMENT_WRITE_BIT; break;
+        case VK_ACCESS_TRANSFER_READ_BIT: result = Access::TRANSFER_READ_BIT; break;
+        case VK_ACCESS_TRANSFER_WRITE_BIT: result = Access::TRANSFER_WRITE_BIT; break;
+        case VK_ACCESS_HOST_READ_BIT: result = Access::HOST_READ_BIT; break;
+        case VK_ACCESS_HOST_WRITE_BIT: result = Access::HOST_WRITE_BIT; break;
+        case VK_ACCESS_MEMORY_READ_BIT: result = Access::MEMORY_READ_BIT; break;
+        case VK_ACCESS_MEMORY_WRITE_BIT: result = Access::MEMORY_WRITE_BIT; break;
+        default: throw std::runtime_error("Invalid VkAccessFlagBits on conversion");
+    }
+    return result;
+}
+
+VkAccessFlagBits VulkanConverter::to_vk(Access access) {
+    VkAccessFlagBits result;
+    switch(access){
+        case Access::INDIRECT_COMMAND_READ_BIT: result = VK_ACCESS_INDIRECT_COMMAND_READ_BIT; break;
+        case Access::INDEX_READ_BIT: result = VK_ACCESS_INDEX_READ_BIT; break;
+        case Access::VERTEX_ATTRIBUTE_READ_BIT: result = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT; break;
+        case Access::UNIFORM_READ_BIT: result = VK_ACCESS_UNIFORM_READ_BIT; break;
+        case Access::INPUT_ATTACHMENT_READ_BIT: result = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT; break;
+        case Access::SHADER_READ_BIT: result = VK_ACCESS_SHADER_READ_BIT; break;
+        case Access::SHADER_WRITE_BIT: result = VK_ACCESS_SHADER_WRITE_BIT; break;
+        case Access::COLOR_ATTACHMENT_READ_BIT: result = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT; break;
+        case Access::COLOR_ATTACHMENT_WRITE_BIT: result = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT; break;
+        case Access::DEPTH_STENCIL_ATTACHMENT_READ_BIT: result = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT; break;
+        case Access::DEPTH_STENCIL_ATTACHMENT_WRITE_BIT: result = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT; break;
+        case Access::TRANSFER_READ_BIT: result = VK_ACCESS_TRANSFER_READ_BIT; break;
+        case Access::TRANSFER_WRITE_BIT: result = VK_ACCESS_TRANSFER_WRITE_BIT; break;
+        case Access::HOST_READ_BIT: result = VK_ACCESS_HOST_READ_BIT; break;
+        case Access::HOST_WRITE_BIT: result = VK_ACCESS_HOST_WRITE_BIT; break;
+        case Access::MEMORY_READ_BIT: result = VK_ACCESS_MEMORY_READ_BIT; break;
+        case Access::MEMORY_WRITE_BIT: result = VK_ACCESS_MEMORY_WRITE_BIT; break;
+        default: throw std::runtime_error("Invalid Access on conversion");
+    }
+    return result;
+}
+
 VkCommandBufferLevel VulkanConverter::to_vk(CommandBufferLevel level) {
     VkCommandBufferLevel result;
     switch(level){
@@ -41,6 +41,8 @@ public:
     static VkMemoryPropertyFlagBits to_vk(MemoryProperty property);
     static PipelineStage to_eg(VkPipelineStageFlagBits stage);
     static VkPipelineStageFlagBits to_vk(PipelineStage stage);
+    static Access to_eg(VkAccessFlagBits access);
+    static VkAccessFlagBits to_vk(Access access);
     static VkCommandBufferLevel to_vk(CommandBufferLevel level);
     static CommandBufferLevel to_eg(VkCommandBufferLevel level);
     static VkVertexInputRate to_vk(VertexInputRate rate);
@@ -0,0 +1,78 @@
+#include <eagle/renderer/vulkan/vulkan_deletion_queue.h>
+#include <eagle/log.h>
+
+namespace eagle {
+
+std::mutex VulkanDeletionQueue::s_mutex;
+std::vector<std::function<void()>> VulkanDeletionQueue::s_pending;
+std::vector<std::vector<std::function<void()>>> VulkanDeletionQueue::s_frames;
+
+void VulkanDeletionQueue::init(uint32_t frameCount) {
+    EG_TRACE("eagle","Initializing vulkan deletion queue!");
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_pending.clear();
+    s_frames.assign(frameCount, {});
+}
+
+void VulkanDeletionQueue::destroy() {
+    EG_TRACE("eagle","Destroying vulkan deletion queue!");
+    flush();
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_frames.clear();
+}
+
+void VulkanDeletionQueue::flush() {
+    //deletions may push more of them, e.g. when they drop the last reference to an image
+    while (true){
+        std::vector<std::function<void()>> deletions;
+        {
+            std::lock_guard<std::mutex> lock(s_mutex);
+            for (auto& frame : s_frames){
+                deletions.insert(deletions.end(), std::make_move_iterator(frame.begin()), std::make_move_iterator(frame.end()));
+                frame.clear();
+            }
+            deletions.insert(deletions.end(), std::make_move_iterator(s_pending.begin()), std::make_move_iterator(s_pending.end()));
+            s_pending.clear();
+        }
+        if (deletions.empty()){
+            return;
+        }
+        run(deletions);
+    }
+}
+
+void VulkanDeletionQueue::begin_frame(uint32_t frameIndex) {
+    std::vector<std::function<void()>> deletions;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        deletions.swap(s_frames[frameIndex]);
+    }
+    run(deletions);
+}
+
+void VulkanDeletionQueue::submit_frame(uint32_t frameIndex) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto& frame = s_frames[frameIndex];
+    frame.insert(frame.end(), std::make_move_iterator(s_pending.begin()), std::make_move_iterator(s_pending.end()));
+    s_pending.clear();
+}
+
+void VulkanDeletionQueue::push(std::function<void()> &&deletion) {
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (initialized()){
+            s_pending.emplace_back(std::move(deletion));
+            return;
+        }
+    }
+    deletion();
+}
+
+void VulkanDeletionQueue::run(std::vector<std::function<void()>> &deletions) {
+    for (auto& deletion : deletions){
+        deletion();
+    }
+    deletions.clear();
+}
+
+}
@@ -0,0 +1,56 @@
+#ifndef EAGLE_VULKANDELETIONQUEUE_H
+#define EAGLE_VULKANDELETIONQUEUE_H
+
+#include "vulkan_global_definitions.h"
+
+#include <functional>
+#include <mutex>
+
+namespace eagle {
+
+//Defers the destruction of vulkan objects until the GPU can no longer be using them, so resources can be released
+//at runtime without vkDeviceWaitIdle.
+//Deletions pushed since the last graphics submission are attached to the next one and run once that frame's fence
+//has signaled. The fence covers every earlier submission to the graphics queue and the async compute the frame
+//waited on, so anything recorded before the push is done by then.
+//Deletions run immediately when the queue is not initialized, e.g. while the context is torn down.
+class VulkanDeletionQueue {
+public:
+    static void init(uint32_t frameCount);
+    //runs every pending deletion, the device must be idle
+    static void destroy();
+
+    //runs every pending deletion without waiting for the frames, the device must be idle
+    static void flush();
+
+    static inline bool initialized() { return !s_frames.empty(); }
+
+    //called once the frame's fence has signaled, runs the deletions attached to the frame's last submission
+    static void begin_frame(uint32_t frameIndex);
+
+    //called right after the frame's graphics submission
+    static void submit_frame(uint32_t frameIndex);
+
+    //thread safe
+    static void push(std::function<void()>&& deletion);
+
+    //keeps the object alive until the GPU is done with it
+    template<typename T>
+    static void push(std::shared_ptr<T> object) {
+        if (object){
+            push([object = std::move(object)]() mutable { object.reset(); });
+        }
+    }
+
+private:
+    static void run(std::vector<std::function<void()>>& deletions);
+
+private:
+    static std::mutex s_mutex;
+    static std::vector<std::function<void()>> s_pending;
+    static std::vector<std::vector<std::function<void()>>> s_frames;
+};
+
+}
+
+#endif //EAGLE_VULKANDELETIONQUEUE_H
@@ -0,0 +1,314 @@
+#include <eagle/renderer/vulkan/vulkan_descriptor_allocator.h>
+#include <eagle/renderer/vulkan/vulkan_descriptor_set_layout.h>
+#include <eagle/log.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace eagle {
+
+namespace {
+
+struct PoolRatio {
+    VkDescriptorType type;
+    float descriptorsPerSet;
+};
+
+//descriptors reserved per set in each persistent pool, mirrors what the engine's layouts usually contain
+const PoolRatio POOL_RATIOS[] = {
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2.0f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.0f},
+        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 0.5f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0.5f},
+};
+
+}
+
+VkDevice VulkanDescriptorAllocator::s_device = VK_NULL_HANDLE;
+std::vector<VkDescriptorPool> VulkanDescriptorAllocator::s_pools;
+size_t VulkanDescriptorAllocator::s_currentPool = 0;
+std::vector<VkDescriptorPool> VulkanDescriptorAllocator::s_reclaimedPools;
+uint32_t VulkanDescriptorAllocator::s_nextPoolSets = VulkanDescriptorAllocator::INITIAL_POOL_SETS;
+std::unordered_map<VkDescriptorSetLayout, std::vector<VulkanDescriptorAllocator::FreeSet>> VulkanDescriptorAllocator::s_freeSets;
+std::vector<VulkanDescriptorAllocator::TransientPools> VulkanDescriptorAllocator::s_transientPools;
+VulkanDescriptorAllocatorStats VulkanDescriptorAllocator::s_stats;
+std::mutex VulkanDescriptorAllocator::s_mutex;
+PFN_vkCreateDescriptorUpdateTemplateKHR VulkanDescriptorAllocator::s_createUpdateTemplate = nullptr;
+PFN_vkDestroyDescriptorUpdateTemplateKHR VulkanDescriptorAllocator::s_destroyUpdateTemplate = nullptr;
+PFN_vkUpdateDescriptorSetWithTemplateKHR VulkanDescriptorAllocator::s_updateWithTemplate = nullptr;
+
+void VulkanDescriptorAllocator::init(VkDevice device, uint32_t frameCount, bool updateTemplatesSupported) {
+    EG_TRACE("eagle","Initializing vulkan descriptor allocator!");
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_device = device;
+    s_currentPool = 0;
+    s_nextPoolSets = INITIAL_POOL_SETS;
+    s_transientPools.resize(frameCount);
+    s_stats = {};
+
+    if (updateTemplatesSupported){
+        s_createUpdateTemplate = reinterpret_cast<PFN_vkCreateDescriptorUpdateTemplateKHR>(
+                vkGetDeviceProcAddr(s_device, "vkCreateDescriptorUpdateTemplateKHR"));
+        s_destroyUpdateTemplate = reinterpret_cast<PFN_vkDestroyDescriptorUpdateTemplateKHR>(
+                vkGetDeviceProcAddr(s_device, "vkDestroyDescriptorUpdateTemplateKHR"));
+        s_updateWithTemplate = reinterpret_cast<PFN_vkUpdateDescriptorSetWithTemplateKHR>(
+                vkGetDeviceProcAddr(s_device, "vkUpdateDescriptorSetWithTemplateKHR"));
+        if (!s_createUpdateTemplate || !s_destroyUpdateTemplate || !s_updateWithTemplate){
+            EG_WARNING("eagle", "Descriptor update templates unavailable, falling back to vkUpdateDescriptorSets");
+            s_createUpdateTemplate = nullptr;
+        }
+    }
+}
+
+void VulkanDescriptorAllocator::destroy() {
+    EG_TRACE("eagle","Destroying vulkan descriptor allocator!");
+    std::lock_guard<std::mutex> lock(s_mutex);
+    EG_TRACE("eagle", "Descriptor allocator: {0} pools created, {1} sets allocated, {2} sets reused, {3:.2f}us per allocation",
+             s_stats.poolsCreated, s_stats.setsAllocated, s_stats.setsReused, s_stats.average_allocation_time_us());
+
+    for (auto pool : s_pools){
+        VK_CALL vkDestroyDescriptorPool(s_device, pool, nullptr);
+    }
+    for (auto& frame : s_transientPools){
+        for (auto pool : frame.pools){
+            VK_CALL vkDestroyDescriptorPool(s_device, pool, nullptr);
+        }
+    }
+    s_pools.clear();
+    s_reclaimedPools.clear();
+    s_transientPools.clear();
+    s_freeSets.clear();
+    s_device = VK_NULL_HANDLE;
+    s_createUpdateTemplate = nullptr;
+    s_destroyUpdateTemplate = nullptr;
+    s_updateWithTemplate = nullptr;
+}
+
+void VulkanDescriptorAllocator::allocate(VulkanDescriptorSetLayout &layout, uint32_t count,
+                                         std::vector<VkDescriptorSet> &sets, std::vector<VkDescriptorPool> &pools) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto start = std::chrono::high_resolution_clock::now();
+
+    VkDescriptorSetLayout nativeLayout = layout.get_native_layout();
+    sets.resize(count);
+    pools.resize(count);
+
+    //free list first
+    uint32_t reused = 0;
+    auto it = s_freeSets.find(nativeLayout);
+    if (it != s_freeSets.end()){
+        auto& freeSets = it->second;
+        reused = std::min<uint32_t>(count, freeSets.size());
+        for (uint32_t i = 0; i < reused; i++){
+            sets[i] = freeSets.back().set;
+            pools[i] = freeSets.back().pool;
+            freeSets.pop_back();
+        }
+    }
+
+    uint32_t remaining = count - reused;
+    if (remaining > 0){
+        VkDescriptorPool pool = VK_NULL_HANDLE;
+        while (s_currentPool < s_pools.size()){
+            if (allocate_from(s_pools[s_currentPool], nativeLayout, remaining, &sets[reused]) == VK_SUCCESS){
+                pool = s_pools[s_currentPool];
+                break;
+            }
+            s_currentPool++;
+        }
+
+        //pools that ran out are only worth another try once sets went back to them
+        while (pool == VK_NULL_HANDLE && !s_reclaimedPools.empty()){
+            if (allocate_from(s_reclaimedPools.back(), nativeLayout, remaining, &sets[reused]) == VK_SUCCESS){
+                pool = s_reclaimedPools.back();
+                break;
+            }
+            s_reclaimedPools.pop_back();
+        }
+
+        if (pool == VK_NULL_HANDLE){
+            pool = create_pool(s_nextPoolSets, layout.get_native_bindings(), remaining,
+                               VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
+            s_pools.emplace_back(pool);
+            s_currentPool = s_pools.size() - 1;
+            s_nextPoolSets = std::min(s_nextPoolSets * 2, MAX_POOL_SETS);
+
+            VK_CALL_ASSERT(allocate_from(pool, nativeLayout, remaining, &sets[reused])) {
+                throw std::runtime_error("failed to allocate descriptor sets!");
+            }
+        }
+        std::fill(pools.begin() + reused, pools.end(), pool);
+    }
+
+    s_stats.setsReused += reused;
+    s_stats.setsAllocated += remaining;
+    s_stats.allocationCount++;
+    s_stats.totalAllocationTimeUs += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void VulkanDescriptorAllocator::free(VkDescriptorSetLayout layout, const std::vector<VkDescriptorSet> &sets,
+                                     const std::vector<VkDescriptorPool> &pools) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (s_device == VK_NULL_HANDLE){
+        //the pools were already destroyed with the allocator
+        return;
+    }
+
+    std::vector<FreeSet> freed(sets.size());
+    for (size_t i = 0; i < sets.size(); i++){
+        freed[i] = {sets[i], pools[i]};
+    }
+
+    if (layout == VK_NULL_HANDLE){
+        free_to_pools(freed.data(), freed.size());
+        return;
+    }
+    auto& freeSets = s_freeSets[layout];
+    freeSets.insert(freeSets.end(), freed.begin(), freed.end());
+}
+
+void VulkanDescriptorAllocator::release_layout(VkDescriptorSetLayout layout) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto it = s_freeSets.find(layout);
+    if (it == s_freeSets.end()){
+        return;
+    }
+    //the handle may be reused by a different layout, so its sets cannot stay in the free list
+    free_to_pools(it->second.data(), it->second.size());
+    s_freeSets.erase(it);
+}
+
+VkDescriptorSet VulkanDescriptorAllocator::allocate_transient(VulkanDescriptorSetLayout &layout, uint32_t frameIndex) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto start = std::chrono::high_resolution_clock::now();
+
+    auto& frame = s_transientPools[frameIndex];
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    while (frame.current < frame.pools.size()){
+        if (allocate_from(frame.pools[frame.current], layout.get_native_layout(), 1, &set) == VK_SUCCESS){
+            break;
+        }
+        frame.current++;
+    }
+
+    if (set == VK_NULL_HANDLE){
+        VkDescriptorPool pool = create_pool(TRANSIENT_POOL_SETS, layout.get_native_bindings(), 1, 0);
+        frame.pools.emplace_back(pool);
+        frame.current = frame.pools.size() - 1;
+        VK_CALL_ASSERT(allocate_from(pool, layout.get_native_layout(), 1, &set)) {
+            throw std::runtime_error("failed to allocate transient descriptor set!");
+        }
+    }
+
+    s_stats.setsAllocated++;
+    s_stats.allocationCount++;
+    s_stats.totalAllocationTimeUs += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+    return set;
+}
+
+void VulkanDescriptorAllocator::reset_frame(uint32_t frameIndex) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto& frame = s_transientPools[frameIndex];
+    for (size_t i = 0; i < frame.pools.size() && i <= frame.current; i++){
+        VK_CALL vkResetDescriptorPool(s_device, frame.pools[i], 0);
+    }
+    frame.current = 0;
+}
+
+VulkanDescriptorAllocatorStats VulkanDescriptorAllocator::stats() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    VulkanDescriptorAllocatorStats stats = s_stats;
+    stats.persistentPoolCount = s_pools.size();
+    for (auto& frame : s_transientPools){
+        stats.transientPoolCount += frame.pools.size();
+    }
+    return stats;
+}
+
+VkDescriptorUpdateTemplateKHR VulkanDescriptorAllocator::create_update_template(const VkDescriptorUpdateTemplateCreateInfoKHR &createInfo) {
+    VkDescriptorUpdateTemplateKHR updateTemplate;
+    VK_CALL_ASSERT(s_createUpdateTemplate(s_device, &createInfo, nullptr, &updateTemplate)) {
+        throw std::runtime_error("failed to create descriptor update template!");
+    }
+    return updateTemplate;
+}
+
+void VulkanDescriptorAllocator::destroy_update_template(VkDescriptorUpdateTemplateKHR updateTemplate) {
+    if (s_device == VK_NULL_HANDLE || updateTemplate == VK_NULL_HANDLE){
+        return;
+    }
+    VK_CALL s_destroyUpdateTemplate(s_device, updateTemplate, nullptr);
+}
+
+VkDescriptorPool VulkanDescriptorAllocator::create_pool(uint32_t maxSets, const std::vector<VkDescriptorSetLayoutBinding> &bindings,
+                                                        uint32_t requiredSets, VkDescriptorPoolCreateFlags flags) {
+    maxSets = std::max(maxSets, requiredSets);
+
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    for (auto& ratio : POOL_RATIOS){
+        poolSizes.push_back({ratio.type, std::max(1u, static_cast<uint32_t>(ratio.descriptorsPerSet * maxSets))});
+    }
+
+    //makes sure the layout that triggered the pool always fits, whatever the ratios are
+    for (auto& binding : bindings){
+        auto it = std::find_if(poolSizes.begin(), poolSizes.end(), [&binding](const VkDescriptorPoolSize& size){
+            return size.type == binding.descriptorType;
+        });
+        if (it == poolSizes.end()){
+            poolSizes.push_back({binding.descriptorType, 0});
+            it = poolSizes.end() - 1;
+        }
+        uint32_t required = 0;
+        for (auto& other : bindings){
+            if (other.descriptorType == binding.descriptorType){
+                required += other.descriptorCount * requiredSets;
+            }
+        }
+        it->descriptorCount = std::max(it->descriptorCount, required);
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = flags;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = maxSets;
+
+    VkDescriptorPool pool;
+    VK_CALL_ASSERT(vkCreateDescriptorPool(s_device, &poolInfo, nullptr, &pool)) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+    s_stats.poolsCreated++;
+    EG_TRACE("eagle", "Created descriptor pool #{0} for {1} sets", s_stats.poolsCreated, maxSets);
+    return pool;
+}
+
+VkResult VulkanDescriptorAllocator::allocate_from(VkDescriptorPool pool, VkDescriptorSetLayout layout, uint32_t count,
+                                                  VkDescriptorSet *sets) {
+    std::vector<VkDescriptorSetLayout> layouts(count, layout);
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = pool;
+    allocInfo.descriptorSetCount = count;
+    allocInfo.pSetLayouts = layouts.data();
+
+    //out of pool memory and fragmentation both just mean the next pool has to be tried
+    VK_CALL return vkAllocateDescriptorSets(s_device, &allocInfo, sets);
+}
+
+void VulkanDescriptorAllocator::free_to_pools(const FreeSet *sets, size_t count) {
+    for (size_t i = 0; i < count; i++){
+        VK_CALL vkFreeDescriptorSets(s_device, sets[i].pool, 1, &sets[i].set);
+
+        //the current pool and the ones after it are tried anyway
+        auto it = std::find(s_pools.begin(), s_pools.end(), sets[i].pool);
+        if (static_cast<size_t>(it - s_pools.begin()) < s_currentPool &&
+            std::find(s_reclaimedPools.begin(), s_reclaimedPools.end(), sets[i].pool) == s_reclaimedPools.end()){
+            s_reclaimedPools.emplace_back(sets[i].pool);
+        }
+    }
+}
+
+}
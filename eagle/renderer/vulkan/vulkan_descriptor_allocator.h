@@ -0,0 +1,106 @@
+#ifndef EAGLE_VULKANDESCRIPTORALLOCATOR_H
+#define EAGLE_VULKANDESCRIPTORALLOCATOR_H
+
+#include "vulkan_global_definitions.h"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace eagle {
+
+class VulkanDescriptorSetLayout;
+
+struct VulkanDescriptorAllocatorStats {
+    size_t persistentPoolCount = 0;
+    size_t transientPoolCount = 0;
+    size_t poolsCreated = 0;
+    size_t setsAllocated = 0;       //sets that required vkAllocateDescriptorSets
+    size_t setsReused = 0;          //sets served from a free list
+    size_t allocationCount = 0;     //calls to allocate / allocate_transient
+    double totalAllocationTimeUs = 0.0;
+
+    inline double average_allocation_time_us() const {
+        return allocationCount == 0 ? 0.0 : totalAllocationTimeUs / allocationCount;
+    }
+};
+
+//Context-wide descriptor set allocator.
+//Persistent sets come from a growing list of large pools sized with per-type ratios. Freed sets are kept
+//in a free list keyed by their layout and handed out again before any new set is allocated, so recreating a
+//descriptor set never creates or destroys a pool. Sets of destroyed layouts go back to their pools, which are tried
+//again before a new pool is created.
+//Transient sets come from per-frame pools that are reset as a whole once that frame's fence has signaled.
+//It also wraps VK_KHR_descriptor_update_template, used by descriptor sets when the device supports it.
+class VulkanDescriptorAllocator {
+public:
+    static constexpr uint32_t INITIAL_POOL_SETS = 128;
+    static constexpr uint32_t MAX_POOL_SETS = 4096;
+    static constexpr uint32_t TRANSIENT_POOL_SETS = 256;
+
+    static void init(VkDevice device, uint32_t frameCount, bool updateTemplatesSupported = false);
+    static void destroy();
+
+    //fills sets and the pools they came from, both are needed to give them back
+    static void allocate(VulkanDescriptorSetLayout& layout, uint32_t count,
+                         std::vector<VkDescriptorSet>& sets, std::vector<VkDescriptorPool>& pools);
+
+    //returns the sets to the layout's free list, or straight to their pools when layout is VK_NULL_HANDLE
+    static void free(VkDescriptorSetLayout layout, const std::vector<VkDescriptorSet>& sets,
+                     const std::vector<VkDescriptorPool>& pools);
+
+    //drops the free list of a layout that is about to be destroyed
+    static void release_layout(VkDescriptorSetLayout layout);
+
+    //valid until reset_frame(frameIndex) is called again for the frame that allocated it
+    static VkDescriptorSet allocate_transient(VulkanDescriptorSetLayout& layout, uint32_t frameIndex);
+
+    //called once the frame's fence has signaled
+    static void reset_frame(uint32_t frameIndex);
+
+    static inline bool initialized() { return s_device != VK_NULL_HANDLE; }
+
+    static inline bool update_templates_supported() { return s_createUpdateTemplate != nullptr; }
+    static VkDescriptorUpdateTemplateKHR create_update_template(const VkDescriptorUpdateTemplateCreateInfoKHR& createInfo);
+    static void destroy_update_template(VkDescriptorUpdateTemplateKHR updateTemplate);
+    static inline void update_with_template(VkDescriptorSet set, VkDescriptorUpdateTemplateKHR updateTemplate, const void* data) {
+        s_updateWithTemplate(s_device, set, updateTemplate, data);
+    }
+
+    static VulkanDescriptorAllocatorStats stats();
+
+private:
+    struct FreeSet {
+        VkDescriptorSet set;
+        VkDescriptorPool pool;
+    };
+
+    struct TransientPools {
+        std::vector<VkDescriptorPool> pools;
+        size_t current = 0;
+    };
+
+    static VkDescriptorPool create_pool(uint32_t maxSets, const std::vector<VkDescriptorSetLayoutBinding>& bindings,
+                                        uint32_t requiredSets, VkDescriptorPoolCreateFlags flags);
+    static VkResult allocate_from(VkDescriptorPool pool, VkDescriptorSetLayout layout, uint32_t count, VkDescriptorSet* sets);
+    static void free_to_pools(const FreeSet* sets, size_t count);
+
+private:
+    static VkDevice s_device;
+    static std::vector<VkDescriptorPool> s_pools;
+    static size_t s_currentPool;
+    //pools behind s_currentPool that had sets returned to them, tried again before a new pool is created
+    static std::vector<VkDescriptorPool> s_reclaimedPools;
+    static uint32_t s_nextPoolSets;
+    static std::unordered_map<VkDescriptorSetLayout, std::vector<FreeSet>> s_freeSets;
+    static std::vector<TransientPools> s_transientPools;
+    static VulkanDescriptorAllocatorStats s_stats;
+    static std::mutex s_mutex;
+
+    static PFN_vkCreateDescriptorUpdateTemplateKHR s_createUpdateTemplate;
+    static PFN_vkDestroyDescriptorUpdateTemplateKHR s_destroyUpdateTemplate;
+    static PFN_vkUpdateDescriptorSetWithTemplateKHR s_updateWithTemplate;
+};
+
+}
+
+#endif //EAGLE_VULKANDESCRIPTORALLOCATOR_H
@@ -2,6 +2,11 @@
 #include <eagle/renderer/vulkan/vulkan_converter.h>
 #include "vulkan_descriptor_set.h"
 #include "vulkan_image.h"
+#include "vulkan_descriptor_allocator.h"
+#include "vulkan_deletion_queue.h"
+#include "vulkan_dynamic_uniform_buffer.h"
+
+#include <cstring>
 
 namespace eagle {
 
@@ -9,6 +14,7 @@ VulkanDescriptorSet::VulkanDescriptorSet(const std::shared_ptr<VulkanDescriptorS
                                          const std::vector<std::shared_ptr<DescriptorItem>> &descriptorItems,
                                          const VulkanDescriptorSetCreateInfo& createInfo) :
     m_descriptorSetLayout(descriptorSetLayout), m_descriptorItems(descriptorItems), m_info(createInfo){
+    track_streamed_textures(true);
     create_descriptor_sets();
     for (uint32_t i = 0; i < m_descriptorSets.size(); i++){
         flush(i);
@@ -22,50 +28,29 @@ VulkanDescriptorSet::VulkanDescriptorSet(const std::shared_ptr<VulkanDescriptorS
 }
 
 VulkanDescriptorSet::~VulkanDescriptorSet() {
+    track_streamed_textures(false);
     cleanup();
 }
 
 void VulkanDescriptorSet::create_descriptor_sets() {
 
     if (!m_cleared) return;
-    auto layoutBindings = m_descriptorSetLayout.lock()->get_native_bindings();
-
-    std::vector<VkDescriptorPoolSize> poolSizes = {};
-    poolSizes.resize(layoutBindings.size());
-    for (size_t i = 0; i < layoutBindings.size(); i++) {
-        poolSizes[i].type = layoutBindings[i].descriptorType;
-        poolSizes[i].descriptorCount = m_info.bufferCount;
-    }
-
-    VkDescriptorPoolCreateInfo poolInfo = {};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-    poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = static_cast<uint32_t>(poolSizes[0].descriptorCount);
-
-    VK_CALL_ASSERT(vkCreateDescriptorPool(m_info.device, &poolInfo, nullptr, &m_descriptorPool)) {
-        throw std::runtime_error("failed to create descriptor pool!");
-    }
-
-    std::vector<VkDescriptorSetLayout> layouts(m_info.bufferCount, m_descriptorSetLayout.lock()->get_native_layout());
-    VkDescriptorSetAllocateInfo allocInfo = {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = m_descriptorPool;
-    allocInfo.descriptorSetCount = m_info.bufferCount;
-    allocInfo.pSetLayouts = layouts.data();
-
-    m_descriptorSets.resize(m_info.bufferCount);
-    VK_CALL_ASSERT(vkAllocateDescriptorSets(m_info.device, &allocInfo, m_descriptorSets.data())) {
-        throw std::runtime_error("failed to allocate descriptor sets!");
-    }
+    VulkanDescriptorAllocator::allocate(*m_descriptorSetLayout.lock(), m_info.bufferCount, m_descriptorSets, m_descriptorPools);
+    //sets may come from a free list with another owner's contents, nothing is known to be written yet
+    m_writtenInfos.assign(m_descriptorSets.size(), {});
     m_cleared = false;
 }
 
 void VulkanDescriptorSet::update(const std::vector<std::shared_ptr<DescriptorItem>> &descriptorItems) {
 
-
+    track_streamed_textures(false);
     m_descriptorItems = descriptorItems;
+    track_streamed_textures(true);
+
+    invalidate();
+}
 
+void VulkanDescriptorSet::invalidate() {
     if (m_cleared) return;
 
     for (uint32_t i = 0; i < m_descriptorSets.size(); i++){
@@ -74,101 +59,164 @@ void VulkanDescriptorSet::update(const std::vector<std::shared_ptr<DescriptorIte
     VulkanCleaner::push(this);
 }
 
+void VulkanDescriptorSet::track_streamed_textures(bool track) {
+    for (auto& item : m_descriptorItems){
+        if (item->type() != DescriptorType::COMBINED_IMAGE_SAMPLER){
+            continue;
+        }
+        auto texture = std::static_pointer_cast<VulkanTexture>(item);
+        if (!texture->is_streamed()){
+            continue;
+        }
+        if (track){
+            texture->add_descriptor_set(this);
+        }
+        else {
+            texture->remove_descriptor_set(this);
+        }
+    }
+}
+
+bool VulkanDescriptorSet::is_ready() const {
+    for (auto& item : m_descriptorItems){
+        switch (item->type()){
+            case DescriptorType::STORAGE_BUFFER:
+                if (!std::static_pointer_cast<VulkanStorageBuffer>(item)->is_ready()){
+                    return false;
+                }
+                break;
+            case DescriptorType::SAMPLED_IMAGE:
+            case DescriptorType::STORAGE_IMAGE:
+                if (!std::static_pointer_cast<VulkanImage>(item)->is_ready()){
+                    return false;
+                }
+                break;
+            case DescriptorType::COMBINED_IMAGE_SAMPLER:
+                if (!std::static_pointer_cast<VulkanTexture>(item)->is_ready()){
+                    return false;
+                }
+                break;
+            default:
+                //uniform buffers are written by the host, they never go through the async path
+                break;
+        }
+    }
+    return true;
+}
+
 bool VulkanDescriptorSet::is_dirty() const {
     return !m_dirtyDescriptors.empty();
 }
 
 void VulkanDescriptorSet::flush(uint32_t index) {
 
-    std::vector<VkDescriptorSetLayoutBinding> descriptorBindings = m_descriptorSetLayout.lock()->get_native_bindings();
-    std::vector<VkDescriptorBufferInfo> bufferInfos;
-    std::vector<VkDescriptorImageInfo> imageInfos;
+    auto layout = m_descriptorSetLayout.lock();
+    const std::vector<VkDescriptorSetLayoutBinding>& descriptorBindings = layout->get_native_bindings();
+
+    //zeroed first so that padding never makes two identical infos compare different
+    m_pendingInfos.resize(m_descriptorItems.size());
+    std::memset(m_pendingInfos.data(), 0, m_pendingInfos.size() * sizeof(VulkanDescriptorInfo));
 
     //foreach descriptor item in descriptor set
     for (uint32_t j = 0; j < m_descriptorItems.size(); j++){
 
+        VulkanDescriptorInfo& info = m_pendingInfos[j];
         switch (m_descriptorItems[j]->type()){
 
             case DescriptorType::UNIFORM_BUFFER:{
                 auto buffer = std::static_pointer_cast<VulkanUniformBuffer>(m_descriptorItems[j]);
-                VkDescriptorBufferInfo bufferInfo = {};
-                bufferInfo.buffer = buffer->get_buffers()[index]->native_buffer();
-                bufferInfo.offset = 0;
-                bufferInfo.range = buffer->size();
-                bufferInfos.push_back(bufferInfo);
+                info.buffer.buffer = buffer->get_buffers()[index]->native_buffer();
+                info.buffer.offset = 0;
+                info.buffer.range = buffer->size();
                 break;
             }
             case DescriptorType::STORAGE_BUFFER:{
                 auto buffer = std::static_pointer_cast<VulkanStorageBuffer>(m_descriptorItems[j]);
-                VkDescriptorBufferInfo bufferInfo = {};
-                bufferInfo.buffer = buffer->get_buffers()[index]->native_buffer();
-                bufferInfo.offset = 0;
-                bufferInfo.range = buffer->size();
-                bufferInfos.push_back(bufferInfo);
+                info.buffer.buffer = buffer->get_buffers()[index]->native_buffer();
+                info.buffer.offset = 0;
+                info.buffer.range = buffer->size();
                 break;
             }
-            case DescriptorType::SAMPLED_IMAGE:{
-                auto image = std::static_pointer_cast<VulkanImage>(m_descriptorItems[j]);
-                VkDescriptorImageInfo imageInfo = {};
-                imageInfo.imageLayout = VulkanConverter::to_vk(image->layout());
-                imageInfo.imageView = image->native_image_views()[index];
-                imageInfos.push_back(imageInfo);
+            case DescriptorType::UNIFORM_BUFFER_DYNAMIC:{
+                //the ring is shared by every dynamic buffer, the block is picked by the dynamic offset when binding
+                auto buffer = std::static_pointer_cast<VulkanDynamicUniformBuffer>(m_descriptorItems[j]);
+                info.buffer.buffer = VulkanFrameRing::native_buffer();
+                info.buffer.offset = 0;
+                info.buffer.range = buffer->block_size();
                 break;
             }
+            case DescriptorType::SAMPLED_IMAGE:
             case DescriptorType::STORAGE_IMAGE:{
                 auto image = std::static_pointer_cast<VulkanImage>(m_descriptorItems[j]);
-                VkDescriptorImageInfo imageInfo = {};
-                imageInfo.imageLayout = VulkanConverter::to_vk(image->layout());
-                imageInfo.imageView = image->native_image_views()[index];
-                imageInfos.push_back(imageInfo);
+                info.image.imageLayout = VulkanConverter::to_vk(image->layout());
+                info.image.imageView = image->native_image_views()[index];
                 break;
             }
             case DescriptorType::COMBINED_IMAGE_SAMPLER:{
-
                 auto texture = std::static_pointer_cast<VulkanTexture>(m_descriptorItems[j]);
-                VkDescriptorImageInfo imageInfo = {};
-                imageInfo.imageLayout = VulkanConverter::to_vk(texture->native_image()->layout());
-                imageInfo.imageView = texture->native_image()->native_image_views()[index];
-                imageInfo.sampler = texture->sampler();
-                imageInfos.push_back(imageInfo);
+                info.image.imageLayout = VulkanConverter::to_vk(texture->native_image()->layout());
+                info.image.imageView = texture->native_image()->native_image_views()[index];
+                info.image.sampler = texture->sampler();
                 break;
             }
         }
     }
 
-    std::vector<VkWriteDescriptorSet> descriptorWrite = {};
-
-    descriptorWrite.resize(m_descriptorItems.size());
-    size_t bufferIndex = 0;
-    size_t imageIndex = 0;
-    for (size_t j = 0; j < descriptorWrite.size(); j++) {
-        descriptorWrite[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrite[j].dstSet = m_descriptorSets[index];
-        descriptorWrite[j].dstBinding = j;
-        descriptorWrite[j].dstArrayElement = 0;
-        descriptorWrite[j].descriptorType = descriptorBindings[j].descriptorType;
-        descriptorWrite[j].descriptorCount = 1;
-        if (descriptorWrite[j].descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
-            descriptorWrite[j].descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER){
-            descriptorWrite[j].pBufferInfo = &bufferInfos[bufferIndex];
-            bufferIndex++;
+    //a zeroed entry never matches a real descriptor, so new bindings always count as changed
+    std::vector<VulkanDescriptorInfo>& writtenInfos = m_writtenInfos[index];
+    writtenInfos.resize(m_pendingInfos.size(), VulkanDescriptorInfo{});
+
+    m_pendingWrites.clear();
+    for (size_t j = 0; j < m_pendingInfos.size(); j++) {
+        if (std::memcmp(&m_pendingInfos[j], &writtenInfos[j], sizeof(VulkanDescriptorInfo)) == 0){
+            continue;
         }
-        else if (descriptorWrite[j].descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
-                 descriptorWrite[j].descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
-                 descriptorWrite[j].descriptorType == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE){
-            descriptorWrite[j].pImageInfo = &imageInfos[imageIndex];
-            imageIndex++;
+        VkWriteDescriptorSet descriptorWrite = {};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = m_descriptorSets[index];
+        descriptorWrite.dstBinding = descriptorBindings[j].binding;
+        descriptorWrite.dstArrayElement = 0;
+        descriptorWrite.descriptorType = descriptorBindings[j].descriptorType;
+        descriptorWrite.descriptorCount = 1;
+        if (descriptorWrite.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
+            descriptorWrite.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+            descriptorWrite.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER){
+            descriptorWrite.pBufferInfo = &m_pendingInfos[j].buffer;
         }
+        else if (descriptorWrite.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
+                 descriptorWrite.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
+                 descriptorWrite.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE){
+            descriptorWrite.pImageInfo = &m_pendingInfos[j].image;
+        }
+        m_pendingWrites.push_back(descriptorWrite);
     }
 
-    VK_CALL vkUpdateDescriptorSets(m_info.device, static_cast<uint32_t>(descriptorWrite.size()), descriptorWrite.data(), 0, nullptr);
+    if (!m_pendingWrites.empty()){
+        //the template writes every binding at once, which is only valid when all of them have an item
+        VkDescriptorUpdateTemplateKHR updateTemplate = layout->get_update_template();
+        if (updateTemplate != VK_NULL_HANDLE && m_pendingInfos.size() == descriptorBindings.size()){
+            VK_CALL VulkanDescriptorAllocator::update_with_template(m_descriptorSets[index], updateTemplate, m_pendingInfos.data());
+        }
+        else {
+            VK_CALL vkUpdateDescriptorSets(m_info.device, static_cast<uint32_t>(m_pendingWrites.size()), m_pendingWrites.data(), 0, nullptr);
+        }
+        std::copy(m_pendingInfos.begin(), m_pendingInfos.end(), writtenInfos.begin());
+    }
 
     m_dirtyDescriptors.erase(index);
 }
 
-    void VulkanDescriptorSet::cleanup() {
+void VulkanDescriptorSet::cleanup() {
     if (m_cleared) return;
-    VK_CALL vkDestroyDescriptorPool(m_info.device, m_descriptorPool, nullptr);
+    //frames in flight may still bind the sets, they go back to the layout's free list once those are done.
+    //the layout is looked up then, its free list is gone if it was destroyed in the meantime
+    VulkanDeletionQueue::push([weakLayout = m_descriptorSetLayout, sets = std::move(m_descriptorSets),
+                               pools = std::move(m_descriptorPools)]{
+        auto layout = weakLayout.lock();
+        VulkanDescriptorAllocator::free(layout ? layout->get_native_layout() : VK_NULL_HANDLE, sets, pools);
+    });
+    m_descriptorSets.clear();
+    m_descriptorPools.clear();
     m_cleared = true;
 }
 
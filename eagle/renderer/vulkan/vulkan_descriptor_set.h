@@ -31,16 +31,30 @@ public:
     void create_descriptor_sets();
 
     virtual void update(const std::vector<std::shared_ptr<DescriptorItem>> &descriptorItems) override;
+    //rewrites every set on its next flush, e.g. after a streamed texture swapped its image
+    void invalidate();
     inline std::vector<VkDescriptorSet>& get_descriptors() {return m_descriptorSets;}
 
     virtual bool is_dirty() const override;
 
+    //false while a bound storage buffer or image is still on its async upload
+    bool is_ready() const;
+
     virtual void flush(uint32_t index) override;
 
+private:
+    void track_streamed_textures(bool track);
+
 private:
 
-    VkDescriptorPool m_descriptorPool;
     std::vector<VkDescriptorSet> m_descriptorSets;
+    std::vector<VkDescriptorPool> m_descriptorPools;    //pool of each set, owned by VulkanDescriptorAllocator
+
+    //last state written to each set, only bindings that differ from it are written again
+    std::vector<std::vector<VulkanDescriptorInfo>> m_writtenInfos;
+    //scratch storage reused by every flush
+    std::vector<VulkanDescriptorInfo> m_pendingInfos;
+    std::vector<VkWriteDescriptorSet> m_pendingWrites;
     std::set<int> m_dirtyDescriptors;
     std::weak_ptr<VulkanDescriptorSetLayout> m_descriptorSetLayout;
     std::vector<std::shared_ptr<DescriptorItem>> m_descriptorItems;
@@ -4,6 +4,7 @@
 
 #include <eagle/renderer/vulkan/vulkan_descriptor_set_layout.h>
 #include <eagle/renderer/vulkan/vulkan_converter.h>
+#include <eagle/renderer/vulkan/vulkan_descriptor_allocator.h>
 
 namespace eagle {
 
@@ -25,6 +26,8 @@ VulkanDescriptorSetLayout::VulkanDescriptorSetLayout(VkDevice device, const std:
 }
 
 VulkanDescriptorSetLayout::~VulkanDescriptorSetLayout() {
+    VulkanDescriptorAllocator::release_layout(m_layout);
+    VulkanDescriptorAllocator::destroy_update_template(m_updateTemplate);
     VK_CALL vkDestroyDescriptorSetLayout(m_device, m_layout, nullptr);
 }
 
@@ -44,4 +47,29 @@ const std::vector<DescriptorBindingDescription> &VulkanDescriptorSetLayout::bind
     return m_bindings;
 }
 
-}
\ No newline at end of file
+VkDescriptorUpdateTemplateKHR VulkanDescriptorSetLayout::get_update_template() {
+    if (m_updateTemplate != VK_NULL_HANDLE || !VulkanDescriptorAllocator::update_templates_supported()){
+        return m_updateTemplate;
+    }
+
+    std::vector<VkDescriptorUpdateTemplateEntryKHR> entries(m_nativeBindings.size());
+    for (size_t i = 0; i < entries.size(); i++){
+        entries[i].dstBinding = m_nativeBindings[i].binding;
+        entries[i].dstArrayElement = 0;
+        entries[i].descriptorCount = m_nativeBindings[i].descriptorCount;
+        entries[i].descriptorType = m_nativeBindings[i].descriptorType;
+        entries[i].offset = i * sizeof(VulkanDescriptorInfo);
+        entries[i].stride = sizeof(VulkanDescriptorInfo);
+    }
+
+    VkDescriptorUpdateTemplateCreateInfoKHR createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR;
+    createInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size());
+    createInfo.pDescriptorUpdateEntries = entries.data();
+    createInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR;
+    createInfo.descriptorSetLayout = m_layout;
+    m_updateTemplate = VulkanDescriptorAllocator::create_update_template(createInfo);
+    return m_updateTemplate;
+}
+
+}
@@ -10,6 +10,14 @@
 
 namespace eagle {
 
+//packed per binding, the layout used by descriptor update templates
+struct VulkanDescriptorInfo {
+    union {
+        VkDescriptorBufferInfo buffer;
+        VkDescriptorImageInfo image;
+    };
+};
+
 class VulkanDescriptorSetLayout : public DescriptorSetLayout{
 public:
     VulkanDescriptorSetLayout(VkDevice device, const std::vector<DescriptorBindingDescription>& bindings);
@@ -22,11 +30,15 @@ public:
     inline VkDescriptorSetLayout& get_native_layout() { return m_layout; }
     inline const std::vector<VkDescriptorSetLayoutBinding>& get_native_bindings() { return m_nativeBindings; }
 
+    //reads one VulkanDescriptorInfo per binding, VK_NULL_HANDLE when update templates are not supported
+    VkDescriptorUpdateTemplateKHR get_update_template();
+
 private:
     VkDevice m_device;
     VkDescriptorSetLayout m_layout;
     std::vector<DescriptorBindingDescription> m_bindings;
     std::vector<VkDescriptorSetLayoutBinding> m_nativeBindings;
+    VkDescriptorUpdateTemplateKHR m_updateTemplate = VK_NULL_HANDLE;
 
 
 };
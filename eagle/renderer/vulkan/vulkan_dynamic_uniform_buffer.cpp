@@ -0,0 +1,15 @@
+#include <eagle/renderer/vulkan/vulkan_dynamic_uniform_buffer.h>
+
+namespace eagle {
+
+VulkanDynamicUniformBuffer::VulkanDynamicUniformBuffer(size_t blockSize) : DynamicUniformBuffer(blockSize) {
+    if (blockSize > VulkanFrameRing::max_uniform_range()){
+        throw std::runtime_error("dynamic uniform block is larger than maxUniformBufferRange!");
+    }
+}
+
+FrameAllocation VulkanDynamicUniformBuffer::allocate() {
+    return VulkanFrameRing::allocate(m_blockSize);
+}
+
+}
@@ -0,0 +1,19 @@
+#ifndef EAGLE_VULKANDYNAMICUNIFORMBUFFER_H
+#define EAGLE_VULKANDYNAMICUNIFORMBUFFER_H
+
+#include "eagle/renderer/dynamic_uniform_buffer.h"
+#include "vulkan_frame_ring.h"
+
+namespace eagle {
+
+//blocks are allocated from VulkanFrameRing, the descriptor always points at the ring
+class VulkanDynamicUniformBuffer : public DynamicUniformBuffer {
+public:
+    explicit VulkanDynamicUniformBuffer(size_t blockSize);
+
+    FrameAllocation allocate() override;
+};
+
+}
+
+#endif //EAGLE_VULKANDYNAMICUNIFORMBUFFER_H
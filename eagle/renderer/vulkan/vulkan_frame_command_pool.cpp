@@ -0,0 +1,74 @@
+#include <eagle/renderer/vulkan/vulkan_frame_command_pool.h>
+#include <eagle/log.h>
+
+namespace eagle {
+
+VkDevice VulkanFrameCommandPool::s_device = VK_NULL_HANDLE;
+std::vector<VulkanFrameCommandPool::Frame> VulkanFrameCommandPool::s_frames;
+uint32_t VulkanFrameCommandPool::s_currentFrame = 0;
+size_t VulkanFrameCommandPool::s_allocatedCount = 0;
+
+void VulkanFrameCommandPool::init(VkDevice device, uint32_t queueFamilyIndex, uint32_t frameCount) {
+    EG_TRACE("eagle","Initializing vulkan frame command pools!");
+    s_device = device;
+    s_currentFrame = 0;
+    s_allocatedCount = 0;
+    s_frames.resize(frameCount);
+
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = queueFamilyIndex;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    for (auto& frame : s_frames){
+        VK_CALL_ASSERT(vkCreateCommandPool(s_device, &poolInfo, nullptr, &frame.commandPool)) {
+            throw std::runtime_error("failed to create frame command pool!");
+        }
+    }
+}
+
+void VulkanFrameCommandPool::destroy() {
+    EG_TRACE("eagle","Destroying vulkan frame command pools! {0} command buffers were allocated", s_allocatedCount);
+    for (auto& frame : s_frames){
+        //destroying the pool frees its command buffers
+        VK_CALL vkDestroyCommandPool(s_device, frame.commandPool, nullptr);
+    }
+    s_frames.clear();
+    s_device = VK_NULL_HANDLE;
+}
+
+void VulkanFrameCommandPool::begin_frame(uint32_t frameIndex) {
+    s_currentFrame = frameIndex;
+    Frame& frame = s_frames[frameIndex];
+    if (frame.primaryUsed == 0 && frame.secondaryUsed == 0){
+        return;
+    }
+    VK_CALL vkResetCommandPool(s_device, frame.commandPool, 0);
+    frame.primaryUsed = 0;
+    frame.secondaryUsed = 0;
+}
+
+VkCommandBuffer VulkanFrameCommandPool::acquire(VkCommandBufferLevel level) {
+    Frame& frame = s_frames[s_currentFrame];
+    bool primary = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    auto& commandBuffers = primary ? frame.primary : frame.secondary;
+    size_t& used = primary ? frame.primaryUsed : frame.secondaryUsed;
+
+    if (used == commandBuffers.size()){
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = frame.commandPool;
+        allocInfo.level = level;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer;
+        VK_CALL_ASSERT(vkAllocateCommandBuffers(s_device, &allocInfo, &commandBuffer)) {
+            throw std::runtime_error("failed to allocate frame command buffer!");
+        }
+        commandBuffers.emplace_back(commandBuffer);
+        s_allocatedCount++;
+    }
+    return commandBuffers[used++];
+}
+
+}
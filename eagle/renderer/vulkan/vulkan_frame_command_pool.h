@@ -0,0 +1,41 @@
+#ifndef EAGLE_VULKANFRAMECOMMANDPOOL_H
+#define EAGLE_VULKANFRAMECOMMANDPOOL_H
+
+#include "vulkan_global_definitions.h"
+
+namespace eagle {
+
+//Command buffers for transient VulkanCommandBuffers, which are re-recorded every frame.
+//There is one pool per frame in flight. begin_frame resets the frame's pool in a single vkResetCommandPool
+//once its fence has signaled, and the command buffers it already allocated are handed out again, so
+//steady state recording allocates nothing. Only used from the thread that drives the frame.
+class VulkanFrameCommandPool {
+public:
+    static void init(VkDevice device, uint32_t queueFamilyIndex, uint32_t frameCount);
+    static void destroy();
+
+    //called once the frame's fence has signaled, before anything is recorded for it
+    static void begin_frame(uint32_t frameIndex);
+
+    //valid until the same frame slot begins again
+    static VkCommandBuffer acquire(VkCommandBufferLevel level);
+
+    static inline bool initialized() { return s_device != VK_NULL_HANDLE; }
+
+private:
+    struct Frame {
+        VkCommandPool commandPool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> primary, secondary;
+        size_t primaryUsed = 0, secondaryUsed = 0;
+    };
+
+private:
+    static VkDevice s_device;
+    static std::vector<Frame> s_frames;
+    static uint32_t s_currentFrame;
+    static size_t s_allocatedCount;
+};
+
+}
+
+#endif //EAGLE_VULKANFRAMECOMMANDPOOL_H
@@ -0,0 +1,70 @@
+#include <eagle/renderer/vulkan/vulkan_frame_ring.h>
+#include <eagle/log.h>
+
+namespace eagle {
+
+std::shared_ptr<VulkanBuffer> VulkanFrameRing::s_buffer;
+VkDeviceSize VulkanFrameRing::s_alignment = 1;
+VkDeviceSize VulkanFrameRing::s_frameSize = 0;
+VkDeviceSize VulkanFrameRing::s_maxUniformRange = 0;
+VkDeviceSize VulkanFrameRing::s_frameBegin = 0;
+std::atomic<VkDeviceSize> VulkanFrameRing::s_frameOffset(0);
+VkDeviceSize VulkanFrameRing::s_peakUsage = 0;
+
+static VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+void VulkanFrameRing::init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t frameCount,
+                           VkDeviceSize frameSize) {
+    EG_TRACE("eagle","Initializing vulkan frame ring!");
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    s_alignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 1);
+    s_maxUniformRange = properties.limits.maxUniformBufferRange;
+    s_frameSize = align_up(frameSize, s_alignment);
+    s_frameBegin = 0;
+    s_frameOffset = 0;
+    s_peakUsage = 0;
+
+    VulkanBufferCreateInfo createInfo = {};
+    createInfo.usageFlags = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    createInfo.memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+    VK_CALL_ASSERT(VulkanBuffer::create_buffer(physicalDevice, device, s_buffer, createInfo, s_frameSize * frameCount)) {
+        throw std::runtime_error("failed to create frame ring buffer!");
+    }
+    //mapped for the whole lifetime of the ring, coherent memory needs no flushes
+    VK_CALL_ASSERT(s_buffer->map()) {
+        throw std::runtime_error("failed to map frame ring buffer!");
+    }
+}
+
+void VulkanFrameRing::destroy() {
+    EG_TRACE("eagle","Destroying vulkan frame ring! Peak frame usage: {0} of {1} bytes", s_peakUsage, s_frameSize);
+    if (s_buffer){
+        s_buffer->unmap();
+        s_buffer->destroy();
+        s_buffer.reset();
+    }
+}
+
+void VulkanFrameRing::begin_frame(uint32_t frameIndex) {
+    s_peakUsage = std::max<VkDeviceSize>(s_peakUsage, s_frameOffset.load());
+    s_frameBegin = s_frameSize * frameIndex;
+    s_frameOffset = 0;
+}
+
+FrameAllocation VulkanFrameRing::allocate(VkDeviceSize size) {
+    VkDeviceSize offset = s_frameOffset.fetch_add(align_up(size, s_alignment));
+    if (offset + size > s_frameSize){
+        throw std::runtime_error("frame ring is full for this frame!");
+    }
+    FrameAllocation allocation = {};
+    allocation.offset = static_cast<uint32_t>(s_frameBegin + offset);
+    allocation.data = static_cast<char*>(s_buffer->get_data()) + allocation.offset;
+    return allocation;
+}
+
+}
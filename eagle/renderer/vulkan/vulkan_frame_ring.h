@@ -0,0 +1,43 @@
+#ifndef EAGLE_VULKANFRAMERING_H
+#define EAGLE_VULKANFRAMERING_H
+
+#include "vulkan_buffer.h"
+
+#include <atomic>
+
+namespace eagle {
+
+//A single persistently mapped, host coherent buffer split into one region per frame in flight, for data written
+//every frame: dynamic uniform blocks and per instance vertex streams.
+//Allocations bump a pointer inside the current frame's region, aligned to minUniformBufferOffsetAlignment.
+//begin_frame rewinds the region once its fence has signaled, so the GPU never reads data being overwritten.
+class VulkanFrameRing {
+public:
+    static constexpr VkDeviceSize DEFAULT_FRAME_SIZE = 16 * 1024 * 1024;
+
+    static void init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t frameCount,
+                     VkDeviceSize frameSize = DEFAULT_FRAME_SIZE);
+    static void destroy();
+
+    //called once the frame's fence has signaled, before anything is written for it
+    static void begin_frame(uint32_t frameIndex);
+
+    //offset is relative to the start of the buffer, throws once the frame's region is full. Thread safe
+    static FrameAllocation allocate(VkDeviceSize size);
+
+    static inline VkBuffer native_buffer() { return s_buffer ? s_buffer->native_buffer() : VK_NULL_HANDLE; }
+    static inline VkDeviceSize max_uniform_range() { return s_maxUniformRange; }
+
+private:
+    static std::shared_ptr<VulkanBuffer> s_buffer;
+    static VkDeviceSize s_alignment;
+    static VkDeviceSize s_frameSize;
+    static VkDeviceSize s_maxUniformRange;
+    static VkDeviceSize s_frameBegin;
+    static std::atomic<VkDeviceSize> s_frameOffset;
+    static VkDeviceSize s_peakUsage;
+};
+
+}
+
+#endif //EAGLE_VULKANFRAMERING_H
@@ -3,6 +3,7 @@
 //
 
 #include <eagle/renderer/vulkan/vulkan_framebuffer.h>
+#include <eagle/renderer/vulkan/vulkan_deletion_queue.h>
 
 namespace eagle {
 
@@ -21,9 +22,12 @@ VulkanFramebuffer::VulkanFramebuffer(const FramebufferCreateInfo &createInfo,
 
 VulkanFramebuffer::~VulkanFramebuffer() {
     EG_TRACE("eagle","Destroying a vulkan frame buffer!");
-    for (auto& framebuffer : m_framebuffers) {
-        VK_CALL vkDestroyFramebuffer(m_nativeCreateInfo.device, framebuffer, nullptr);
-    }
+    //frames in flight may still render to it, e.g. the present framebuffer replaced on a resize
+    VulkanDeletionQueue::push([device = m_nativeCreateInfo.device, framebuffers = std::move(m_framebuffers)]{
+        for (auto& framebuffer : framebuffers) {
+            VK_CALL vkDestroyFramebuffer(device, framebuffer, nullptr);
+        }
+    });
     EG_TRACE("eagle","Vulkan frame buffer destroyed!");
 }
 
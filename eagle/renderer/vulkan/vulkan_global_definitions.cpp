@@ -6,6 +6,6 @@
 
 namespace eagle {
 
-VkDebugInfo::VkCall VkDebugInfo::m_callInfo;
+thread_local VkDebugInfo::VkCall VkDebugInfo::m_callInfo;
 
 }
\ No newline at end of file
@@ -35,7 +35,8 @@ public:
         return m_callInfo;
     }
 
-    static VkCall m_callInfo;
+    //per thread, pipelines may be built on worker threads
+    static thread_local VkCall m_callInfo;
 
 private:
 
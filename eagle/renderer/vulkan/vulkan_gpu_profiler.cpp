@@ -0,0 +1,282 @@
+#include <eagle/renderer/vulkan/vulkan_gpu_profiler.h>
+#include <eagle/renderer/vulkan/vulkan_frame_command_pool.h>
+#include <eagle/log.h>
+
+#include <algorithm>
+
+namespace eagle {
+
+namespace {
+
+//results are written in bit order
+constexpr VkQueryPipelineStatisticFlags PIPELINE_STATISTICS =
+        VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+constexpr uint32_t PIPELINE_STATISTICS_COUNT = 5;
+
+}
+
+VulkanGpuQueryPool::VulkanGpuQueryPool(VkDevice device, uint32_t zoneCapacity, bool pipelineStatistics) :
+    m_device(device), m_capacity(zoneCapacity) {
+
+    VkQueryPoolCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    createInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    createInfo.queryCount = zoneCapacity * 2;
+
+    VK_CALL_ASSERT(vkCreateQueryPool(m_device, &createInfo, nullptr, &m_timestampPool)) {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+
+    if (pipelineStatistics){
+        createInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        createInfo.queryCount = zoneCapacity;
+        createInfo.pipelineStatistics = PIPELINE_STATISTICS;
+        VK_CALL_ASSERT(vkCreateQueryPool(m_device, &createInfo, nullptr, &m_statisticsPool)) {
+            throw std::runtime_error("failed to create pipeline statistics query pool!");
+        }
+    }
+    m_zones.reserve(zoneCapacity);
+}
+
+VulkanGpuQueryPool::~VulkanGpuQueryPool() {
+    VK_CALL vkDestroyQueryPool(m_device, m_timestampPool, nullptr);
+    if (m_statisticsPool != VK_NULL_HANDLE){
+        VK_CALL vkDestroyQueryPool(m_device, m_statisticsPool, nullptr);
+    }
+}
+
+void VulkanGpuQueryPool::record_reset(VkCommandBuffer commandBuffer, uint32_t zoneCount) {
+    if (zoneCount == 0){
+        return;
+    }
+    VK_CALL vkCmdResetQueryPool(commandBuffer, m_timestampPool, 0, zoneCount * 2);
+    if (m_statisticsPool != VK_NULL_HANDLE){
+        VK_CALL vkCmdResetQueryPool(commandBuffer, m_statisticsPool, 0, zoneCount);
+    }
+}
+
+uint32_t VulkanGpuQueryPool::begin_zone(VkCommandBuffer commandBuffer, const std::string &name, uint32_t depth, bool statistics) {
+    uint32_t zone;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_zones.size() == m_capacity){
+            return INVALID_ZONE;
+        }
+        zone = static_cast<uint32_t>(m_zones.size());
+        Zone& created = m_zones.emplace_back();
+        created.name = name;
+        created.depth = depth;
+        created.statistics = statistics && m_statisticsPool != VK_NULL_HANDLE;
+        statistics = created.statistics;
+    }
+
+    VK_CALL vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestampPool, zone * 2);
+    if (statistics){
+        VK_CALL vkCmdBeginQuery(commandBuffer, m_statisticsPool, zone, 0);
+    }
+    return zone;
+}
+
+void VulkanGpuQueryPool::end_zone(VkCommandBuffer commandBuffer, uint32_t zone) {
+    if (zone == INVALID_ZONE){
+        return;
+    }
+    bool statistics;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_zones[zone].ended = true;
+        statistics = m_zones[zone].statistics;
+    }
+
+    if (statistics){
+        VK_CALL vkCmdEndQuery(commandBuffer, m_statisticsPool, zone);
+    }
+    VK_CALL vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timestampPool, zone * 2 + 1);
+}
+
+bool VulkanGpuQueryPool::resolve(float timestampPeriod, uint64_t timestampMask, std::vector<GpuZoneTiming> &timings) {
+    std::vector<GpuZoneTiming> resolved;
+    resolved.reserve(m_zones.size());
+
+    for (uint32_t i = 0; i < m_zones.size(); i++){
+        const Zone& zone = m_zones[i];
+        if (!zone.ended){
+            continue;
+        }
+
+        uint64_t timestamps[2];
+        VkResult result = vkGetQueryPoolResults(m_device, m_timestampPool, i * 2, 2, sizeof(timestamps), timestamps,
+                                                sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+        if (result == VK_NOT_READY){
+            return false;
+        }
+
+        GpuZoneTiming timing;
+        timing.name = zone.name;
+        timing.depth = zone.depth;
+        timing.milliseconds = static_cast<float>(((timestamps[1] - timestamps[0]) & timestampMask) * timestampPeriod / 1000000.0);
+
+        if (zone.statistics){
+            uint64_t statistics[PIPELINE_STATISTICS_COUNT];
+            result = vkGetQueryPoolResults(m_device, m_statisticsPool, i, 1, sizeof(statistics), statistics,
+                                           sizeof(statistics), VK_QUERY_RESULT_64_BIT);
+            if (result == VK_NOT_READY){
+                return false;
+            }
+            timing.hasStatistics = true;
+            timing.statistics.inputAssemblyVertices = statistics[0];
+            timing.statistics.vertexShaderInvocations = statistics[1];
+            timing.statistics.clippingPrimitives = statistics[2];
+            timing.statistics.fragmentShaderInvocations = statistics[3];
+            timing.statistics.computeShaderInvocations = statistics[4];
+        }
+        resolved.emplace_back(std::move(timing));
+    }
+    timings = std::move(resolved);
+    return true;
+}
+
+void VulkanGpuQueryPool::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_zones.clear();
+}
+
+VkDevice VulkanGpuProfiler::s_device = VK_NULL_HANDLE;
+bool VulkanGpuProfiler::s_enabled = false;
+bool VulkanGpuProfiler::s_pipelineStatistics = false;
+bool VulkanGpuProfiler::s_computeTimestamps = false;
+bool VulkanGpuProfiler::s_computeStatistics = false;
+float VulkanGpuProfiler::s_timestampPeriod = 1.0f;
+uint64_t VulkanGpuProfiler::s_timestampMask = ~0ull;
+std::vector<std::unique_ptr<VulkanGpuQueryPool>> VulkanGpuProfiler::s_frames;
+uint32_t VulkanGpuProfiler::s_currentFrame = 0;
+std::vector<GpuZoneTiming> VulkanGpuProfiler::s_frameTimings;
+std::vector<GpuZoneTiming> VulkanGpuProfiler::s_externalTimings;
+std::vector<GpuZoneTiming> VulkanGpuProfiler::s_timings;
+
+void VulkanGpuProfiler::init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex,
+                             uint32_t computeQueueFamilyIndex, uint32_t frameCount, bool pipelineStatistics) {
+    EG_TRACE("eagle","Initializing vulkan gpu profiler!");
+    s_device = device;
+    s_currentFrame = 0;
+
+    VkPhysicalDeviceProperties properties;
+    VK_CALL vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    uint32_t queueFamilyCount = 0;
+    VK_CALL vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    VK_CALL vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+    uint32_t timestampValidBits = queueFamilies[queueFamilyIndex].timestampValidBits;
+    s_computeTimestamps = queueFamilies[computeQueueFamilyIndex].timestampValidBits > 0;
+    //the statistics include graphics stages, which a compute only queue can't query
+    s_computeStatistics = queueFamilies[computeQueueFamilyIndex].queueFlags & VK_QUEUE_GRAPHICS_BIT;
+
+    s_enabled = properties.limits.timestampComputeAndGraphics && timestampValidBits > 0;
+    if (!s_enabled){
+        EG_WARNING("eagle", "Timestamp queries are not supported, gpu zones will not be profiled");
+        return;
+    }
+    s_pipelineStatistics = pipelineStatistics;
+    s_timestampPeriod = properties.limits.timestampPeriod;
+    s_timestampMask = timestampValidBits >= 64 ? ~0ull : (1ull << timestampValidBits) - 1;
+
+    s_frames.resize(frameCount);
+    for (auto& frame : s_frames){
+        frame = std::make_unique<VulkanGpuQueryPool>(s_device, MAX_ZONES_PER_FRAME, s_pipelineStatistics);
+    }
+}
+
+void VulkanGpuProfiler::destroy() {
+    EG_TRACE("eagle","Destroying vulkan gpu profiler!");
+    s_frames.clear();
+    s_frameTimings.clear();
+    s_externalTimings.clear();
+    s_timings.clear();
+    s_enabled = false;
+    s_device = VK_NULL_HANDLE;
+}
+
+void VulkanGpuProfiler::begin_frame(uint32_t frameIndex) {
+    if (!s_enabled){
+        return;
+    }
+    s_currentFrame = frameIndex;
+    VulkanGpuQueryPool& frame = *s_frames[frameIndex];
+    if (frame.zone_count() == 0){
+        return;
+    }
+    if (frame.resolve(s_timestampPeriod, s_timestampMask, s_frameTimings)){
+        s_timings = s_frameTimings;
+        s_timings.insert(s_timings.end(), s_externalTimings.begin(), s_externalTimings.end());
+    }
+    frame.clear();
+}
+
+VkCommandBuffer VulkanGpuProfiler::reset_command_buffer() {
+    if (!s_enabled || s_frames[s_currentFrame]->zone_count() == 0){
+        return VK_NULL_HANDLE;
+    }
+    VkCommandBuffer commandBuffer = VulkanFrameCommandPool::acquire(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VK_CALL vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    s_frames[s_currentFrame]->record_reset(commandBuffer, s_frames[s_currentFrame]->zone_count());
+    VK_CALL vkEndCommandBuffer(commandBuffer);
+    return commandBuffer;
+}
+
+uint32_t VulkanGpuProfiler::begin_zone(VkCommandBuffer commandBuffer, const std::string &name, uint32_t depth, bool statistics) {
+    if (!s_enabled){
+        return VulkanGpuQueryPool::INVALID_ZONE;
+    }
+    return s_frames[s_currentFrame]->begin_zone(commandBuffer, name, depth, statistics);
+}
+
+void VulkanGpuProfiler::end_zone(VkCommandBuffer commandBuffer, uint32_t zone) {
+    if (!s_enabled){
+        return;
+    }
+    s_frames[s_currentFrame]->end_zone(commandBuffer, zone);
+}
+
+std::unique_ptr<VulkanGpuQueryPool> VulkanGpuProfiler::create_compute_query_pool(uint32_t zoneCapacity) {
+    if (!s_enabled || !s_computeTimestamps){
+        return nullptr;
+    }
+    return std::make_unique<VulkanGpuQueryPool>(s_device, zoneCapacity, s_pipelineStatistics && s_computeStatistics);
+}
+
+void VulkanGpuProfiler::resolve_query_pool(VulkanGpuQueryPool &queryPool) {
+    if (queryPool.zone_count() == 0){
+        return;
+    }
+    std::vector<GpuZoneTiming> resolved;
+    bool ready = queryPool.resolve(s_timestampPeriod, s_timestampMask, resolved);
+    queryPool.clear();
+    if (!ready){
+        return;
+    }
+
+    //keeps the latest result of every zone name
+    for (auto& timing : resolved){
+        auto it = std::find_if(s_externalTimings.begin(), s_externalTimings.end(), [&timing](const GpuZoneTiming& other){
+            return other.name == timing.name;
+        });
+        if (it != s_externalTimings.end()){
+            *it = std::move(timing);
+        }
+        else {
+            s_externalTimings.emplace_back(std::move(timing));
+        }
+    }
+}
+
+}
@@ -0,0 +1,99 @@
+#ifndef EAGLE_VULKANGPUPROFILER_H
+#define EAGLE_VULKANGPUPROFILER_H
+
+#include <eagle/renderer/gpu_zone.h>
+#include "vulkan_global_definitions.h"
+
+#include <memory>
+#include <mutex>
+
+namespace eagle {
+
+//Timestamp and pipeline statistics queries for a set of zones. Zones are allocated thread safely, so secondary
+//command buffers recorded in parallel can open zones in the same pool.
+class VulkanGpuQueryPool {
+public:
+    static constexpr uint32_t INVALID_ZONE = UINT32_MAX;
+
+    VulkanGpuQueryPool(VkDevice device, uint32_t zoneCapacity, bool pipelineStatistics);
+    ~VulkanGpuQueryPool();
+
+    //resets the first zoneCount zones, must be recorded outside a render pass and submitted before the zones
+    void record_reset(VkCommandBuffer commandBuffer, uint32_t zoneCount);
+
+    //returns INVALID_ZONE once the pool is full, ending an invalid zone does nothing
+    uint32_t begin_zone(VkCommandBuffer commandBuffer, const std::string& name, uint32_t depth, bool statistics);
+    void end_zone(VkCommandBuffer commandBuffer, uint32_t zone);
+
+    //never waits, returns false without touching timings if the GPU hasn't written every result yet
+    bool resolve(float timestampPeriod, uint64_t timestampMask, std::vector<GpuZoneTiming>& timings);
+
+    //forgets the zones, the next begin_zone starts from the first query again
+    void clear();
+
+    inline uint32_t zone_count() const { return static_cast<uint32_t>(m_zones.size()); }
+
+private:
+    struct Zone {
+        std::string name;
+        uint32_t depth = 0;
+        bool statistics = false;
+        bool ended = false;
+    };
+
+private:
+    VkDevice m_device;
+    VkQueryPool m_timestampPool = VK_NULL_HANDLE;
+    VkQueryPool m_statisticsPool = VK_NULL_HANDLE;
+    uint32_t m_capacity;
+    std::vector<Zone> m_zones;
+    std::mutex m_mutex;
+};
+
+//GPU zones of the frame, one query pool per frame in flight.
+//A frame's results are read back when its slot begins again, once its fence has signaled, so reading them never
+//stalls. The queries a frame used are reset by a small command buffer submitted ahead of the frame's commands.
+class VulkanGpuProfiler {
+public:
+    static constexpr uint32_t MAX_ZONES_PER_FRAME = 256;
+
+    static void init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex,
+                     uint32_t computeQueueFamilyIndex, uint32_t frameCount, bool pipelineStatistics);
+    static void destroy();
+
+    //called once the frame's fence has signaled, publishes the results of the last frame recorded in the slot
+    static void begin_frame(uint32_t frameIndex);
+
+    //VK_NULL_HANDLE if the frame has no zones, otherwise has to be submitted before the frame's command buffers
+    static VkCommandBuffer reset_command_buffer();
+
+    static uint32_t begin_zone(VkCommandBuffer commandBuffer, const std::string& name, uint32_t depth, bool statistics);
+    static void end_zone(VkCommandBuffer commandBuffer, uint32_t zone);
+
+    //for compute dispatches, which have their own submission. nullptr if the compute queue can't write timestamps
+    static std::unique_ptr<VulkanGpuQueryPool> create_compute_query_pool(uint32_t zoneCapacity);
+    static void resolve_query_pool(VulkanGpuQueryPool& queryPool);
+
+    //the last resolved frame followed by the last resolved zones of every other query pool
+    static inline const std::vector<GpuZoneTiming>& timings() { return s_timings; }
+
+    static inline bool enabled() { return s_enabled; }
+
+private:
+    static VkDevice s_device;
+    static bool s_enabled;
+    static bool s_pipelineStatistics;
+    static bool s_computeTimestamps;
+    static bool s_computeStatistics;
+    static float s_timestampPeriod;
+    static uint64_t s_timestampMask;
+    static std::vector<std::unique_ptr<VulkanGpuQueryPool>> s_frames;
+    static uint32_t s_currentFrame;
+    static std::vector<GpuZoneTiming> s_frameTimings;
+    static std::vector<GpuZoneTiming> s_externalTimings;
+    static std::vector<GpuZoneTiming> s_timings;
+};
+
+}
+
+#endif //EAGLE_VULKANGPUPROFILER_H
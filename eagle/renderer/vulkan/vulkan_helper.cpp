@@ -4,6 +4,7 @@
 
 
 #include "vulkan_helper.h"
+#include "vulkan_uploader.h"
 
 namespace eagle {
 
@@ -26,6 +27,10 @@ void VulkanHelper::create_image_view(VkDevice device, VkImage image, VkImageView
 uint32_t
 VulkanHelper::find_memory_type(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties) {
 
+    if (VulkanMemoryAllocator::initialized()) {
+        return VulkanMemoryAllocator::find_memory_type(typeFilter, properties);
+    }
+
     VkPhysicalDeviceMemoryProperties memProperties;
     vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
 
@@ -67,8 +72,15 @@ void VulkanHelper::end_single_time_commnds(
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
 
-    vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphicsQueue);
+    //waits only for this submission instead of idling the whole queue
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence;
+    vkCreateFence(device, &fenceInfo, nullptr, &fence);
+
+    vkQueueSubmit(graphicsQueue, 1, &submitInfo, fence);
+    vkWaitForFences(device, 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+    vkDestroyFence(device, fence, nullptr);
 
     vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
 }
@@ -77,7 +89,7 @@ void
 VulkanHelper::create_image(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t width, uint32_t height,
                            uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImageTiling tiling,
                            VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage &image,
-                           VkDeviceMemory &imageMemory, VkImageCreateFlags flags) {
+                           VulkanMemoryAllocation &imageMemory, VkImageCreateFlags flags) {
 
     VkImageCreateInfo imageInfo = {};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -102,16 +114,10 @@ VulkanHelper::create_image(VkPhysicalDevice physicalDevice, VkDevice device, uin
     VkMemoryRequirements memRequirements;
     vkGetImageMemoryRequirements(device, image, &memRequirements);
 
-    VkMemoryAllocateInfo allocInfo = {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = find_memory_type(physicalDevice, memRequirements.memoryTypeBits, properties);
-
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate image memory!");
-    }
+    imageMemory = VulkanMemoryAllocator::allocate(memRequirements, properties,
+                                                  tiling == VK_IMAGE_TILING_OPTIMAL ? VulkanResourceKind::OPTIMAL : VulkanResourceKind::LINEAR);
 
-    vkBindImageMemory(device, image, imageMemory, 0);
+    vkBindImageMemory(device, image, imageMemory.memory, imageMemory.offset);
 }
 
 void
@@ -120,7 +126,15 @@ VulkanHelper::transition_image_layout(VkDevice device, VkCommandPool commandPool
                                       VkImageSubresourceRange subresourceRange, VkPipelineStageFlags srcStage,
                                       VkPipelineStageFlags dstStage) {
     VkCommandBuffer commandBuffer = begin_single_time_commands(device, commandPool);
+    record_image_layout_transition(commandBuffer, image, oldLayout, newLayout, subresourceRange, srcStage, dstStage);
+    end_single_time_commnds(device, commandPool, commandBuffer, graphicsQueue);
+}
 
+void
+VulkanHelper::record_image_layout_transition(VkCommandBuffer commandBuffer, VkImage image,
+                                             VkImageLayout oldLayout, VkImageLayout newLayout,
+                                             VkImageSubresourceRange subresourceRange, VkPipelineStageFlags srcStage,
+                                             VkPipelineStageFlags dstStage) {
     VkImageMemoryBarrier barrier = {};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.oldLayout = oldLayout;
@@ -229,13 +243,11 @@ VulkanHelper::transition_image_layout(VkDevice device, VkCommandPool commandPool
             0, nullptr,
             1, &barrier
     );
-
-    end_single_time_commnds(device, commandPool, commandBuffer, graphicsQueue);
 }
 
 void
 VulkanHelper::create_image_sampler(VkDevice device, VkSampler &sampler, VkSamplerAddressMode wrapMode,
-                                   VkFilter filter) {
+                                   VkFilter filter, float maxLod) {
     VkSamplerCreateInfo samplerInfo = {};
     samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
     samplerInfo.magFilter = filter;
@@ -252,7 +264,7 @@ VulkanHelper::create_image_sampler(VkDevice device, VkSampler &sampler, VkSample
     samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
     samplerInfo.mipLodBias = 0.0f;
     samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 1;
+    samplerInfo.maxLod = maxLod;
 
     if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
         throw std::runtime_error("failed to create texture sampler!");
@@ -289,19 +301,6 @@ void VulkanHelper::create_baked_buffer(VkPhysicalDevice physicalDevice, VkDevice
     }
 
     VulkanBufferCreateInfo createBufferInfo = {};
-    createBufferInfo.memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-    createBufferInfo.usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-
-    std::shared_ptr<VulkanBuffer> stagingBuffer;
-    VK_CALL
-    VulkanBuffer::create_buffer(physicalDevice,
-                                device,
-                                stagingBuffer,
-                                createBufferInfo,
-                                size,
-                                data);
-
-
     createBufferInfo.memoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
     createBufferInfo.usageFlags = VK_BUFFER_USAGE_TRANSFER_DST_BIT | bufferUsage;
 
@@ -313,17 +312,9 @@ void VulkanHelper::create_baked_buffer(VkPhysicalDevice physicalDevice, VkDevice
                                 size
     );
 
-    VK_CALL
-    VulkanBuffer::copy_buffer(
-            device,
-            commandPool,
-            queue,
-            stagingBuffer->native_buffer(),
-            buffer->native_buffer(),
-            size,
-            0);
-
-    stagingBuffer->destroy();
+    if (data != nullptr){
+        buffer->set_ready_token(VulkanUploader::upload_buffer(buffer->native_buffer(), data, size));
+    }
 }
 
 void VulkanHelper::create_dynamic_buffer(VkPhysicalDevice physicalDevice, VkDevice device,
@@ -349,36 +340,9 @@ void VulkanHelper::create_dynamic_buffer(VkPhysicalDevice physicalDevice, VkDevi
 void VulkanHelper::upload_baked_buffer(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue,
                                        VkCommandPool commandPool, std::shared_ptr<VulkanBuffer>& buffer,
                                        VkDeviceSize size, void* data) {
-    if (buffer){
-        buffer->unmap();
-        buffer->destroy();
-    }
-
-    VulkanBufferCreateInfo createBufferInfo = {};
-    createBufferInfo.memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-    createBufferInfo.usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-
-    std::shared_ptr<VulkanBuffer> stagingBuffer;
-    VK_CALL
-    VulkanBuffer::create_buffer(physicalDevice,
-                                device,
-                                stagingBuffer,
-                                createBufferInfo,
-                                size,
-                                data);
-
-
-    VK_CALL
-    VulkanBuffer::copy_buffer(
-            device,
-            commandPool,
-            queue,
-            stagingBuffer->native_buffer(),
-            buffer->native_buffer(),
-            size,
-            0);
-
-    stagingBuffer->destroy();
+    //the buffer may already be in use by the graphics queue, so updates are never moved to the transfer queue
+    VulkanUploader::wait(buffer->ready_token());
+    VulkanUploader::upload_buffer(buffer->native_buffer(), data, size, 0, false);
 }
 
 void VulkanHelper::upload_dynamic_buffer(std::shared_ptr<VulkanBuffer>& buffer, VkDeviceSize size, void* data) {
@@ -23,7 +23,7 @@ public:
     find_memory_type(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
 
     static void
-    create_image_sampler(VkDevice device, VkSampler &sampler, VkSamplerAddressMode wrapMode, VkFilter filter);
+    create_image_sampler(VkDevice device, VkSampler &sampler, VkSamplerAddressMode wrapMode, VkFilter filter, float maxLod = 1.0f);
 
     static VkCommandBuffer
     begin_single_time_commands(VkDevice device, VkCommandPool commandPool);
@@ -35,7 +35,7 @@ public:
     create_image(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t width, uint32_t height,
                  uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImageTiling tiling,
                  VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage &image,
-                 VkDeviceMemory &imageMemory, VkImageCreateFlags flags = 0);
+                 VulkanMemoryAllocation &imageMemory, VkImageCreateFlags flags = 0);
 
     static void
     transition_image_layout(VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue, VkImage image,
@@ -44,6 +44,13 @@ public:
                             VkPipelineStageFlags srcStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
                             VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
 
+    static void
+    record_image_layout_transition(VkCommandBuffer commandBuffer, VkImage image,
+                                   VkImageLayout oldLayout, VkImageLayout newLayout,
+                                   VkImageSubresourceRange subresourceRange,
+                                   VkPipelineStageFlags srcStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                   VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
     static VkFormat find_supported_format(VkPhysicalDevice physicalDevice, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
     static VkFormat find_depth_format(VkPhysicalDevice physicalDevice);
 
@@ -6,9 +6,19 @@
 #include <eagle/renderer/vulkan/vulkan_converter.h>
 #include <eagle/renderer/vulkan/vulkan_helper.h>
 #include <eagle/renderer/vulkan/vulkan_buffer.h>
+#include <eagle/renderer/vulkan/vulkan_uploader.h>
+#include <eagle/renderer/vulkan/vulkan_deletion_queue.h>
+
+#include <algorithm>
 
 namespace eagle {
 
+VulkanAliasedMemory::~VulkanAliasedMemory() {
+    for (auto& allocation : allocations){
+        VulkanMemoryAllocator::free(allocation);
+    }
+}
+
 VulkanImage::VulkanImage(const ImageCreateInfo &imageCreateInfo, const VulkanImageCreateInfo &nativeCreateInfo) :
     Image(imageCreateInfo),
     m_nativeCreateInfo(nativeCreateInfo) {
@@ -17,6 +27,20 @@ VulkanImage::VulkanImage(const ImageCreateInfo &imageCreateInfo, const VulkanIma
     EG_TRACE("eagle","Vulkan image created!");
 }
 
+VulkanImage::VulkanImage(const ImageCreateInfo &imageCreateInfo, const VulkanImageCreateInfo &nativeCreateInfo, bool deferMemory) :
+    Image(imageCreateInfo),
+    m_nativeCreateInfo(nativeCreateInfo) {
+    if (!deferMemory){
+        EG_TRACE("eagle","Creating a vulkan image!");
+        create();
+        EG_TRACE("eagle","Vulkan image created!");
+        return;
+    }
+    EG_TRACE("eagle","Creating a vulkan image without memory!");
+    create_images();
+    EG_TRACE("eagle","Vulkan image created without memory!");
+}
+
 VulkanImage::VulkanImage(const ImageCreateInfo &imageCreateInfo, const VulkanImageCreateInfo& nativeCreateInfo, std::vector<VkImage> images) :
         Image(imageCreateInfo),
         m_nativeCreateInfo(nativeCreateInfo),
@@ -64,6 +88,38 @@ void VulkanImage::on_resize() {
 
 void VulkanImage::create() {
     EG_TRACE("eagle","Creating a vulkan image!");
+    create_images();
+
+    VkMemoryRequirements memRequirements = memory_requirements();
+    VkMemoryPropertyFlags memoryProperties = VulkanConverter::to_vk_flags<VkMemoryPropertyFlags>(m_createInfo.memoryProperties);
+    VulkanResourceKind resourceKind = m_createInfo.tiling == ImageTiling::OPTIMAL ? VulkanResourceKind::OPTIMAL : VulkanResourceKind::LINEAR;
+
+    m_allocations.resize(m_images.size());
+    for (int i = 0; i < m_allocations.size(); i++) {
+        m_allocations[i] = VulkanMemoryAllocator::allocate(memRequirements, memoryProperties, resourceKind);
+        VK_CALL vkBindImageMemory(m_nativeCreateInfo.device, m_images[i], m_allocations[i].memory, m_allocations[i].offset);
+    }
+
+    create_views();
+    EG_TRACE("eagle","Vulkan image created!");
+}
+
+VkMemoryRequirements VulkanImage::memory_requirements() const {
+    VkMemoryRequirements memRequirements;
+    VK_CALL vkGetImageMemoryRequirements(m_nativeCreateInfo.device, m_images[0], &memRequirements);
+    return memRequirements;
+}
+
+void VulkanImage::bind_aliased_memory(const std::shared_ptr<VulkanAliasedMemory> &memory, VkDeviceSize offset) {
+    m_aliasedMemory = memory;
+    for (size_t i = 0; i < m_images.size(); i++){
+        VK_CALL vkBindImageMemory(m_nativeCreateInfo.device, m_images[i], memory->allocations[i].memory,
+                                  memory->allocations[i].offset + offset);
+    }
+    create_views();
+}
+
+void VulkanImage::create_images() {
     VkImageCreateInfo imageInfo = {};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
@@ -88,44 +144,39 @@ void VulkanImage::create() {
     }
 
     m_descriptorType = imageInfo.usage & VK_IMAGE_USAGE_STORAGE_BIT ? DescriptorType::STORAGE_IMAGE : DescriptorType::SAMPLED_IMAGE;
+}
 
-
-    VkMemoryRequirements memRequirements;
-    VK_CALL vkGetImageMemoryRequirements(m_nativeCreateInfo.device, m_images[0], &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo = {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = VulkanHelper::find_memory_type(
-            m_nativeCreateInfo.physicalDevice,
-            memRequirements.memoryTypeBits,
-            VulkanConverter::to_vk_flags<VkMemoryPropertyFlags>(m_createInfo.memoryProperties)
-    );
-
-    m_memories.resize(m_images.size());
-    for (int i = 0; i < m_memories.size(); i++) {
-        VK_CALL_ASSERT(vkAllocateMemory(m_nativeCreateInfo.device, &allocInfo, nullptr, &m_memories[i])) {
-            throw std::runtime_error("failed to allocate image memory!");
-        }
-        VK_CALL vkBindImageMemory(m_nativeCreateInfo.device, m_images[i], m_memories[i], 0);
-    }
-
+void VulkanImage::create_views() {
     VkImageSubresourceRange subresourceRange = {};
     subresourceRange.layerCount = 1;
     subresourceRange.baseArrayLayer = 0;
     subresourceRange.baseMipLevel = 0;
-    subresourceRange.levelCount = 1;
+    subresourceRange.levelCount = m_createInfo.mipLevels;
     subresourceRange.aspectMask = VulkanConverter::to_vk_flags<VkImageAspectFlags>(m_createInfo.aspects);
 
-    m_views.resize(m_memories.size());
+    //the buffer data is staged once and copied into every image, uploads are submitted with the next frame
+    VulkanStagingRegion stagingRegion = {};
+    std::vector<VkBufferImageCopy> regions;
+    if (!m_createInfo.bufferData.empty()) {
+        regions = level_copy_regions(subresourceRange.aspectMask);
+        stagingRegion = VulkanUploader::stage(m_createInfo.bufferData.data(), m_createInfo.bufferData.size());
+    }
+
+    m_readyToken = 0;
+    m_views.resize(m_images.size());
     for (int i = 0; i < m_views.size(); i++) {
         if (!m_createInfo.bufferData.empty()) {
-            copy_buffer_data_to_image(subresourceRange, i);
-        } else {
-            VK_CALL VulkanHelper::transition_image_layout(
-                    m_nativeCreateInfo.device,
-                    m_nativeCreateInfo.commandPool,
-                    m_nativeCreateInfo.graphicsQueue,
+            m_readyToken = VulkanUploader::copy_buffer_to_image(
+                    stagingRegion,
+                    m_images[i],
+                    regions,
+                    subresourceRange,
+                    VulkanConverter::to_vk(m_createInfo.layout)
+            );
+        } else if (m_createInfo.layout != ImageLayout::UNDEFINED) {
+            //images left undefined are transitioned by their first user. for aliased images a transition here could
+            //discard the contents of another image still using the memory
+            VulkanUploader::transition_image_layout(
                     m_images[i],
                     VK_IMAGE_LAYOUT_UNDEFINED,
                     VulkanConverter::to_vk(m_createInfo.layout),
@@ -142,114 +193,65 @@ void VulkanImage::create() {
                 subresourceRange
         );
     }
-    EG_TRACE("eagle","Vulkan image created!");
 }
 
-void VulkanImage::copy_buffer_data_to_image(VkImageSubresourceRange subresourceRange, uint32_t index) {
-    EG_TRACE("eagle","Copying buffer to image!");
-    std::shared_ptr<VulkanBuffer> stagingBuffer;
-
-    VulkanBufferCreateInfo bufferInfo = {};
-    bufferInfo.memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-    bufferInfo.usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-
-    VK_CALL VulkanBuffer::create_buffer(
-            m_nativeCreateInfo.physicalDevice,
-            m_nativeCreateInfo.device,
-            stagingBuffer,
-            bufferInfo,
-            m_createInfo.bufferData.size(),
-            m_createInfo.bufferData.data()
-    );
-
-
-    VK_CALL VulkanHelper::transition_image_layout(
-            m_nativeCreateInfo.device,
-            m_nativeCreateInfo.commandPool,
-            m_nativeCreateInfo.graphicsQueue,
-            m_images[index],
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            subresourceRange,
-            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-            VK_PIPELINE_STAGE_TRANSFER_BIT
-    );
-
-    VkCommandBuffer commandBuffer = VulkanHelper::begin_single_time_commands(m_nativeCreateInfo.device,
-                                                                             m_nativeCreateInfo.commandPool);
-
-    VkBufferImageCopy region = {};
-    region.bufferOffset = 0;
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
-
-    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
-
-    region.imageOffset = {0, 0, 0};
-    region.imageExtent = {
-            (uint32_t)m_createInfo.width,
-            (uint32_t)m_createInfo.height,
-            1
-    };
-
-    VK_CALL vkCmdCopyBufferToImage(
-            commandBuffer,
-            stagingBuffer->native_buffer(),
-            m_images[index],
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            1,
-            &region
-    );
-
-    VK_CALL VulkanHelper::end_single_time_commnds(
-            m_nativeCreateInfo.device,
-            m_nativeCreateInfo.commandPool,
-            commandBuffer,
-            m_nativeCreateInfo.graphicsQueue
-    );
-
-    VK_CALL VulkanHelper::transition_image_layout(
-            m_nativeCreateInfo.device,
-            m_nativeCreateInfo.commandPool,
-            m_nativeCreateInfo.graphicsQueue,
-            m_images[index],
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VulkanConverter::to_vk(m_createInfo.layout),
-            subresourceRange,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,
-            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
-    );
-
-    stagingBuffer->destroy();
-    EG_TRACE("eagle","Buffer copied to image!");
+std::vector<VkBufferImageCopy> VulkanImage::level_copy_regions(VkImageAspectFlags aspectMask) const {
+    //levels are tightly packed one after the other, level 0 first
+    std::vector<VkBufferImageCopy> regions(m_createInfo.mipLevels);
+    VkDeviceSize offset = 0;
+    for (uint32_t level = 0; level < m_createInfo.mipLevels; level++){
+        uint32_t width = std::max(static_cast<uint32_t>(m_createInfo.width) >> level, 1u);
+        uint32_t height = std::max(static_cast<uint32_t>(m_createInfo.height) >> level, 1u);
+
+        VkBufferImageCopy& region = regions[level];
+        region = {};
+        region.bufferOffset = offset;
+        region.imageSubresource.aspectMask = aspectMask;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {width, height, 1};
+        offset += image_level_size(m_createInfo.format, width, height);
+    }
+
+    if (m_createInfo.mipLevels > 1 && offset > m_createInfo.bufferData.size()){
+        throw std::runtime_error("image buffer data is smaller than its mip chain!");
+    }
+    return regions;
 }
 
 void VulkanImage::clear() {
     EG_TRACE("eagle","Clearing a vulkan image!");
-    for (auto& view : m_views){
-        if (view){
-            VK_CALL vkDestroyImageView(m_nativeCreateInfo.device, view, nullptr);
-        }
-    }
-
+    //frames still in flight may sample or render to the image, e.g. when it is cleared to be resized
+    std::vector<VkImage> images;
+    std::vector<VulkanMemoryAllocation> allocations;
     if (!m_createdFromExternalImage) {
-        for (auto& memory : m_memories){
-            if (memory){
-                VK_CALL vkFreeMemory(m_nativeCreateInfo.device, memory, nullptr);
+        images = std::move(m_images);
+        allocations = std::move(m_allocations);
+    }
+    VulkanDeletionQueue::push([device = m_nativeCreateInfo.device, views = std::move(m_views), images = std::move(images),
+                               allocations = std::move(allocations), aliasedMemory = std::move(m_aliasedMemory)]() mutable {
+        for (auto& view : views){
+            if (view){
+                VK_CALL vkDestroyImageView(device, view, nullptr);
             }
         }
 
-        for (auto& image : m_images){
+        for (auto& image : images){
             if (image){
-                VK_CALL vkDestroyImage(m_nativeCreateInfo.device, image, nullptr);
+                VK_CALL vkDestroyImage(device, image, nullptr);
             }
         }
-    }
+
+        for (auto& allocation : allocations){
+            VulkanMemoryAllocator::free(allocation);
+        }
+        //shared memory goes with its last image
+        aliasedMemory.reset();
+    });
     m_views.clear();
-    m_memories.clear();
+    m_allocations.clear();
     m_images.clear();
     EG_TRACE("eagle","Vulkan image cleared!");
 }
@@ -258,4 +260,8 @@ DescriptorType VulkanImage::type() const {
     return m_descriptorType;
 }
 
+bool VulkanImage::is_ready() const {
+    return VulkanUploader::is_ready(m_readyToken);
+}
+
 }
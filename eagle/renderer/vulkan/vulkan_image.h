@@ -8,6 +8,7 @@
 #include "eagle/renderer/image.h"
 
 #include "vulkan_global_definitions.h"
+#include "vulkan_memory_allocator.h"
 #include <vector>
 
 namespace eagle {
@@ -20,40 +21,58 @@ struct VulkanImageCreateInfo {
     uint32_t imageCount;
 };
 
+//memory shared by the images of VulkanContext::create_aliased_images, one allocation per swapchain image.
+//freed once the last image bound to it is destroyed
+struct VulkanAliasedMemory {
+    std::vector<VulkanMemoryAllocation> allocations;
+    ~VulkanAliasedMemory();
+};
+
 
 class VulkanImage : public Image {
 public:
     VulkanImage(const ImageCreateInfo& imageCreateInfo, const VulkanImageCreateInfo& nativeCreateInfo);
 
+    //deferMemory creates the images without memory, bind_aliased_memory binds them and creates their views
+    VulkanImage(const ImageCreateInfo& imageCreateInfo, const VulkanImageCreateInfo& nativeCreateInfo, bool deferMemory);
+
     //Used for swapchain images
     VulkanImage(const ImageCreateInfo& imageCreateInfo, const VulkanImageCreateInfo& nativeCreateInfo, std::vector<VkImage> images);
     virtual ~VulkanImage();
     virtual DescriptorType type() const override;
+    virtual bool is_ready() const override;
 
     inline std::vector<VkImage>& native_images() { return m_images; }
-    inline std::vector<VkDeviceMemory>& native_memories() { return m_memories; }
+    inline std::vector<VulkanMemoryAllocation>& native_allocations() { return m_allocations; }
     inline std::vector<VkImageView>& native_image_views() { return m_views; }
 
     inline const std::vector<VkImage>& native_images() const  { return m_images; }
-    inline const std::vector<VkDeviceMemory>& native_memories() const  { return m_memories; }
+    inline const std::vector<VulkanMemoryAllocation>& native_allocations() const  { return m_allocations; }
     inline const std::vector<VkImageView>& native_image_views() const  { return m_views; }
 
+    VkMemoryRequirements memory_requirements() const;
+    //binds image i at offset in the memory's allocation i
+    void bind_aliased_memory(const std::shared_ptr<VulkanAliasedMemory>& memory, VkDeviceSize offset);
+
 protected:
     virtual void on_resize() override;
 
-    void copy_buffer_data_to_image(VkImageSubresourceRange subresourceRange, uint32_t index);
-
 private:
     void create();
+    void create_images();
+    void create_views();
     void clear();
+    std::vector<VkBufferImageCopy> level_copy_regions(VkImageAspectFlags aspectMask) const;
 
 private:
     VulkanImageCreateInfo m_nativeCreateInfo;
     std::vector<VkImage> m_images;
-    std::vector<VkDeviceMemory> m_memories;
+    std::vector<VulkanMemoryAllocation> m_allocations;
     std::vector<VkImageView> m_views;
+    std::shared_ptr<VulkanAliasedMemory> m_aliasedMemory;     //null unless the image shares its memory
     bool m_createdFromExternalImage = false;
     DescriptorType m_descriptorType;
+    uint64_t m_readyToken = 0;
 };
 
 
@@ -36,6 +36,15 @@ bool VulkanIndexBuffer::is_dirty() const {
     return !m_dirtyBuffers.empty();
 }
 
+bool VulkanIndexBuffer::is_ready() const {
+    for (auto& buffer : m_buffers){
+        if (buffer && !buffer->is_ready()){
+            return false;
+        }
+    }
+    return true;
+}
+
 void VulkanIndexBuffer::flush(uint32_t bufferIndex) {
 
     VkDeviceSize bufferSize = m_size;
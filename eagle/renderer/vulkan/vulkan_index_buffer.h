@@ -32,6 +32,7 @@ public:
     void flush(uint32_t bufferIndex) override;
 
     void upload() override;
+    bool is_ready() const override;
     inline VulkanBuffer& native_buffer(uint32_t bufferIndex) {
         return *(m_buffers[bufferIndex]);
     }
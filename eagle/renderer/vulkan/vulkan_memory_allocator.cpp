@@ -0,0 +1,268 @@
+#include <eagle/renderer/vulkan/vulkan_memory_allocator.h>
+#include <eagle/log.h>
+
+namespace eagle {
+
+namespace {
+
+constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+constexpr VkDeviceSize MIN_BLOCK_SIZE = 1ull * 1024 * 1024;
+
+uint32_t floor_log2(VkDeviceSize value) {
+    uint32_t result = 0;
+    while (value >>= 1){
+        result++;
+    }
+    return result;
+}
+
+uint32_t ceil_log2(VkDeviceSize value) {
+    uint32_t result = floor_log2(value);
+    return (VkDeviceSize(1) << result) < value ? result + 1 : result;
+}
+
+}
+
+VkPhysicalDevice VulkanMemoryAllocator::s_physicalDevice = VK_NULL_HANDLE;
+VkDevice VulkanMemoryAllocator::s_device = VK_NULL_HANDLE;
+VkPhysicalDeviceMemoryProperties VulkanMemoryAllocator::s_memoryProperties = {};
+VkDeviceSize VulkanMemoryAllocator::s_nonCoherentAtomSize = 1;
+std::vector<std::unique_ptr<VulkanMemoryBlock>> VulkanMemoryAllocator::s_blocks;
+size_t VulkanMemoryAllocator::s_dedicatedAllocationCount = 0;
+VkDeviceSize VulkanMemoryAllocator::s_dedicatedBytes = 0;
+std::mutex VulkanMemoryAllocator::s_mutex;
+
+VulkanMemoryBlock::VulkanMemoryBlock(VkDevice device, uint32_t memoryTypeIndex, VulkanResourceKind kind,
+                                     VkDeviceSize size, bool hostVisible) :
+    m_device(device),
+    m_memoryTypeIndex(memoryTypeIndex),
+    m_kind(kind),
+    m_size(size),
+    m_maxOrder(floor_log2(size)) {
+    assert((size & (size - 1)) == 0 && "Memory block size must be a power of 2");
+
+    VkMemoryAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+    VK_CALL_ASSERT(vkAllocateMemory(m_device, &allocInfo, nullptr, &m_memory)) {
+        throw std::runtime_error("failed to allocate device memory block!");
+    }
+
+    if (hostVisible){
+        VK_CALL_ASSERT(vkMapMemory(m_device, m_memory, 0, VK_WHOLE_SIZE, 0, &m_mapped)) {
+            throw std::runtime_error("failed to map device memory block!");
+        }
+    }
+
+    m_freeLists.resize(m_maxOrder - MIN_ORDER + 1);
+    m_freeLists.back().insert(0);
+}
+
+VulkanMemoryBlock::~VulkanMemoryBlock() {
+    if (m_memory){
+        VK_CALL vkFreeMemory(m_device, m_memory, nullptr);
+    }
+}
+
+bool VulkanMemoryBlock::allocate(VkDeviceSize size, VkDeviceSize alignment, VulkanMemoryAllocation &allocation) {
+    //buddy nodes are aligned to their own size, so any power of 2 alignment up to the node size comes for free
+    uint32_t order = std::max(MIN_ORDER, ceil_log2(std::max(size, alignment)));
+    if (order > m_maxOrder){
+        return false;
+    }
+
+    uint32_t freeOrder = order;
+    while (freeOrder <= m_maxOrder && m_freeLists[freeOrder - MIN_ORDER].empty()){
+        freeOrder++;
+    }
+    if (freeOrder > m_maxOrder){
+        return false;
+    }
+
+    auto& freeList = m_freeLists[freeOrder - MIN_ORDER];
+    VkDeviceSize offset = *freeList.begin();
+    freeList.erase(freeList.begin());
+
+    //splits the node until it matches the requested order, the upper halves go back to the free lists
+    while (freeOrder > order){
+        freeOrder--;
+        m_freeLists[freeOrder - MIN_ORDER].insert(offset + (VkDeviceSize(1) << freeOrder));
+    }
+
+    m_usedBytes += VkDeviceSize(1) << order;
+    m_allocationCount++;
+
+    allocation.memory = m_memory;
+    allocation.offset = offset;
+    allocation.size = size;
+    allocation.mapped = m_mapped ? static_cast<uint8_t*>(m_mapped) + offset : nullptr;
+    allocation.memoryTypeIndex = m_memoryTypeIndex;
+    allocation.block = this;
+    allocation.order = order;
+    return true;
+}
+
+void VulkanMemoryBlock::free(const VulkanMemoryAllocation &allocation) {
+    assert(allocation.block == this);
+    VkDeviceSize offset = allocation.offset;
+    uint32_t order = allocation.order;
+    m_usedBytes -= VkDeviceSize(1) << order;
+    m_allocationCount--;
+
+    //merges with the buddy while it is free
+    while (order < m_maxOrder){
+        auto& freeList = m_freeLists[order - MIN_ORDER];
+        auto buddy = freeList.find(offset ^ (VkDeviceSize(1) << order));
+        if (buddy == freeList.end()){
+            break;
+        }
+        offset = std::min(offset, *buddy);
+        freeList.erase(buddy);
+        order++;
+    }
+    m_freeLists[order - MIN_ORDER].insert(offset);
+}
+
+void VulkanMemoryAllocator::init(VkPhysicalDevice physicalDevice, VkDevice device) {
+    EG_TRACE("eagle","Initializing vulkan memory allocator!");
+    s_physicalDevice = physicalDevice;
+    s_device = device;
+    VK_CALL vkGetPhysicalDeviceMemoryProperties(physicalDevice, &s_memoryProperties);
+
+    VkPhysicalDeviceProperties properties;
+    VK_CALL vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    s_nonCoherentAtomSize = std::max<VkDeviceSize>(properties.limits.nonCoherentAtomSize, 1);
+    EG_TRACE("eagle","Vulkan memory allocator initialized!");
+}
+
+void VulkanMemoryAllocator::destroy() {
+    EG_TRACE("eagle","Destroying vulkan memory allocator!");
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (s_dedicatedAllocationCount > 0){
+        EG_WARNING("eagle", "Destroying vulkan memory allocator with {0} dedicated allocations still alive", s_dedicatedAllocationCount);
+    }
+    s_blocks.clear();
+    s_dedicatedAllocationCount = 0;
+    s_dedicatedBytes = 0;
+    s_device = VK_NULL_HANDLE;
+    s_physicalDevice = VK_NULL_HANDLE;
+}
+
+uint32_t VulkanMemoryAllocator::find_memory_type(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
+    for (uint32_t i = 0; i < s_memoryProperties.memoryTypeCount; i++) {
+        if ((typeFilter & (1 << i)) && (s_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+VkDeviceSize VulkanMemoryAllocator::block_size_for(uint32_t memoryTypeIndex) {
+    //small heaps (e.g. the 256MB host visible device local heap) get smaller blocks
+    VkDeviceSize heapSize = s_memoryProperties.memoryHeaps[s_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+    VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE;
+    while (blockSize > MIN_BLOCK_SIZE && blockSize > heapSize / 8){
+        blockSize >>= 1;
+    }
+    return blockSize;
+}
+
+VulkanMemoryAllocation VulkanMemoryAllocator::allocate(const VkMemoryRequirements &requirements,
+                                                       VkMemoryPropertyFlags properties,
+                                                       VulkanResourceKind kind) {
+    assert(initialized() && "VulkanMemoryAllocator used before init");
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    uint32_t memoryTypeIndex = find_memory_type(requirements.memoryTypeBits, properties);
+    bool hostVisible = s_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+    VkDeviceSize blockSize = block_size_for(memoryTypeIndex);
+
+    VulkanMemoryAllocation allocation = {};
+
+    if (requirements.size > blockSize / 2){
+        EG_TRACE("eagle","Creating a dedicated allocation of {0} bytes", requirements.size);
+        VkMemoryAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = requirements.size;
+        allocInfo.memoryTypeIndex = memoryTypeIndex;
+        VK_CALL_ASSERT(vkAllocateMemory(s_device, &allocInfo, nullptr, &allocation.memory)) {
+            throw std::runtime_error("failed to allocate device memory!");
+        }
+        if (hostVisible){
+            VK_CALL_ASSERT(vkMapMemory(s_device, allocation.memory, 0, VK_WHOLE_SIZE, 0, &allocation.mapped)) {
+                throw std::runtime_error("failed to map device memory!");
+            }
+        }
+        allocation.size = requirements.size;
+        allocation.memoryTypeIndex = memoryTypeIndex;
+        s_dedicatedAllocationCount++;
+        s_dedicatedBytes += requirements.size;
+        return allocation;
+    }
+
+    for (auto& block : s_blocks){
+        if (block->memory_type_index() == memoryTypeIndex && block->kind() == kind &&
+            block->allocate(requirements.size, requirements.alignment, allocation)){
+            return allocation;
+        }
+    }
+
+    EG_TRACE("eagle","Creating a new memory block of {0} bytes for memory type {1}", blockSize, memoryTypeIndex);
+    s_blocks.emplace_back(std::make_unique<VulkanMemoryBlock>(s_device, memoryTypeIndex, kind, blockSize, hostVisible));
+    if (!s_blocks.back()->allocate(requirements.size, requirements.alignment, allocation)){
+        throw std::runtime_error("failed to sub-allocate device memory!");
+    }
+    return allocation;
+}
+
+void VulkanMemoryAllocator::free(VulkanMemoryAllocation &allocation) {
+    if (!allocation.valid() || !initialized()){
+        allocation = {};
+        return;
+    }
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    if (!allocation.block){
+        VK_CALL vkFreeMemory(s_device, allocation.memory, nullptr);
+        s_dedicatedAllocationCount--;
+        s_dedicatedBytes -= allocation.size;
+        allocation = {};
+        return;
+    }
+
+    VulkanMemoryBlock* block = allocation.block;
+    block->free(allocation);
+    allocation = {};
+
+    //keeps at most one empty block per memory type and kind around to avoid reallocating on swapchain recreation
+    if (block->empty()){
+        auto spare = std::find_if(s_blocks.begin(), s_blocks.end(), [block](const std::unique_ptr<VulkanMemoryBlock>& other){
+            return other.get() != block && other->empty() &&
+                   other->memory_type_index() == block->memory_type_index() && other->kind() == block->kind();
+        });
+        if (spare != s_blocks.end()){
+            s_blocks.erase(std::find_if(s_blocks.begin(), s_blocks.end(), [block](const std::unique_ptr<VulkanMemoryBlock>& other){
+                return other.get() == block;
+            }));
+        }
+    }
+}
+
+VulkanMemoryAllocatorStats VulkanMemoryAllocator::stats() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    VulkanMemoryAllocatorStats stats = {};
+    stats.blockCount = s_blocks.size();
+    stats.dedicatedAllocationCount = s_dedicatedAllocationCount;
+    stats.allocationCount = s_dedicatedAllocationCount;
+    stats.reservedBytes = s_dedicatedBytes;
+    stats.usedBytes = s_dedicatedBytes;
+    for (auto& block : s_blocks){
+        stats.reservedBytes += block->size();
+        stats.usedBytes += block->used_bytes();
+        stats.allocationCount += block->allocation_count();
+    }
+    return stats;
+}
+
+}
@@ -0,0 +1,104 @@
+#ifndef EAGLE_VULKANMEMORYALLOCATOR_H
+#define EAGLE_VULKANMEMORYALLOCATOR_H
+
+#include "vulkan_global_definitions.h"
+
+namespace eagle {
+
+class VulkanMemoryBlock;
+
+//linear resources (buffers, linear images) and optimal images are never placed in the same block,
+//so bufferImageGranularity never has to be accounted for between neighbouring allocations
+enum class VulkanResourceKind {
+    LINEAR,
+    OPTIMAL
+};
+
+struct VulkanMemoryAllocation {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    void* mapped = nullptr;         //points at offset when the memory is host visible
+    uint32_t memoryTypeIndex = 0;
+
+    VulkanMemoryBlock* block = nullptr;  //null for dedicated allocations
+    uint32_t order = 0;
+
+    inline bool valid() const { return memory != VK_NULL_HANDLE; }
+};
+
+struct VulkanMemoryAllocatorStats {
+    size_t blockCount = 0;
+    size_t dedicatedAllocationCount = 0;
+    size_t allocationCount = 0;
+    VkDeviceSize reservedBytes = 0;
+    VkDeviceSize usedBytes = 0;
+};
+
+//buddy allocator over large VkDeviceMemory blocks, one list of blocks per memory type and resource kind
+class VulkanMemoryBlock {
+public:
+    VulkanMemoryBlock(VkDevice device, uint32_t memoryTypeIndex, VulkanResourceKind kind,
+                      VkDeviceSize size, bool hostVisible);
+    ~VulkanMemoryBlock();
+
+    bool allocate(VkDeviceSize size, VkDeviceSize alignment, VulkanMemoryAllocation& allocation);
+    void free(const VulkanMemoryAllocation& allocation);
+
+    inline bool empty() const { return m_usedBytes == 0; }
+    inline VkDeviceSize size() const { return m_size; }
+    inline VkDeviceSize used_bytes() const { return m_usedBytes; }
+    inline size_t allocation_count() const { return m_allocationCount; }
+    inline uint32_t memory_type_index() const { return m_memoryTypeIndex; }
+    inline VulkanResourceKind kind() const { return m_kind; }
+
+    static constexpr uint32_t MIN_ORDER = 8;   //256 bytes
+
+private:
+    VkDevice m_device;
+    VkDeviceMemory m_memory = VK_NULL_HANDLE;
+    uint32_t m_memoryTypeIndex;
+    VulkanResourceKind m_kind;
+    VkDeviceSize m_size;
+    uint32_t m_maxOrder;
+    void* m_mapped = nullptr;
+    VkDeviceSize m_usedBytes = 0;
+    size_t m_allocationCount = 0;
+    std::vector<std::set<VkDeviceSize>> m_freeLists; //indexed by order - MIN_ORDER
+};
+
+class VulkanMemoryAllocator {
+public:
+    static void init(VkPhysicalDevice physicalDevice, VkDevice device);
+    static void destroy();
+
+    static VulkanMemoryAllocation allocate(const VkMemoryRequirements& requirements,
+                                           VkMemoryPropertyFlags properties,
+                                           VulkanResourceKind kind);
+    static void free(VulkanMemoryAllocation& allocation);
+
+    static uint32_t find_memory_type(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+
+    static inline const VkPhysicalDeviceMemoryProperties& memory_properties() { return s_memoryProperties; }
+    static inline VkDeviceSize non_coherent_atom_size() { return s_nonCoherentAtomSize; }
+    static inline bool initialized() { return s_device != VK_NULL_HANDLE; }
+
+    static VulkanMemoryAllocatorStats stats();
+
+private:
+    static VkDeviceSize block_size_for(uint32_t memoryTypeIndex);
+
+private:
+    static VkPhysicalDevice s_physicalDevice;
+    static VkDevice s_device;
+    static VkPhysicalDeviceMemoryProperties s_memoryProperties;
+    static VkDeviceSize s_nonCoherentAtomSize;
+    static std::vector<std::unique_ptr<VulkanMemoryBlock>> s_blocks;
+    static size_t s_dedicatedAllocationCount;
+    static VkDeviceSize s_dedicatedBytes;
+    static std::mutex s_mutex;
+};
+
+}
+
+#endif //EAGLE_VULKANMEMORYALLOCATOR_H
@@ -0,0 +1,144 @@
+#include <eagle/renderer/vulkan/vulkan_parallel_recorder.h>
+#include <eagle/worker_pool.h>
+#include <eagle/log.h>
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+namespace eagle {
+
+VulkanParallelRecorder::VulkanParallelRecorder(const VulkanParallelRecorderCreateInfo &createInfo) :
+    m_createInfo(createInfo) {
+
+}
+
+VulkanParallelRecorder::~VulkanParallelRecorder() {
+    cleanup();
+}
+
+const std::vector<std::shared_ptr<CommandBuffer>> &
+VulkanParallelRecorder::record(const std::shared_ptr<RenderPass> &renderPass, const std::shared_ptr<Framebuffer> &framebuffer,
+                               uint32_t taskCount, const RecordTask &recordTask) {
+
+    //slots are created before any task starts, tasks only ever touch their own slot
+    if (m_slots.size() < taskCount){
+        size_t first = m_slots.size();
+        m_slots.resize(taskCount);
+        for (size_t i = first; i < m_slots.size(); i++){
+            create_slot(m_slots[i]);
+        }
+    }
+
+    m_recorded.resize(taskCount);
+    for (uint32_t i = 0; i < taskCount; i++){
+        m_recorded[i] = m_slots[i].commandBuffer;
+    }
+
+    if (taskCount == 0){
+        return m_recorded;
+    }
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    uint32_t remaining = taskCount - 1;
+    std::exception_ptr error;
+
+    for (uint32_t i = 0; i + 1 < taskCount; i++){
+        m_createInfo.workerPool->submit([&, i]{
+            std::exception_ptr taskError;
+            try {
+                record_slot(i, renderPass, framebuffer, recordTask);
+            }
+            catch (...) {
+                taskError = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (taskError && !error){
+                error = taskError;
+            }
+            if (--remaining == 0){
+                finished.notify_one();
+            }
+        });
+    }
+
+    //the caller records the last task instead of idling
+    std::exception_ptr callerError;
+    try {
+        record_slot(taskCount - 1, renderPass, framebuffer, recordTask);
+    }
+    catch (...) {
+        callerError = std::current_exception();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&remaining]{ return remaining == 0; });
+
+    if (callerError){
+        std::rethrow_exception(callerError);
+    }
+    if (error){
+        std::rethrow_exception(error);
+    }
+    return m_recorded;
+}
+
+void VulkanParallelRecorder::record_slot(uint32_t taskIndex, const std::shared_ptr<RenderPass> &renderPass,
+                                         const std::shared_ptr<Framebuffer> &framebuffer, const RecordTask &recordTask) {
+    Slot& slot = m_slots[taskIndex];
+
+    //the image's previous frame has finished (see VulkanContext::prepare_frame), so its commands can be recycled at once
+    VK_CALL vkResetCommandPool(m_createInfo.device, slot.commandPools[*m_createInfo.currentImageIndex], 0);
+
+    slot.commandBuffer->begin(renderPass, framebuffer);
+    recordTask(*slot.commandBuffer, taskIndex);
+    slot.commandBuffer->end();
+}
+
+void VulkanParallelRecorder::create_slot(Slot &slot) {
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = m_createInfo.queueFamilyIndex;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    slot.commandPools.resize(m_createInfo.imageCount);
+    for (auto& commandPool : slot.commandPools){
+        VK_CALL_ASSERT(vkCreateCommandPool(m_createInfo.device, &poolInfo, nullptr, &commandPool)) {
+            throw std::runtime_error("failed to create parallel recording command pool!");
+        }
+    }
+
+    CommandBufferCreateInfo createInfo = {};
+    createInfo.level = CommandBufferLevel::SECONDARY;
+
+    VulkanCommandBufferCreateInfo vkCreateInfo = {};
+    vkCreateInfo.device = m_createInfo.device;
+    vkCreateInfo.commandPools = slot.commandPools;
+    vkCreateInfo.imageCount = m_createInfo.imageCount;
+    vkCreateInfo.currentImageIndex = m_createInfo.currentImageIndex;
+    slot.commandBuffer = std::make_shared<VulkanCommandBuffer>(createInfo, vkCreateInfo);
+}
+
+void VulkanParallelRecorder::destroy_slot(Slot &slot) {
+    slot.commandBuffer.reset();
+    for (auto& commandPool : slot.commandPools){
+        VK_CALL vkDestroyCommandPool(m_createInfo.device, commandPool, nullptr);
+    }
+    slot.commandPools.clear();
+}
+
+void VulkanParallelRecorder::cleanup() {
+    m_recorded.clear();
+    for (auto& slot : m_slots){
+        destroy_slot(slot);
+    }
+    m_slots.clear();
+}
+
+void VulkanParallelRecorder::recreate(uint32_t imageCount) {
+    //slots are created again on the next record
+    m_createInfo.imageCount = imageCount;
+}
+
+}
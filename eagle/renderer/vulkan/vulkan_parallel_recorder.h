@@ -0,0 +1,59 @@
+#ifndef EAGLE_VULKANPARALLELRECORDER_H
+#define EAGLE_VULKANPARALLELRECORDER_H
+
+#include "vulkan_global_definitions.h"
+#include "vulkan_command_buffer.h"
+
+#include <functional>
+
+namespace eagle {
+
+class WorkerPool;
+
+struct VulkanParallelRecorderCreateInfo {
+    VkDevice device;
+    uint32_t queueFamilyIndex;
+    uint32_t imageCount;
+    uint32_t* currentImageIndex = nullptr;
+    WorkerPool* workerPool = nullptr;
+};
+
+//Records secondary command buffers for a render pass from several threads at once.
+//Each task slot owns one command pool per swapchain image, so a pool is never touched by two threads
+//and the whole slot is recycled with a single vkResetCommandPool when its image comes around again.
+class VulkanParallelRecorder {
+public:
+    using RecordTask = std::function<void(CommandBuffer& commandBuffer, uint32_t taskIndex)>;
+
+    explicit VulkanParallelRecorder(const VulkanParallelRecorderCreateInfo& createInfo);
+    ~VulkanParallelRecorder();
+
+    //blocks until every task recorded its command buffer, the calling thread records one of them.
+    //The first exception thrown by a task is rethrown once all of them finished
+    const std::vector<std::shared_ptr<CommandBuffer>>& record(const std::shared_ptr<RenderPass>& renderPass,
+                                                             const std::shared_ptr<Framebuffer>& framebuffer,
+                                                             uint32_t taskCount, const RecordTask& recordTask);
+
+    void cleanup();
+    void recreate(uint32_t imageCount);
+
+private:
+    struct Slot {
+        std::vector<VkCommandPool> commandPools;    //one per image
+        std::shared_ptr<VulkanCommandBuffer> commandBuffer;
+    };
+
+    void create_slot(Slot& slot);
+    void destroy_slot(Slot& slot);
+    void record_slot(uint32_t taskIndex, const std::shared_ptr<RenderPass>& renderPass,
+                     const std::shared_ptr<Framebuffer>& framebuffer, const RecordTask& recordTask);
+
+private:
+    VulkanParallelRecorderCreateInfo m_createInfo;
+    std::vector<Slot> m_slots;
+    std::vector<std::shared_ptr<CommandBuffer>> m_recorded;
+};
+
+}
+
+#endif //EAGLE_VULKANPARALLELRECORDER_H
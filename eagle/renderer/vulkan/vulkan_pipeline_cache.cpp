@@ -0,0 +1,165 @@
+#include <eagle/renderer/vulkan/vulkan_pipeline_cache.h>
+#include <eagle/log.h>
+#include <eagle/hash.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace eagle {
+
+VulkanPipelineCache::VulkanPipelineCache(const VulkanPipelineCacheCreateInfo &createInfo) :
+    m_createInfo(createInfo) {
+    EG_TRACE("eagle","Creating vulkan pipeline cache!");
+    VK_CALL vkGetPhysicalDeviceProperties(m_createInfo.physicalDevice, &m_properties);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<uint8_t> initialData = load_initial_data();
+
+    VkPipelineCacheCreateInfo cacheInfo = {};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = initialData.size();
+    cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+    VkResult result = vkCreatePipelineCache(m_createInfo.device, &cacheInfo, nullptr, &m_cache);
+    if (result != VK_SUCCESS && !initialData.empty()){
+        EG_WARNING("eagle", "Driver rejected pipeline cache data from {0}, starting with an empty cache", m_createInfo.path);
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData = nullptr;
+        m_loadedFromDisk = false;
+        result = vkCreatePipelineCache(m_createInfo.device, &cacheInfo, nullptr, &m_cache);
+    }
+    VK_CALL_ASSERT(result) {
+        throw std::runtime_error("failed to create pipeline cache!");
+    }
+
+    auto elapsed = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    EG_INFO("eagle", "Pipeline cache {0} in {1}ms ({2} bytes)",
+            m_loadedFromDisk ? "loaded" : "created empty", elapsed, initialData.size());
+}
+
+VulkanPipelineCache::~VulkanPipelineCache() {
+    EG_TRACE("eagle","Destroying vulkan pipeline cache!");
+    VK_CALL vkDestroyPipelineCache(m_createInfo.device, m_cache, nullptr);
+}
+
+std::vector<uint8_t> VulkanPipelineCache::load_initial_data() {
+    std::ifstream file(m_createInfo.path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()){
+        EG_TRACE("eagle", "No pipeline cache found at {0}", m_createInfo.path);
+        return {};
+    }
+
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    if (fileSize < sizeof(FileHeader)){
+        EG_WARNING("eagle", "Pipeline cache {0} is truncated, ignoring it", m_createInfo.path);
+        return {};
+    }
+    file.seekg(0);
+
+    FileHeader header = {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(FileHeader));
+    if (header.dataSize != fileSize - sizeof(FileHeader)){
+        EG_WARNING("eagle", "Pipeline cache {0} size does not match its header, ignoring it", m_createInfo.path);
+        return {};
+    }
+
+    std::vector<uint8_t> data(header.dataSize);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+    if (!file || !validate(header, data)){
+        return {};
+    }
+
+    m_loadedFromDisk = true;
+    return data;
+}
+
+bool VulkanPipelineCache::validate(const FileHeader &header, const std::vector<uint8_t> &data) const {
+    if (header.magic != FILE_MAGIC || header.version != FILE_VERSION){
+        EG_WARNING("eagle", "Pipeline cache {0} has an unknown format, ignoring it", m_createInfo.path);
+        return false;
+    }
+
+    if (header.vendorID != m_properties.vendorID ||
+        header.deviceID != m_properties.deviceID ||
+        header.driverVersion != m_properties.driverVersion ||
+        memcmp(header.pipelineCacheUUID, m_properties.pipelineCacheUUID, VK_UUID_SIZE) != 0){
+        EG_INFO("eagle", "Pipeline cache {0} was written by a different device or driver, ignoring it", m_createInfo.path);
+        return false;
+    }
+
+    if (header.checksum != fnv1a(data.data(), data.size())){
+        EG_WARNING("eagle", "Pipeline cache {0} is corrupted, ignoring it", m_createInfo.path);
+        return false;
+    }
+
+    //the driver blob carries its own header, some drivers do not validate it themselves
+    struct DriverHeader {
+        uint32_t headerSize;
+        uint32_t headerVersion;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+    } driverHeader = {};
+    if (data.size() < sizeof(DriverHeader)){
+        return false;
+    }
+    memcpy(&driverHeader, data.data(), sizeof(DriverHeader));
+    return driverHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           driverHeader.vendorID == m_properties.vendorID &&
+           driverHeader.deviceID == m_properties.deviceID &&
+           memcmp(driverHeader.pipelineCacheUUID, m_properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+bool VulkanPipelineCache::save() {
+    size_t dataSize = 0;
+    VK_CALL_ASSERT(vkGetPipelineCacheData(m_createInfo.device, m_cache, &dataSize, nullptr)) {
+        EG_WARNING("eagle", "Failed to query pipeline cache size");
+        return false;
+    }
+
+    std::vector<uint8_t> data(dataSize);
+    VK_CALL_ASSERT(vkGetPipelineCacheData(m_createInfo.device, m_cache, &dataSize, data.data())) {
+        EG_WARNING("eagle", "Failed to read pipeline cache data");
+        return false;
+    }
+    data.resize(dataSize);
+
+    FileHeader header = {};
+    header.magic = FILE_MAGIC;
+    header.version = FILE_VERSION;
+    header.vendorID = m_properties.vendorID;
+    header.deviceID = m_properties.deviceID;
+    header.driverVersion = m_properties.driverVersion;
+    memcpy(header.pipelineCacheUUID, m_properties.pipelineCacheUUID, VK_UUID_SIZE);
+    header.dataSize = data.size();
+    header.checksum = fnv1a(data.data(), data.size());
+
+    //written to a temporary file first so a crash while saving never leaves a half written cache behind
+    std::string tempPath = m_createInfo.path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()){
+            EG_WARNING("eagle", "Failed to open {0} for writing", tempPath);
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        if (!file){
+            EG_WARNING("eagle", "Failed to write pipeline cache to {0}", tempPath);
+            return false;
+        }
+    }
+
+    std::remove(m_createInfo.path.c_str());
+    if (std::rename(tempPath.c_str(), m_createInfo.path.c_str()) != 0){
+        EG_WARNING("eagle", "Failed to move pipeline cache to {0}", m_createInfo.path);
+        return false;
+    }
+
+    EG_TRACE("eagle", "Pipeline cache saved to {0} ({1} bytes)", m_createInfo.path, data.size());
+    return true;
+}
+
+}
@@ -0,0 +1,55 @@
+#ifndef EAGLE_VULKANPIPELINECACHE_H
+#define EAGLE_VULKANPIPELINECACHE_H
+
+#include "vulkan_global_definitions.h"
+
+namespace eagle {
+
+struct VulkanPipelineCacheCreateInfo {
+    VkPhysicalDevice physicalDevice;
+    VkDevice device;
+    std::string path;
+};
+
+//Context wide pipeline cache persisted between runs.
+//The driver blob is wrapped in a versioned header keyed by the device UUID and driver version,
+//a file written by another device, driver or engine version is discarded instead of handed to the driver.
+class VulkanPipelineCache {
+public:
+    static constexpr uint32_t FILE_MAGIC = 0x43504745; //"EGPC"
+    static constexpr uint32_t FILE_VERSION = 1;
+
+    explicit VulkanPipelineCache(const VulkanPipelineCacheCreateInfo& createInfo);
+    ~VulkanPipelineCache();
+
+    //writes the current cache contents to disk, returns false on failure
+    bool save();
+
+    inline VkPipelineCache native_cache() const { return m_cache; }
+    inline bool loaded_from_disk() const { return m_loadedFromDisk; }
+
+private:
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+        uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+        uint64_t dataSize;
+        uint64_t checksum;
+    };
+
+    std::vector<uint8_t> load_initial_data();
+    bool validate(const FileHeader& header, const std::vector<uint8_t>& data) const;
+
+private:
+    VulkanPipelineCacheCreateInfo m_createInfo;
+    VkPhysicalDeviceProperties m_properties;
+    VkPipelineCache m_cache = VK_NULL_HANDLE;
+    bool m_loadedFromDisk = false;
+};
+
+}
+
+#endif //EAGLE_VULKANPIPELINECACHE_H
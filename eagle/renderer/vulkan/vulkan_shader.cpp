@@ -3,14 +3,17 @@
 #include <eagle/renderer/vulkan/vulkan_converter.h>
 #include <eagle/renderer/vulkan/vulkan_shader_utils.h>
 #include <eagle/renderer/vulkan/vulkan_render_pass.h>
+#include <eagle/renderer/vulkan/vulkan_deletion_queue.h>
 #include <eagle/file_system.h>
+#include <eagle/worker_pool.h>
 
 namespace eagle {
 
 VulkanShader::VulkanShader(const ShaderCreateInfo &createInfo, const VulkanShaderCreateInfo &nativeCreateInfo) :
         Shader(createInfo),
         m_nativeCreateInfo(nativeCreateInfo),
-        m_cleared(true) {
+        m_cleared(true),
+        m_ready(false) {
 
     for(auto& kv : createInfo.shaderStages){
         ShaderStage stage = kv.first;
@@ -25,11 +28,31 @@ VulkanShader::VulkanShader(const ShaderCreateInfo &createInfo, const VulkanShade
         m_shaderCodes.emplace(VulkanConverter::to_vk(stage), std::move(intCode));
     }
 
-    create_pipeline_layout();
-    create_pipeline();
+    if (!m_nativeCreateInfo.workerPool){
+        create_pipeline_layout();
+        create_pipeline();
+        m_ready = true;
+        return;
+    }
+
+    //reflection, layouts and the pipeline only touch this shader, so they can be built on any thread
+    auto promise = std::make_shared<std::promise<void>>();
+    m_buildResult = promise->get_future().share();
+    m_nativeCreateInfo.workerPool->submit([this, promise]{
+        try {
+            create_pipeline_layout();
+            create_pipeline();
+            m_ready = true;
+            promise->set_value();
+        }
+        catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    });
 }
 
 VulkanShader::~VulkanShader() {
+    wait_for_build();
     cleanup_pipeline();
     VK_CALL vkDestroyPipelineLayout(m_nativeCreateInfo.device, m_pipelineLayout, nullptr);
 
@@ -46,6 +69,8 @@ void VulkanShader::create_pipeline_layout() {
     uint32_t attributeIndex = 0;
     uint32_t bindingIndex = 0;
     for (auto& binding : m_createInfo.vertexLayout){
+        //attribute offsets are relative to their own binding
+        offset = 0;
         for (auto& attribute : binding.attributes){
             m_inputAttributes[attributeIndex].format = VulkanConverter::to_vk(attribute);
             m_inputAttributes[attributeIndex].binding = bindingIndex;
@@ -76,6 +101,8 @@ void VulkanShader::create_pipeline_layout() {
         }
     }
 
+    VulkanShaderUtils::make_uniform_buffers_dynamic(m_createInfo.dynamicUniformBuffers, descriptorSetMap);
+
     for (auto& descriptorSetLayout : descriptorSetMap){
 
         std::vector<DescriptorBindingDescription> descriptions;
@@ -160,12 +187,13 @@ void VulkanShader::create_pipeline() {
     scissor.offset = {static_cast<int32_t>(m_createInfo.viewport.x), static_cast<int32_t>(m_createInfo.viewport.y)};
     scissor.extent = extent;
 
+    //with dynamic states the values are ignored and set by the command buffer when binding
     VkPipelineViewportStateCreateInfo viewportState = {};
     viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     viewportState.viewportCount = 1;
-    viewportState.pViewports = &viewport;
+    viewportState.pViewports = m_createInfo.dynamicStates ? nullptr : &viewport;
     viewportState.scissorCount = 1;
-    viewportState.pScissors = &scissor;
+    viewportState.pScissors = m_createInfo.dynamicStates ? nullptr : &scissor;
 
     VkPipelineRasterizationStateCreateInfo rasterizer = {};
     rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -266,7 +294,7 @@ void VulkanShader::create_pipeline() {
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    VK_CALL_ASSERT(vkCreateGraphicsPipelines(m_nativeCreateInfo.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline)) {
+    VK_CALL_ASSERT(vkCreateGraphicsPipelines(m_nativeCreateInfo.device, m_nativeCreateInfo.pipelineCache, 1, &pipelineInfo, nullptr, &m_graphicsPipeline)) {
         throw std::runtime_error("failed to create graphics pipeline!");
     }
 
@@ -278,21 +306,41 @@ void VulkanShader::create_pipeline() {
     EG_TRACE("eagle","Shader pipeline created!");
 }
 
+void VulkanShader::wait() {
+    if (!m_ready && m_buildResult.valid()){
+        m_buildResult.get();
+    }
+}
+
+void VulkanShader::wait_for_build() {
+    if (m_buildResult.valid()){
+        m_buildResult.wait();
+    }
+}
+
 void VulkanShader::cleanup_pipeline(){
+    wait_for_build();
     if (m_cleared){ return; }
-    VK_CALL vkDestroyPipeline(m_nativeCreateInfo.device, m_graphicsPipeline, nullptr);
+    //frames in flight may still draw with it, e.g. when it is rebuilt for a new swapchain extent
+    VulkanDeletionQueue::push([device = m_nativeCreateInfo.device, pipeline = m_graphicsPipeline]{
+        VK_CALL vkDestroyPipeline(device, pipeline, nullptr);
+    });
+    m_graphicsPipeline = VK_NULL_HANDLE;
     m_cleared = true;
 }
 
 VkPipeline& VulkanShader::get_pipeline() {
+    wait();
     return m_graphicsPipeline;
 }
 
 VkPipelineLayout& VulkanShader::get_layout() {
+    wait();
     return m_pipelineLayout;
 }
 
 const std::vector<std::weak_ptr<DescriptorSetLayout>> VulkanShader::get_descriptor_set_layouts() {
+    wait();
     std::vector<std::weak_ptr<DescriptorSetLayout>> sets(m_descriptorSetLayouts.size());
     for (size_t i = 0; i < sets.size(); i++){
         sets[i] = m_descriptorSetLayouts[i];
@@ -301,6 +349,7 @@ const std::vector<std::weak_ptr<DescriptorSetLayout>> VulkanShader::get_descript
 }
 
 const std::weak_ptr<DescriptorSetLayout> VulkanShader::get_descriptor_set_layout(uint32_t index) {
+    wait();
     return m_descriptorSetLayouts[index];
 }
 
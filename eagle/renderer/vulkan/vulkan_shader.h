@@ -5,11 +5,18 @@
 #include "vulkan_global_definitions.h"
 #include "vulkan_descriptor_set_layout.h"
 
+#include <atomic>
+#include <future>
+
 namespace eagle {
 
+class WorkerPool;
+
 struct VulkanShaderCreateInfo {
     VkDevice device;
+    VkPipelineCache pipelineCache;
     VkExtent2D* pExtent;
+    WorkerPool* workerPool = nullptr;   //the pipeline is built on this pool when set
 };
 
 class VulkanShader : public Shader {
@@ -22,6 +29,11 @@ public:
     void create_pipeline();
     void cleanup_pipeline();
 
+    bool is_ready() const override { return m_ready; }
+
+    //blocks until an async build finished, rethrows its error
+    void wait();
+
     const std::vector<std::weak_ptr<DescriptorSetLayout>> get_descriptor_set_layouts() override;
     const std::weak_ptr<DescriptorSetLayout> get_descriptor_set_layout(uint32_t index) override;
 
@@ -32,12 +44,13 @@ public:
 private:
 
     void create_pipeline_layout();
+    void wait_for_build();
 
 private:
 
     VulkanShaderCreateInfo m_nativeCreateInfo;
-    VkPipelineLayout m_pipelineLayout;
-    VkPipeline m_graphicsPipeline;
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_graphicsPipeline = VK_NULL_HANDLE;
     uint32_t m_outputAttachmentCount = 0;
     std::vector<VkVertexInputBindingDescription> m_inputBindings;
     std::vector<std::shared_ptr<VulkanDescriptorSetLayout>> m_descriptorSetLayouts;
@@ -45,6 +58,8 @@ private:
     std::unordered_map<VkShaderStageFlags, std::vector<uint32_t>> m_shaderCodes;
 
     bool m_cleared;
+    std::atomic<bool> m_ready;
+    std::shared_future<void> m_buildResult;
 
 };
 
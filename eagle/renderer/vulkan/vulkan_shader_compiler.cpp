@@ -5,40 +5,140 @@
 #include "vulkan_shader_compiler.h"
 #include "eagle/log.h"
 
+#if __has_include(<glslang/build_info.h>)
+#include <glslang/build_info.h>
+#endif
+
 #include <iostream>
 #include <eagle/file_system.h>
+#include <eagle/hash.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 
 namespace eagle {
 
-bool VulkanShaderCompiler::m_glslangIntitialized = false;
+std::once_flag VulkanShaderCompiler::s_glslangInitialized;
+std::mutex VulkanShaderCompiler::s_cacheMutex;
+std::string VulkanShaderCompiler::s_cacheDirectory = "shader_cache";
+VulkanShaderCacheStats VulkanShaderCompiler::s_cacheStats;
 
-std::vector<uint32_t> VulkanShaderCompiler::compile_glsl(const std::string &filename, ShaderStage stage) {
+namespace {
 
-    //initializes glslang
-    if (!m_glslangIntitialized) {
-        if (!glslang::InitializeProcess()){
-            throw std::runtime_error("Failed to initialize vulkan shader compiler!");
+//environment definitions, part of the cache key
+const int ClientInputSemanticsVersion = 100; // maps to, say, #define VULKAN 100
+const glslang::EShTargetClientVersion VulkanClientVersion = glslang::EShTargetVulkan_1_0;
+const glslang::EShTargetLanguageVersion TargetVersion = glslang::EShTargetSpv_1_0;
+const int DefaultVersion = 100;
+
+const uint32_t CacheFileMagic = 0x56505345; //"ESPV"
+const uint32_t CacheFileVersion = 1;
+
+struct CacheFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t wordCount;
+    float compileTimeMs;
+};
+
+template<typename T>
+void hash_value(uint64_t& hash, const T& value) {
+    hash = fnv1a(&value, sizeof(T), hash);
+}
+
+}
+
+//resolves #include through FileSystem so shaders can live in pak archives or android assets
+class VulkanShaderCompiler::Includer : public glslang::TShader::Includer {
+public:
+    explicit Includer(const std::string& rootDirectory) : m_rootDirectory(rootDirectory) {}
+
+    IncludeResult* includeLocal(const char* headerName, const char* includerName, size_t inclusionDepth) override {
+        //the root shader is compiled without a name, its includes are relative to its own directory
+        std::string directory = includerName && *includerName ? get_file_path(includerName) : m_rootDirectory;
+        std::string path;
+        auto contents = new std::string();
+        if (!read_include(headerName, directory, m_rootDirectory, path, *contents)){
+            delete contents;
+            return nullptr;
         }
-        m_glslangIntitialized = true;
+        return new IncludeResult(path, contents->data(), contents->size(), contents);
+    }
+
+    IncludeResult* includeSystem(const char* headerName, const char* includerName, size_t inclusionDepth) override {
+        return includeLocal(headerName, includerName, inclusionDepth);
     }
 
+    void releaseInclude(IncludeResult* result) override {
+        if (result){
+            delete static_cast<std::string*>(result->userData);
+            delete result;
+        }
+    }
+
+private:
+    std::string m_rootDirectory;
+};
+
+std::vector<uint32_t> VulkanShaderCompiler::compile_glsl(const std::string &filename, ShaderStage stage) {
+
     EShLanguage shaderStage = get_shader_stage(stage);
+    std::string glslInput = FileSystem::instance()->read_text(filename);
+
+    if (s_cacheDirectory.empty()){
+        return compile(filename, glslInput, shaderStage);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    uint64_t key = cache_key(filename, glslInput, shaderStage);
+
+    std::vector<uint32_t> spirv;
+    float compileTimeMs = 0.0f;
+    if (load_cached(key, spirv, compileTimeMs)){
+        float loadTimeMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        std::lock_guard<std::mutex> lock(s_cacheMutex);
+        s_cacheStats.hits++;
+        s_cacheStats.timeSavedMs += std::max(compileTimeMs - loadTimeMs, 0.0f);
+        EG_TRACE("eagle", "Shader cache hit for {0} ({1:.2f}ms instead of {2:.2f}ms) | hit rate: {3:.1f}% | saved: {4:.1f}ms",
+                 filename, loadTimeMs, compileTimeMs, s_cacheStats.hit_rate() * 100.0f, s_cacheStats.timeSavedMs);
+        return spirv;
+    }
+
+    spirv = compile(filename, glslInput, shaderStage);
+    compileTimeMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    {
+        std::lock_guard<std::mutex> lock(s_cacheMutex);
+        s_cacheStats.misses++;
+        EG_TRACE("eagle", "Shader cache miss for {0}, compiled in {1:.2f}ms | hit rate: {2:.1f}%",
+                 filename, compileTimeMs, s_cacheStats.hit_rate() * 100.0f);
+    }
+
+    if (!spirv.empty()){
+        store_cached(key, spirv, compileTimeMs);
+    }
+    return spirv;
+}
+
+std::vector<uint32_t> VulkanShaderCompiler::compile(const std::string &filename, const std::string &source, EShLanguage shaderStage) {
+
+    //initializes glslang once per process, an exception leaves the flag unset so the next call retries
+    std::call_once(s_glslangInitialized, []{
+        if (!glslang::InitializeProcess()){
+            throw std::runtime_error("Failed to initialize vulkan shader compiler!");
+        }
+    });
 
     //creates shader object based on shader stage
     glslang::TShader shader(shaderStage);
 
 
-    std::string glslInput = FileSystem::instance()->read_text(filename);
-
-    const char* cstrInput = glslInput.data();
+    const char* cstrInput = source.data();
 
     shader.setStrings(&cstrInput, 1);
 
-    //environment definitions
-    int ClientInputSemanticsVersion = 100; // maps to, say, #define VULKAN 100
-    glslang::EShTargetClientVersion VulkanClientVersion = glslang::EShTargetVulkan_1_0;
-    glslang::EShTargetLanguageVersion TargetVersion = glslang::EShTargetSpv_1_0;
-
     shader.setEnvInput(glslang::EShSourceGlsl, shaderStage, glslang::EShClientVulkan, ClientInputSemanticsVersion);
     shader.setEnvClient(glslang::EShClientVulkan, VulkanClientVersion);
     shader.setEnvTarget(glslang::EShTargetSpv, TargetVersion);
@@ -46,14 +146,9 @@ std::vector<uint32_t> VulkanShaderCompiler::compile_glsl(const std::string &file
     TBuiltInResource resources = DefaultTBuiltInResource;
     EShMessages messages = EShMsgDefault;
 
-    const int DefaultVersion = 100;
-
 
     //preprocessing of the glsl shader (includes all get_paths into the actual glsl string)
-    DirStackFileIncluder includer;
-
-    std::string path = get_file_path(filename);
-    includer.pushExternalLocalDirectory(path);
+    Includer includer(get_file_path(filename));
 
     std::string preprocessedGLSL;
 
@@ -89,6 +184,134 @@ std::vector<uint32_t> VulkanShaderCompiler::compile_glsl(const std::string &file
     return spirv;
 }
 
+uint64_t VulkanShaderCompiler::cache_key(const std::string &filename, const std::string &source, EShLanguage shaderStage) {
+    uint64_t hash = FNV1A_OFFSET_BASIS;
+    std::string directory = get_file_path(filename);
+    std::vector<std::string> visited;
+    hash_source(hash, source, directory, directory, visited);
+
+    hash_value(hash, shaderStage);
+    hash_value(hash, ClientInputSemanticsVersion);
+    hash_value(hash, VulkanClientVersion);
+    hash_value(hash, TargetVersion);
+    hash_value(hash, DefaultVersion);
+    hash_value(hash, DefaultTBuiltInResource);
+
+    //a different glslang may emit different spirv for the same source
+#ifdef GLSLANG_VERSION_MAJOR
+    hash_value(hash, GLSLANG_VERSION_MAJOR);
+    hash_value(hash, GLSLANG_VERSION_MINOR);
+    hash_value(hash, GLSLANG_VERSION_PATCH);
+#endif
+    hash_value(hash, glslang::GetSpirvGeneratorVersion());
+    return hash;
+}
+
+void VulkanShaderCompiler::hash_source(uint64_t &hash, const std::string &source, const std::string &directory,
+                                       const std::string &rootDirectory, std::vector<std::string> &visited) {
+    hash = fnv1a(source.data(), source.size(), hash);
+
+    //resolves includes the same way the compiler's Includer does
+    size_t lineStart = 0;
+    while (lineStart < source.size()) {
+        size_t lineEnd = source.find('\n', lineStart);
+        if (lineEnd == std::string::npos){
+            lineEnd = source.size();
+        }
+        size_t directive = source.find_first_not_of(" \t", lineStart);
+        if (directive != std::string::npos && directive < lineEnd && source.compare(directive, 8, "#include") == 0){
+            size_t open = source.find_first_of("\"<", directive + 8);
+            size_t close = open < lineEnd ? source.find_first_of("\">", open + 1) : std::string::npos;
+            if (open < lineEnd && close < lineEnd){
+                std::string path, included;
+                if (read_include(source.substr(open + 1, close - open - 1), directory, rootDirectory, path, included) &&
+                    std::find(visited.begin(), visited.end(), path) == visited.end()){
+                    visited.emplace_back(path);
+                    hash_source(hash, included, get_file_path(path), rootDirectory, visited);
+                }
+            }
+        }
+        lineStart = lineEnd + 1;
+    }
+}
+
+bool VulkanShaderCompiler::read_include(const std::string &name, const std::string &directory,
+                                        const std::string &rootDirectory, std::string &path, std::string &contents) {
+    for (auto& candidateDirectory : {directory, rootDirectory}){
+        path = candidateDirectory + "/" + name;
+        try {
+            contents = FileSystem::instance()->read_text(path);
+            return true;
+        }
+        catch (const std::runtime_error&){
+            //file systems throw when the file doesn't exist, try the next directory
+        }
+    }
+    return false;
+}
+
+std::string VulkanShaderCompiler::cache_file_path(uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.spv", static_cast<unsigned long long>(key));
+    return s_cacheDirectory + "/" + name;
+}
+
+bool VulkanShaderCompiler::load_cached(uint64_t key, std::vector<uint32_t> &spirv, float &compileTimeMs) {
+    std::ifstream file(cache_file_path(key), std::ios::binary);
+    if (!file.is_open()){
+        return false;
+    }
+
+    CacheFileHeader header = {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(CacheFileHeader));
+    if (!file || header.magic != CacheFileMagic || header.version != CacheFileVersion || header.key != key){
+        EG_WARNING("eagle", "Discarding invalid shader cache entry {0}", cache_file_path(key));
+        return false;
+    }
+
+    spirv.resize(header.wordCount);
+    file.read(reinterpret_cast<char*>(spirv.data()), spirv.size() * sizeof(uint32_t));
+    if (!file || spirv.empty() || spirv[0] != spv::MagicNumber){
+        EG_WARNING("eagle", "Discarding truncated shader cache entry {0}", cache_file_path(key));
+        spirv.clear();
+        return false;
+    }
+    compileTimeMs = header.compileTimeMs;
+    return true;
+}
+
+void VulkanShaderCompiler::store_cached(uint64_t key, const std::vector<uint32_t> &spirv, float compileTimeMs) {
+    std::error_code error;
+    std::filesystem::create_directories(s_cacheDirectory, error);
+    if (error){
+        EG_WARNING("eagle", "Failed to create shader cache directory {0}: {1}", s_cacheDirectory, error.message());
+        return;
+    }
+
+    CacheFileHeader header = {};
+    header.magic = CacheFileMagic;
+    header.version = CacheFileVersion;
+    header.key = key;
+    header.wordCount = spirv.size();
+    header.compileTimeMs = compileTimeMs;
+
+    std::string path = cache_file_path(key);
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(CacheFileHeader));
+        file.write(reinterpret_cast<const char*>(spirv.data()), spirv.size() * sizeof(uint32_t));
+        if (!file){
+            EG_WARNING("eagle", "Failed to write shader cache entry {0}", path);
+            return;
+        }
+    }
+    std::filesystem::rename(tempPath, path, error);
+    if (error){
+        EG_WARNING("eagle", "Failed to store shader cache entry {0}: {1}", path, error.message());
+    }
+}
+
 std::string VulkanShaderCompiler::get_file_path(const std::string &file) {
     size_t found = file.find_last_of("/\\");
     return file.substr(0,found);
@@ -7,9 +7,9 @@
 
 #include <glslang/Public/ShaderLang.h>
 #include <SPIRV/GlslangToSpv.h>
-#include <StandAlone/DirStackFileIncluder.h>
 
 #include <vector>
+#include <mutex>
 #include <eagle/renderer/shader.h>
 #include <eagle/renderer/renderer_global_definitions.h>
 #include "vulkan_global_definitions.h"
@@ -123,19 +123,53 @@ const TBuiltInResource DefaultTBuiltInResource = {
                                    /* .generalConstantMatrixVectorIndexing = */ 1,
                            }};
 
+struct VulkanShaderCacheStats {
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    float timeSavedMs = 0.0f;  //compile time recorded with each hit entry minus the time spent loading it
+
+    inline float hit_rate() const { return hits + misses == 0 ? 0.0f : (float)hits / (hits + misses); }
+};
+
 class VulkanShaderCompiler {
 
 public:
+    //compiled spirv is cached on disk, a cache hit never touches glslang
     static std::vector<uint32_t>
     compile_glsl(const std::string &filename, ShaderStage stage);
 
+    //an empty directory disables the cache
+    static inline void set_cache_directory(const std::string& directory) { s_cacheDirectory = directory; }
+    static inline VulkanShaderCacheStats cache_stats() {
+        std::lock_guard<std::mutex> lock(s_cacheMutex);
+        return s_cacheStats;
+    }
+
 private:
+    class Includer;
+
+    static std::vector<uint32_t> compile(const std::string& filename, const std::string& source, EShLanguage shaderStage);
+
+    //hashes the source with every #include resolved, the stage, target environment, resource limits and glslang version
+    static uint64_t cache_key(const std::string& filename, const std::string& source, EShLanguage shaderStage);
+    static void hash_source(uint64_t& hash, const std::string& source, const std::string& directory,
+                            const std::string& rootDirectory, std::vector<std::string>& visited);
+    //includes are looked up in the including file's directory, then in the root shader's, through FileSystem
+    static bool read_include(const std::string& name, const std::string& directory, const std::string& rootDirectory,
+                             std::string& path, std::string& contents);
+    static bool load_cached(uint64_t key, std::vector<uint32_t>& spirv, float& compileTimeMs);
+    static void store_cached(uint64_t key, const std::vector<uint32_t>& spirv, float compileTimeMs);
+    static std::string cache_file_path(uint64_t key);
 
     static std::string get_file_path(const std::string& file);
     static std::string get_suffix(const std::string& file);
     static EShLanguage get_shader_stage(ShaderStage stage);
 
-    static bool m_glslangIntitialized;
+    //glslang's process state is shared, shaders may be compiled from worker threads
+    static std::once_flag s_glslangInitialized;
+    static std::mutex s_cacheMutex;
+    static std::string s_cacheDirectory;
+    static VulkanShaderCacheStats s_cacheStats;
 
 };
 
@@ -6,6 +6,8 @@
 #include <eagle/renderer/vulkan/spirv_reflect.h>
 #include <eagle/renderer/vulkan/vulkan_converter.h>
 
+#include <algorithm>
+
 
 namespace eagle {
 
@@ -168,6 +170,19 @@ void VulkanShaderUtils::add_bindings_from_shader_stage(const std::vector<uint32_
     spvReflectDestroyShaderModule(&shaderReflection);
 }
 
+void VulkanShaderUtils::make_uniform_buffers_dynamic(const std::vector<std::string> &names,
+                                                     std::map<uint32_t, std::map<uint32_t, DescriptorBindingDescription>> &descriptorSetMap) {
+    for (auto& set : descriptorSetMap){
+        for (auto& binding : set.second){
+            DescriptorBindingDescription& description = binding.second;
+            if (description.descriptorType == DescriptorType::UNIFORM_BUFFER &&
+                std::find(names.begin(), names.end(), description.name) != names.end()){
+                description.descriptorType = DescriptorType::UNIFORM_BUFFER_DYNAMIC;
+            }
+        }
+    }
+}
+
 void
 VulkanShaderUtils::enumerate_output_variables(const std::vector<uint32_t> &code, uint32_t &outputVariableCount) {
 
@@ -19,6 +19,10 @@ public:
                                                std::vector<VkPushConstantRange> &pushConstantsRanges);
 
 
+    //switches the uniform buffers with one of the given names to UNIFORM_BUFFER_DYNAMIC
+    static void make_uniform_buffers_dynamic(const std::vector<std::string>& names,
+                                             std::map<uint32_t, std::map<uint32_t, DescriptorBindingDescription>> &descriptorSetMap);
+
     static void enumerate_output_variables(const std::vector<uint32_t>& code, uint32_t& outputVariableCount);
 
     static VkShaderModule create_shader_module(VkDevice device, const std::vector<uint32_t> &code);
@@ -4,6 +4,7 @@
 
 #include <eagle/renderer/vulkan/vulkan_storage_buffer.h>
 #include <eagle/renderer/vulkan/vulkan_cleaner.h>
+#include <eagle/renderer/vulkan/vulkan_uploader.h>
 
 namespace eagle {
 
@@ -32,34 +33,37 @@ void VulkanStorageBuffer::copy_from(void *data, size_t size, size_t offset) {
     assert(m_usage == UpdateType::DYNAMIC);
     assert(size + offset <= m_bytes.size());
     memcpy(m_bytes.data() + offset, data, size);
-    m_dirtyBytes = true;
+    m_pendingRanges.add(offset, offset + size);
 }
 
 void VulkanStorageBuffer::upload() {
-    if (!m_dirtyBytes){
+    if (m_pendingRanges.empty()){
         return;
     }
 
-    m_dirtyBuffers.clear();
-    for (int i = 0; i < m_buffers.size(); i++){
-        m_dirtyBuffers.insert(i);
+    for (size_t i = 0; i < m_buffers.size(); i++){
+        m_dirtyRanges[i].add(m_pendingRanges);
+        m_dirtyMask |= 1u << i;
     }
+    m_pendingRanges.clear();
     VulkanCleaner::push(this);
-    m_dirtyBytes = false;
 }
 
 void VulkanStorageBuffer::create_storage_buffer() {
     EG_TRACE("eagle","Creating vulkan storage buffer impl");
     if (!m_cleared) return;
 
+    assert(m_createInfo.bufferCount <= 32);
     m_buffers.resize(m_createInfo.bufferCount);
+    m_dirtyRanges.resize(m_createInfo.bufferCount);
 
     switch(m_usage) {
         case UpdateType::DYNAMIC: {
 
             VulkanBufferCreateInfo createBufferInfo = {};
             createBufferInfo.memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
-            createBufferInfo.usageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+            //every storage buffer can hold indirect arguments, see CommandBuffer::draw_indirect
+            createBufferInfo.usageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
             for (auto &buffer : m_buffers) {
                 VulkanBuffer::create_buffer(m_createInfo.physicalDevice, m_createInfo.device, buffer, createBufferInfo,
                                             m_bytes.size());
@@ -71,35 +75,18 @@ void VulkanStorageBuffer::create_storage_buffer() {
             break;
         case UpdateType::BAKED: {
             VulkanBufferCreateInfo createBufferInfo = {};
-            createBufferInfo.memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-            createBufferInfo.usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-
-            std::shared_ptr<VulkanBuffer> stagingBuffer;
-            VK_CALL
-            VulkanBuffer::create_buffer(
-                    m_createInfo.physicalDevice, m_createInfo.device, stagingBuffer, createBufferInfo, m_bytes.size(),
-                    m_bytes.data());
-
-
             createBufferInfo.memoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-            createBufferInfo.usageFlags = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+            createBufferInfo.usageFlags = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
 
+            //the bytes are staged once and copied into every per image buffer
+            VulkanStagingRegion stagingRegion = VulkanUploader::stage(m_bytes.data(), m_bytes.size());
             for (int i = 0; i < m_buffers.size(); i++) {
                 VK_CALL
                 VulkanBuffer::create_buffer(m_createInfo.physicalDevice, m_createInfo.device, m_buffers[i],
                                             createBufferInfo, m_bytes.size());
 
-                VK_CALL
-                VulkanBuffer::copy_buffer(
-                        m_createInfo.device,
-                        m_createInfo.commandPool,
-                        m_createInfo.graphicsQueue,
-                        stagingBuffer->native_buffer(),
-                        m_buffers[i]->native_buffer(),
-                        m_bytes.size(),
-                        0);
+                m_buffers[i]->set_ready_token(VulkanUploader::copy_buffer(stagingRegion, m_buffers[i]->native_buffer(), m_bytes.size()));
             }
-            stagingBuffer->destroy();
             break;
         }
     }
@@ -108,15 +95,31 @@ void VulkanStorageBuffer::create_storage_buffer() {
 }
 
 bool VulkanStorageBuffer::is_dirty() const {
-    return !m_dirtyBuffers.empty();
+    return m_dirtyMask != 0;
+}
+
+bool VulkanStorageBuffer::is_ready() const {
+    for (auto& buffer : m_buffers){
+        if (buffer && !buffer->is_ready()){
+            return false;
+        }
+    }
+    return true;
 }
 
 void VulkanStorageBuffer::flush(uint32_t index) {
-    if (!is_dirty()) {
+    uint32_t bufferBit = 1u << index;
+    if (!(m_dirtyMask & bufferBit)) {
         return;
     }
-    m_buffers[index]->copy_to(m_bytes.data(), m_bytes.size());
-    m_dirtyBuffers.erase(index);
+    //the memory isn't host coherent, so every copied range is flushed too
+    auto& buffer = m_buffers[index];
+    for (auto& range : m_dirtyRanges[index].ranges()){
+        buffer->copy_to(m_bytes.data() + range.begin, range.end - range.begin, range.begin);
+        buffer->flush(range.end - range.begin, range.begin);
+    }
+    m_dirtyRanges[index].clear();
+    m_dirtyMask &= ~bufferBit;
 }
 
 void VulkanStorageBuffer::cleanup() {
@@ -125,7 +128,10 @@ void VulkanStorageBuffer::cleanup() {
         m_buffers[i]->unmap();
         m_buffers[i]->destroy();
     }
-    m_dirtyBuffers.clear();
+    for (auto& ranges : m_dirtyRanges){
+        ranges.clear();
+    }
+    m_dirtyMask = 0;
     m_cleared = true;
 }
 
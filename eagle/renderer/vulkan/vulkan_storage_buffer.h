@@ -26,6 +26,7 @@ public:
     virtual ~VulkanStorageBuffer();
     virtual void copy_from(void *data, size_t size, size_t offset) override;
     virtual void upload() override;
+    virtual bool is_ready() const override;
 
     DescriptorType type() const override;
 
@@ -41,9 +42,12 @@ private:
     VulkanStorageBufferCreateInfo m_createInfo;
 
     std::vector<std::shared_ptr<VulkanBuffer>> m_buffers;
-    std::set<int> m_dirtyBuffers;
+    //written by copy_from since the last upload
+    VulkanDirtyRanges m_pendingRanges;
+    //uploaded but not yet flushed to each per image buffer, bit i set while buffer i has dirty ranges
+    std::vector<VulkanDirtyRanges> m_dirtyRanges;
+    uint32_t m_dirtyMask = 0;
     bool m_cleared = true;
-    bool m_dirtyBytes = false;
 
 };
 
@@ -5,6 +5,10 @@
 #include <eagle/renderer/vulkan/vulkan_converter.h>
 #include "vulkan_texture.h"
 #include "vulkan_helper.h"
+#include "vulkan_descriptor_set.h"
+#include "vulkan_deletion_queue.h"
+
+#include <algorithm>
 
 namespace eagle {
 
@@ -26,8 +30,22 @@ VulkanTexture::VulkanTexture(const TextureCreateInfo &textureCreateInfo,
     EG_TRACE("eagle","Vulkan texture constructed!");
 }
 
+VulkanTexture::VulkanTexture(const StreamingTextureCreateInfo &streamingCreateInfo,
+                             const VulkanTextureCreateInfo &nativeCreateInfo) :
+    Texture(TextureCreateInfo{ImageCreateInfo{}, streamingCreateInfo.filter}),
+    m_nativeCreateInfo(nativeCreateInfo) {
+    EG_TRACE("eagle","Constructing a streamed vulkan texture!");
+    m_stream = VulkanTextureStreamer::create_stream(this, streamingCreateInfo.path);
+    m_image = VulkanTextureStreamer::create_tail_image(*m_stream);
+    create();
+    EG_TRACE("eagle","Streamed vulkan texture constructed!");
+}
+
 VulkanTexture::~VulkanTexture() {
     EG_TRACE("eagle","Destroying a vulkan texture!");
+    if (m_stream){
+        VulkanTextureStreamer::remove(m_stream);
+    }
     clear();
     EG_TRACE("eagle","Vulkan texture destroyed!");
 }
@@ -38,7 +56,9 @@ void VulkanTexture::create() {
             m_nativeCreateInfo.device,
             m_sampler,
             VK_SAMPLER_ADDRESS_MODE_REPEAT,
-            VulkanConverter::to_vk(m_createInfo.filter)
+            VulkanConverter::to_vk(m_createInfo.filter),
+            //streamed images start at their resident level, lods are relative to it
+            static_cast<float>(m_stream ? m_stream->layout.levels.size() : m_image->mip_levels())
     );
     EG_TRACE("eagle","Vulkan texture created!");
 }
@@ -46,7 +66,10 @@ void VulkanTexture::create() {
 void VulkanTexture::clear() {
     EG_TRACE("eagle","Clearing a vulkan texture!");
     if (m_sampler){
-        VK_CALL vkDestroySampler(m_nativeCreateInfo.device, m_sampler, nullptr);
+        VulkanDeletionQueue::push([device = m_nativeCreateInfo.device, sampler = m_sampler]{
+            VK_CALL vkDestroySampler(device, sampler, nullptr);
+        });
+        m_sampler = VK_NULL_HANDLE;
     }
     m_image.reset();
     EG_TRACE("eagle","Vulkan texture cleared!");
@@ -54,6 +77,9 @@ void VulkanTexture::clear() {
 
 void VulkanTexture::resize(uint32_t width, uint32_t height) {
     EG_TRACE("eagle","Resizing a vulkan texture!");
+    if (m_stream){
+        throw std::runtime_error("streamed textures can't be resized!");
+    }
     clear();
     m_image->resize(width, height);
     create();
@@ -64,4 +90,33 @@ DescriptorType VulkanTexture::type() const {
     return DescriptorType::COMBINED_IMAGE_SAMPLER;
 }
 
+void VulkanTexture::request_screen_size(float pixels) {
+    if (m_stream){
+        VulkanTextureStreamer::request(*m_stream, pixels);
+    }
+}
+
+uint32_t VulkanTexture::resident_level() const {
+    return m_stream ? m_stream->residentLevel : 0;
+}
+
+std::shared_ptr<VulkanImage> VulkanTexture::swap_image(std::shared_ptr<VulkanImage> image) {
+    std::swap(m_image, image);
+    for (auto descriptorSet : m_descriptorSets){
+        descriptorSet->invalidate();
+    }
+    return image;
+}
+
+void VulkanTexture::add_descriptor_set(VulkanDescriptorSet *descriptorSet) {
+    m_descriptorSets.emplace_back(descriptorSet);
+}
+
+void VulkanTexture::remove_descriptor_set(VulkanDescriptorSet *descriptorSet) {
+    auto it = std::find(m_descriptorSets.begin(), m_descriptorSets.end(), descriptorSet);
+    if (it != m_descriptorSets.end()){
+        m_descriptorSets.erase(it);
+    }
+}
+
 }
@@ -9,9 +9,12 @@
 #include "vulkan_global_definitions.h"
 #include "vulkan_buffer.h"
 #include "vulkan_image.h"
+#include "vulkan_texture_streamer.h"
 
 namespace eagle {
 
+class VulkanDescriptorSet;
+
 struct VulkanTextureCreateInfo {
     VkPhysicalDevice physicalDevice;
     VkDevice device;
@@ -24,6 +27,9 @@ class VulkanTexture : public Texture {
 public:
     VulkanTexture(const TextureCreateInfo &textureCreateInfo,
                   const VulkanTextureCreateInfo &nativeCreateInfo);
+    //streamed from a KTX2/DDS file by VulkanTextureStreamer
+    VulkanTexture(const StreamingTextureCreateInfo &streamingCreateInfo,
+                  const VulkanTextureCreateInfo &nativeCreateInfo);
     virtual ~VulkanTexture();
 
 
@@ -34,6 +40,17 @@ public:
     inline const std::shared_ptr<VulkanImage>& native_image() const { return m_image; }
     inline VkSampler sampler() const { return m_sampler; }
 
+    virtual void request_screen_size(float pixels) override;
+    virtual uint32_t resident_level() const override;
+    inline bool is_streamed() const { return m_stream != nullptr; }
+
+    //streamed textures only: replaces the sampled image and rewrites every descriptor set using it, returns the old one
+    std::shared_ptr<VulkanImage> swap_image(std::shared_ptr<VulkanImage> image);
+
+    //descriptor sets sampling a streamed texture register themselves so they can be rewritten on swaps
+    void add_descriptor_set(VulkanDescriptorSet* descriptorSet);
+    void remove_descriptor_set(VulkanDescriptorSet* descriptorSet);
+
 private:
     void create();
     void clear();
@@ -41,7 +58,9 @@ private:
 private:
     VulkanTextureCreateInfo m_nativeCreateInfo;
     std::shared_ptr<VulkanImage> m_image;
-    VkSampler m_sampler;
+    VkSampler m_sampler = VK_NULL_HANDLE;
+    std::shared_ptr<VulkanTextureStream> m_stream;
+    std::vector<VulkanDescriptorSet*> m_descriptorSets;
 };
 
 }
@@ -0,0 +1,324 @@
+#include <eagle/renderer/vulkan/vulkan_texture_streamer.h>
+#include <eagle/renderer/vulkan/vulkan_texture.h>
+#include <eagle/renderer/vulkan/vulkan_uploader.h>
+#include <eagle/renderer/vulkan/vulkan_converter.h>
+#include <eagle/file_system.h>
+#include <eagle/worker_pool.h>
+#include <eagle/log.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace eagle {
+
+WorkerPool* VulkanTextureStreamer::s_workerPool = nullptr;
+VulkanImageCreateInfo VulkanTextureStreamer::s_imageCreateInfo = {};
+std::vector<std::shared_ptr<VulkanTextureStream>> VulkanTextureStreamer::s_streams;
+std::vector<VulkanTextureStream*> VulkanTextureStreamer::s_order;
+std::mutex VulkanTextureStreamer::s_readMutex;
+std::vector<VulkanTextureStreamer::ReadResult> VulkanTextureStreamer::s_readResults;
+uint32_t VulkanTextureStreamer::s_pendingReads = 0;
+size_t VulkanTextureStreamer::s_budget = VulkanTextureStreamer::DEFAULT_BUDGET;
+size_t VulkanTextureStreamer::s_uploadBytesPerFrame = VulkanTextureStreamer::DEFAULT_UPLOAD_BYTES_PER_FRAME;
+size_t VulkanTextureStreamer::s_residentBytes = 0;
+size_t VulkanTextureStreamer::s_uploadedBytes = 0;
+size_t VulkanTextureStreamer::s_evictedLevels = 0;
+uint64_t VulkanTextureStreamer::s_frame = 1;
+
+void VulkanTextureStreamer::init(const VulkanTextureStreamerCreateInfo &createInfo) {
+    EG_TRACE("eagle","Initializing vulkan texture streamer!");
+    s_workerPool = createInfo.workerPool;
+    s_imageCreateInfo = createInfo.imageCreateInfo;
+}
+
+void VulkanTextureStreamer::destroy() {
+    EG_TRACE("eagle","Destroying vulkan texture streamer!");
+    //reads still queued on the worker pool must have finished before this
+    s_streams.clear();
+    s_order.clear();
+    s_readResults.clear();
+    s_pendingReads = 0;
+    s_residentBytes = 0;
+    s_workerPool = nullptr;
+}
+
+std::shared_ptr<VulkanTextureStream> VulkanTextureStreamer::create_stream(VulkanTexture *texture, const std::string &path) {
+    auto stream = std::make_shared<VulkanTextureStream>();
+    stream->texture = texture;
+    stream->path = path;
+    stream->layout = TextureContainer::read_layout(path);
+
+    uint32_t levelCount = static_cast<uint32_t>(stream->layout.levels.size());
+    stream->tailLevel = levelCount - 1;
+    while (stream->tailLevel > 0 &&
+           std::max(stream->layout.width >> (stream->tailLevel - 1), stream->layout.height >> (stream->tailLevel - 1)) <= TAIL_EXTENT){
+        stream->tailLevel--;
+    }
+
+    stream->residentLevel = stream->tailLevel;
+    stream->requestedLevel = stream->tailLevel;
+    s_residentBytes += chain_bytes(*stream, stream->tailLevel);
+    s_streams.emplace_back(stream);
+    return stream;
+}
+
+void VulkanTextureStreamer::remove(const std::shared_ptr<VulkanTextureStream> &stream) {
+    s_residentBytes -= chain_bytes(*stream, stream->pendingImage ? stream->pendingLevel : stream->residentLevel);
+    //the image's destruction is deferred until the frames in flight are done with it
+    stream->pendingImage.reset();
+    stream->texture = nullptr;
+    s_streams.erase(std::find(s_streams.begin(), s_streams.end(), stream));
+}
+
+std::shared_ptr<VulkanImage> VulkanTextureStreamer::create_tail_image(const VulkanTextureStream &stream) {
+    uint32_t levelCount = static_cast<uint32_t>(stream.layout.levels.size());
+
+    //the tail is contiguous in both containers, one read covers it
+    size_t begin = SIZE_MAX;
+    size_t end = 0;
+    for (uint32_t level = stream.tailLevel; level < levelCount; level++){
+        begin = std::min(begin, stream.layout.levels[level].offset);
+        end = std::max(end, stream.layout.levels[level].offset + stream.layout.levels[level].size);
+    }
+    std::vector<uint8_t> bytes = FileSystem::instance()->read_bytes(stream.path, begin, end - begin);
+    if (bytes.size() < end - begin){
+        throw std::runtime_error("streamed texture is truncated!");
+    }
+
+    ImageCreateInfo createInfo = image_create_info(stream, stream.tailLevel);
+    createInfo.bufferData.reserve(end - begin);
+    for (uint32_t level = stream.tailLevel; level < levelCount; level++){
+        auto first = bytes.begin() + (stream.layout.levels[level].offset - begin);
+        createInfo.bufferData.insert(createInfo.bufferData.end(), first, first + stream.layout.levels[level].size);
+    }
+    return std::make_shared<VulkanImage>(createInfo, s_imageCreateInfo);
+}
+
+ImageCreateInfo VulkanTextureStreamer::image_create_info(const VulkanTextureStream &stream, uint32_t firstLevel) {
+    ImageCreateInfo createInfo = TextureContainer::image_create_info(stream.layout, firstLevel);
+    //resident levels are copied from the current image into the next one
+    createInfo.usages.emplace_back(ImageUsage::TRANSFER_SRC);
+    return createInfo;
+}
+
+void VulkanTextureStreamer::request(VulkanTextureStream &stream, float pixels) {
+    uint32_t extent = std::max(stream.layout.width, stream.layout.height);
+    uint32_t level = 0;
+    if (pixels < extent){
+        level = static_cast<uint32_t>(std::log2(extent / std::max(pixels, 1.0f)));
+        level = std::min(level, static_cast<uint32_t>(stream.layout.levels.size()) - 1);
+    }
+    if (stream.lastRequestFrame != s_frame){
+        stream.requestedLevel = level;
+        stream.lastRequestFrame = s_frame;
+    }
+    else {
+        stream.requestedLevel = std::min(stream.requestedLevel, level);
+    }
+}
+
+void VulkanTextureStreamer::update() {
+    if (!initialized()){
+        return;
+    }
+    s_frame++;
+    s_uploadedBytes = 0;
+
+    collect_reads();
+
+    for (auto& stream : s_streams){
+        if (!stream->pendingImage || !stream->pendingImage->is_ready()){
+            continue;
+        }
+        //descriptor sets of the other swapchain images are rewritten before they are bound again, and the old
+        //image is destroyed through the deletion queue once the frames sampling it finished
+        stream->texture->swap_image(std::move(stream->pendingImage));
+        stream->residentLevel = stream->pendingLevel;
+    }
+
+    evict();
+    promote();
+}
+
+void VulkanTextureStreamer::collect_reads() {
+    std::vector<ReadResult> results;
+    {
+        std::lock_guard<std::mutex> lock(s_readMutex);
+        results.swap(s_readResults);
+    }
+    for (auto& result : results){
+        VulkanTextureStream& stream = *result.stream;
+        stream.reading = false;
+        s_pendingReads--;
+        if (!stream.texture){
+            continue;
+        }
+        if (result.failed){
+            EG_WARNING("eagle", "Failed to stream level {0} of {1}, the texture stays at level {2}", result.level, stream.path, stream.residentLevel);
+            stream.failed = true;
+            continue;
+        }
+        //the texture may have been evicted while the level was read, only the next finer level is kept
+        if (result.level + 1 == stream.residentLevel && !stream.pendingImage){
+            stream.nextLevel = std::move(result.bytes);
+        }
+    }
+}
+
+void VulkanTextureStreamer::evict() {
+    if (s_residentBytes <= s_budget){
+        return;
+    }
+    s_order.clear();
+    for (auto& stream : s_streams){
+        //the tail is copied from the current image, which must have finished its own upload
+        if (!stream->pendingImage && stream->residentLevel < stream->tailLevel && stream->texture->native_image()->is_ready()){
+            s_order.emplace_back(stream.get());
+        }
+    }
+    std::sort(s_order.begin(), s_order.end(), [](const VulkanTextureStream* a, const VulkanTextureStream* b){
+        return a->lastRequestFrame < b->lastRequestFrame;
+    });
+
+    for (auto stream : s_order){
+        //everything left was visible last frame
+        if (s_residentBytes <= s_budget || stream->lastRequestFrame + 1 >= s_frame){
+            break;
+        }
+        //straight back to the tail, the texture asks for its levels again once it is visible.
+        //nothing is uploaded, the tail is copied on the GPU
+        s_evictedLevels += stream->tailLevel - stream->residentLevel;
+        start_upload(*stream, stream->tailLevel);
+    }
+}
+
+void VulkanTextureStreamer::promote() {
+    s_order.clear();
+    for (auto& stream : s_streams){
+        if (!stream->pendingImage && !stream->failed && stream->lastRequestFrame + 1 >= s_frame &&
+            stream->requestedLevel < stream->residentLevel && stream->texture->native_image()->is_ready()){
+            s_order.emplace_back(stream.get());
+        }
+    }
+    //the textures furthest from the level they asked for go first
+    std::sort(s_order.begin(), s_order.end(), [](const VulkanTextureStream* a, const VulkanTextureStream* b){
+        return a->residentLevel - a->requestedLevel > b->residentLevel - b->requestedLevel;
+    });
+
+    for (auto stream : s_order){
+        //one level at a time, from coarse to fine
+        uint32_t level = stream->residentLevel - 1;
+        if (stream->nextLevel.empty()){
+            if (!stream->reading && s_pendingReads < MAX_PENDING_READS){
+                start_read(*stream, level);
+            }
+            continue;
+        }
+
+        if (s_residentBytes + chain_bytes(*stream, level) - chain_bytes(*stream, stream->residentLevel) > s_budget){
+            continue;
+        }
+        //only the new level is uploaded, once into each of the per swapchain images.
+        //the first upload of a frame is always allowed, otherwise levels larger than the cap would never stream in
+        size_t uploadBytes = stream->layout.levels[level].size * s_imageCreateInfo.imageCount;
+        if (s_uploadedBytes > 0 && s_uploadedBytes + uploadBytes > s_uploadBytesPerFrame){
+            continue;
+        }
+        s_uploadedBytes += uploadBytes;
+        start_upload(*stream, level);
+    }
+}
+
+size_t VulkanTextureStreamer::chain_bytes(const VulkanTextureStream &stream, uint32_t firstLevel) {
+    size_t bytes = 0;
+    for (uint32_t level = firstLevel; level < stream.layout.levels.size(); level++){
+        bytes += stream.layout.levels[level].size;
+    }
+    //images are duplicated per swapchain image
+    return bytes * s_imageCreateInfo.imageCount;
+}
+
+void VulkanTextureStreamer::start_read(VulkanTextureStream &stream, uint32_t level) {
+    stream.reading = true;
+    s_pendingReads++;
+    //the task keeps the stream alive, results of destroyed textures are dropped in collect_reads
+    std::shared_ptr<VulkanTextureStream> owner = stream.shared_from_this();
+    TextureContainerLevel containerLevel = stream.layout.levels[level];
+    std::string path = stream.path;
+    s_workerPool->submit([owner, level, containerLevel, path]{
+        ReadResult result = {owner, level, {}, false};
+        try {
+            result.bytes = FileSystem::instance()->read_bytes(path, containerLevel.offset, containerLevel.size);
+            result.failed = result.bytes.size() < containerLevel.size;
+        }
+        catch (...) {
+            result.failed = true;
+        }
+        std::lock_guard<std::mutex> lock(s_readMutex);
+        s_readResults.emplace_back(std::move(result));
+    });
+}
+
+void VulkanTextureStreamer::start_upload(VulkanTextureStream &stream, uint32_t level) {
+    s_residentBytes += chain_bytes(stream, level);
+    s_residentBytes -= chain_bytes(stream, stream.residentLevel);
+
+    ImageCreateInfo createInfo = image_create_info(stream, level);
+    auto image = std::make_shared<VulkanImage>(createInfo, s_imageCreateInfo);
+    const std::shared_ptr<VulkanImage>& current = stream.texture->native_image();
+    VkImageLayout layout = VulkanConverter::to_vk(createInfo.layout);
+    VkImageAspectFlags aspectMask = VulkanConverter::to_vk_flags<VkImageAspectFlags>(createInfo.aspects);
+    uint32_t levelCount = static_cast<uint32_t>(stream.layout.levels.size());
+
+    //the levels both images hold are copied on the GPU, at most one new level is uploaded
+    uint32_t firstCopiedLevel = std::max(level, stream.residentLevel);
+    std::vector<VkImageCopy> regions;
+    for (uint32_t copiedLevel = firstCopiedLevel; copiedLevel < levelCount; copiedLevel++){
+        VkImageCopy region = {};
+        region.srcSubresource = {aspectMask, copiedLevel - stream.residentLevel, 0, 1};
+        region.dstSubresource = {aspectMask, copiedLevel - level, 0, 1};
+        region.extent = {std::max(stream.layout.width >> copiedLevel, 1u), std::max(stream.layout.height >> copiedLevel, 1u), 1};
+        regions.emplace_back(region);
+    }
+    VkImageSubresourceRange srcRange = {aspectMask, firstCopiedLevel - stream.residentLevel, levelCount - firstCopiedLevel, 0, 1};
+    VkImageSubresourceRange dstRange = {aspectMask, firstCopiedLevel - level, levelCount - firstCopiedLevel, 0, 1};
+
+    bool uploadsLevel = level < stream.residentLevel;
+    VulkanStagingRegion stagingRegion = {};
+    if (uploadsLevel){
+        //the copies run on the graphics queue, so the level can't go through the transfer queue
+        stagingRegion = VulkanUploader::stage(stream.nextLevel.data(), stream.nextLevel.size(), 16, false);
+    }
+    //staged, the CPU copy is no longer needed
+    stream.nextLevel.clear();
+    stream.nextLevel.shrink_to_fit();
+
+    for (size_t i = 0; i < image->native_images().size(); i++){
+        if (uploadsLevel){
+            VulkanUploader::copy_buffer_to_image(stagingRegion, image->native_images()[i], createInfo.width, createInfo.height,
+                                                 {aspectMask, 0, 1, 0, 1}, layout);
+        }
+        VulkanUploader::copy_image(current->native_images()[i], layout, srcRange, image->native_images()[i], layout, dstRange, regions);
+    }
+
+    stream.pendingImage = std::move(image);
+    stream.pendingLevel = level;
+}
+
+void VulkanTextureStreamer::set_budget(size_t residentBytes, size_t uploadBytesPerFrame) {
+    s_budget = residentBytes;
+    s_uploadBytesPerFrame = uploadBytesPerFrame;
+}
+
+TextureStreamingStats VulkanTextureStreamer::stats() {
+    TextureStreamingStats stats = {};
+    stats.residentBytes = s_residentBytes;
+    stats.budgetBytes = s_budget;
+    stats.uploadedBytes = s_uploadedBytes;
+    stats.evictedLevels = s_evictedLevels;
+    stats.pendingReads = s_pendingReads;
+    stats.streamedTextures = static_cast<uint32_t>(s_streams.size());
+    return stats;
+}
+
+}
@@ -0,0 +1,108 @@
+#ifndef EAGLE_VULKANTEXTURESTREAMER_H
+#define EAGLE_VULKANTEXTURESTREAMER_H
+
+#include "eagle/renderer/texture.h"
+#include "eagle/renderer/texture_container.h"
+#include "vulkan_image.h"
+
+#include <mutex>
+
+namespace eagle {
+
+class VulkanTexture;
+class WorkerPool;
+
+//streaming state of one VulkanTexture
+struct VulkanTextureStream : std::enable_shared_from_this<VulkanTextureStream> {
+    VulkanTexture* texture = nullptr;       //null once the texture is destroyed, its pending reads are dropped
+    std::string path;
+    TextureContainerLayout layout;
+    std::vector<uint8_t> nextLevel;         //read from disk, dropped once it is staged for upload
+    uint32_t tailLevel = 0;                 //levels from here on are always resident
+    uint32_t residentLevel = 0;
+    uint32_t requestedLevel = 0;
+    uint64_t lastRequestFrame = 0;
+    std::shared_ptr<VulkanImage> pendingImage;     //uploading, replaces the texture's image once ready
+    uint32_t pendingLevel = 0;
+    bool reading = false;
+    bool failed = false;
+};
+
+struct VulkanTextureStreamerCreateInfo {
+    WorkerPool* workerPool;
+    VulkanImageCreateInfo imageCreateInfo;
+};
+
+//Keeps the textures created from KTX2/DDS files at the level their on screen size asks for.
+//Each texture owns an image holding levels [residentLevel, levelCount), a finer level is read from disk on the
+//worker pool and uploaded into a new image, the levels already resident are copied into it from the old image on
+//the GPU. The new image replaces the old one once the copies are done and descriptor sets sampling the texture
+//are rewritten when that happens. No CPU copies are kept besides the level waiting for its upload.
+//Resident levels are bounded by a byte budget, the least recently requested textures drop back to their mip tail
+//first, and the bytes uploaded per frame are capped so streaming never stalls a frame.
+class VulkanTextureStreamer {
+public:
+    static constexpr size_t DEFAULT_BUDGET = 256ull * 1024 * 1024;
+    static constexpr size_t DEFAULT_UPLOAD_BYTES_PER_FRAME = 8ull * 1024 * 1024;
+    //levels this size or smaller are loaded with the texture and never evicted
+    static constexpr uint32_t TAIL_EXTENT = 64;
+    static constexpr uint32_t MAX_PENDING_READS = 4;
+
+    static void init(const VulkanTextureStreamerCreateInfo& createInfo);
+    static void destroy();
+
+    static inline bool initialized() { return s_workerPool != nullptr; }
+
+    //reads the header synchronously
+    static std::shared_ptr<VulkanTextureStream> create_stream(VulkanTexture* texture, const std::string& path);
+    static void remove(const std::shared_ptr<VulkanTextureStream>& stream);
+
+    //the texture's first image, reads the mip tail synchronously
+    static std::shared_ptr<VulkanImage> create_tail_image(const VulkanTextureStream& stream);
+
+    static void request(VulkanTextureStream& stream, float pixels);
+
+    //called once per frame after the uploader polled its transfers
+    static void update();
+
+    static void set_budget(size_t residentBytes, size_t uploadBytesPerFrame);
+    static TextureStreamingStats stats();
+
+private:
+    struct ReadResult {
+        std::shared_ptr<VulkanTextureStream> stream;
+        uint32_t level;
+        std::vector<uint8_t> bytes;
+        bool failed;
+    };
+
+    static size_t chain_bytes(const VulkanTextureStream& stream, uint32_t firstLevel);
+    static ImageCreateInfo image_create_info(const VulkanTextureStream& stream, uint32_t firstLevel);
+    static void start_read(VulkanTextureStream& stream, uint32_t level);
+    static void start_upload(VulkanTextureStream& stream, uint32_t level);
+    static void collect_reads();
+    static void evict();
+    static void promote();
+
+private:
+    static WorkerPool* s_workerPool;
+    static VulkanImageCreateInfo s_imageCreateInfo;
+
+    static std::vector<std::shared_ptr<VulkanTextureStream>> s_streams;
+    static std::vector<VulkanTextureStream*> s_order;      //scratch, sorted by priority
+
+    static std::mutex s_readMutex;
+    static std::vector<ReadResult> s_readResults;
+    static uint32_t s_pendingReads;
+
+    static size_t s_budget;
+    static size_t s_uploadBytesPerFrame;
+    static size_t s_residentBytes;      //includes the images being uploaded
+    static size_t s_uploadedBytes;
+    static size_t s_evictedLevels;
+    static uint64_t s_frame;
+};
+
+}
+
+#endif //EAGLE_VULKANTEXTURESTREAMER_H
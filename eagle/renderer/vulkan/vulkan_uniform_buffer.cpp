@@ -26,18 +26,25 @@ VulkanUniformBuffer::~VulkanUniformBuffer() {
 void
 VulkanUniformBuffer::flush(uint32_t bufferIndex) {
 
-    if (!is_dirty()) {
+    uint32_t bufferBit = 1u << bufferIndex;
+    if (!(m_dirtyMask & bufferBit)) {
         return;
     }
-    m_buffers[bufferIndex]->copy_to(m_bytes.data(), m_bytes.size());
-    m_dirtyBuffers.erase(bufferIndex);
+    auto& buffer = m_buffers[bufferIndex];
+    for (auto& range : m_dirtyRanges[bufferIndex].ranges()){
+        buffer->copy_to(m_bytes.data() + range.begin, range.end - range.begin, range.begin);
+    }
+    m_dirtyRanges[bufferIndex].clear();
+    m_dirtyMask &= ~bufferBit;
 }
 
 void VulkanUniformBuffer::create_uniform_buffer() {
 
     if (!m_cleared) return;
 
+    assert(m_info.bufferCount <= 32);
     m_buffers.resize(m_info.bufferCount);
+    m_dirtyRanges.resize(m_info.bufferCount);
 
     VulkanBufferCreateInfo bufferCreateInfo = {};
     bufferCreateInfo.usageFlags = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
@@ -57,25 +64,33 @@ void VulkanUniformBuffer::cleanup() {
         buffer->unmap();
         buffer->destroy();
     }
-    m_dirtyBuffers.clear();
+    for (auto& ranges : m_dirtyRanges){
+        ranges.clear();
+    }
+    m_dirtyMask = 0;
     m_cleared = true;
 }
 
 void VulkanUniformBuffer::upload() {
-    m_dirtyBuffers.clear();
-    for (int i = 0; i < m_buffers.size(); i++){
-        m_dirtyBuffers.insert(i);
+    if (m_pendingRanges.empty()){
+        return;
+    }
+    for (size_t i = 0; i < m_buffers.size(); i++){
+        m_dirtyRanges[i].add(m_pendingRanges);
+        m_dirtyMask |= 1u << i;
     }
+    m_pendingRanges.clear();
     VulkanCleaner::push(this);
 }
 
 bool VulkanUniformBuffer::is_dirty() const {
-    return !m_dirtyBuffers.empty();
+    return m_dirtyMask != 0;
 }
 
 void VulkanUniformBuffer::copy_from(void *data, size_t size, size_t offset) {
     assert(size + offset <= m_bytes.size());
     memcpy(m_bytes.data() + offset, data, size);
+    m_pendingRanges.add(offset, offset + size);
 }
 
 DescriptorType VulkanUniformBuffer::type() const {
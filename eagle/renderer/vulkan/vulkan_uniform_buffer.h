@@ -45,7 +45,11 @@ private:
 
     VulkanUniformBufferCreateInfo m_info;
     std::vector<std::shared_ptr<VulkanBuffer>> m_buffers;
-    std::set<int> m_dirtyBuffers;
+    //written by copy_from since the last upload
+    VulkanDirtyRanges m_pendingRanges;
+    //uploaded but not yet flushed to each per image buffer, bit i set while buffer i has dirty ranges
+    std::vector<VulkanDirtyRanges> m_dirtyRanges;
+    uint32_t m_dirtyMask = 0;
     bool m_cleared = true;
 };
 
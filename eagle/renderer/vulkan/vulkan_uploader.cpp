@@ -0,0 +1,648 @@
+#include <eagle/renderer/vulkan/vulkan_uploader.h>
+#include <eagle/renderer/vulkan/vulkan_helper.h>
+#include <eagle/log.h>
+
+#include <algorithm>
+
+namespace eagle {
+
+VkPhysicalDevice VulkanUploader::s_physicalDevice = VK_NULL_HANDLE;
+VkDevice VulkanUploader::s_device = VK_NULL_HANDLE;
+VkQueue VulkanUploader::s_queue = VK_NULL_HANDLE;
+uint32_t VulkanUploader::s_queueFamilyIndex = 0;
+VkCommandPool VulkanUploader::s_commandPool = VK_NULL_HANDLE;
+std::shared_ptr<VulkanBuffer> VulkanUploader::s_ring;
+uint8_t* VulkanUploader::s_ringData = nullptr;
+VkDeviceSize VulkanUploader::s_ringSize = 0;
+VkDeviceSize VulkanUploader::s_head = 0;
+VulkanUploader::Batch VulkanUploader::s_recording;
+bool VulkanUploader::s_isRecording = false;
+std::deque<VulkanUploader::Batch> VulkanUploader::s_inFlight;
+std::vector<VulkanUploader::Batch> VulkanUploader::s_freeBatches;
+VkQueue VulkanUploader::s_transferQueue = VK_NULL_HANDLE;
+uint32_t VulkanUploader::s_transferFamilyIndex = 0;
+VkCommandPool VulkanUploader::s_transferCommandPool = VK_NULL_HANDLE;
+VkSemaphore VulkanUploader::s_timelineSemaphore = VK_NULL_HANDLE;
+PFN_vkGetSemaphoreCounterValueKHR VulkanUploader::s_getSemaphoreCounterValue = nullptr;
+VulkanUploader::Batch VulkanUploader::s_transferRecording;
+bool VulkanUploader::s_isTransferRecording = false;
+std::deque<VulkanUploader::Batch> VulkanUploader::s_transferInFlight;
+std::vector<VulkanUploader::Batch> VulkanUploader::s_freeTransferBatches;
+std::vector<VulkanUploader::PendingAcquire> VulkanUploader::s_pendingAcquires;
+uint64_t VulkanUploader::s_submittedTransferValue = 0;
+uint64_t VulkanUploader::s_acquiredValue = 0;
+uint64_t VulkanUploader::s_graphicsWaitValue = 0;
+
+void VulkanUploader::init(const VulkanUploaderCreateInfo &createInfo, VkDeviceSize ringSize) {
+    EG_TRACE("eagle","Initializing vulkan uploader!");
+    s_physicalDevice = createInfo.physicalDevice;
+    s_device = createInfo.device;
+    s_queue = createInfo.graphicsQueue;
+    s_queueFamilyIndex = createInfo.graphicsFamilyIndex;
+    s_ringSize = ringSize;
+    s_head = 0;
+
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = s_queueFamilyIndex;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    VK_CALL_ASSERT(vkCreateCommandPool(s_device, &poolInfo, nullptr, &s_commandPool)) {
+        throw std::runtime_error("failed to create uploader command pool!");
+    }
+
+    VulkanBufferCreateInfo bufferInfo = {};
+    bufferInfo.memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    bufferInfo.usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    VK_CALL_ASSERT(VulkanBuffer::create_buffer(s_physicalDevice, s_device, s_ring, bufferInfo, s_ringSize)) {
+        throw std::runtime_error("failed to create staging ring buffer!");
+    }
+    VK_CALL_ASSERT(s_ring->map()) {
+        throw std::runtime_error("failed to map staging ring buffer!");
+    }
+    s_ringData = static_cast<uint8_t*>(s_ring->get_data());
+
+    s_transferQueue = createInfo.transferQueue;
+    s_transferFamilyIndex = createInfo.transferFamilyIndex;
+    s_submittedTransferValue = 0;
+    s_acquiredValue = 0;
+    s_graphicsWaitValue = 0;
+    if (s_transferQueue){
+        poolInfo.queueFamilyIndex = s_transferFamilyIndex;
+        VK_CALL_ASSERT(vkCreateCommandPool(s_device, &poolInfo, nullptr, &s_transferCommandPool)) {
+            throw std::runtime_error("failed to create transfer command pool!");
+        }
+
+        if (createInfo.timelineSemaphoreSupported){
+            s_getSemaphoreCounterValue = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(
+                    vkGetDeviceProcAddr(s_device, "vkGetSemaphoreCounterValueKHR"));
+        }
+
+        if (s_getSemaphoreCounterValue){
+            VkSemaphoreTypeCreateInfoKHR typeInfo = {};
+            typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+            typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+            typeInfo.initialValue = 0;
+
+            VkSemaphoreCreateInfo semaphoreInfo = {};
+            semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            semaphoreInfo.pNext = &typeInfo;
+            VK_CALL_ASSERT(vkCreateSemaphore(s_device, &semaphoreInfo, nullptr, &s_timelineSemaphore)) {
+                throw std::runtime_error("failed to create transfer timeline semaphore!");
+            }
+        }
+        else {
+            EG_INFO("eagle", "Timeline semaphores not supported, transfer completion will be tracked with fences");
+        }
+        EG_INFO("eagle", "Uploads larger than {0} bytes will use the transfer queue family {1}", ASYNC_UPLOAD_THRESHOLD, s_transferFamilyIndex);
+    }
+    EG_TRACE("eagle","Vulkan uploader initialized!");
+}
+
+void VulkanUploader::destroy() {
+    EG_TRACE("eagle","Destroying vulkan uploader!");
+    if (s_isRecording){
+        VK_CALL vkEndCommandBuffer(s_recording.commandBuffer);
+        release(s_recording, s_freeBatches);
+        s_isRecording = false;
+    }
+    while (!s_inFlight.empty()){
+        wait_oldest();
+    }
+
+    if (s_isTransferRecording){
+        VK_CALL vkEndCommandBuffer(s_transferRecording.commandBuffer);
+        release(s_transferRecording, s_freeTransferBatches);
+        s_isTransferRecording = false;
+    }
+    for (auto& batch : s_transferInFlight){
+        VK_CALL vkWaitForFences(s_device, 1, &batch.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+        release(batch, s_freeTransferBatches);
+    }
+    s_transferInFlight.clear();
+    s_pendingAcquires.clear();
+
+    for (auto freeBatches : {&s_freeBatches, &s_freeTransferBatches}){
+        for (auto& batch : *freeBatches){
+            VK_CALL vkDestroyFence(s_device, batch.fence, nullptr);
+        }
+        freeBatches->clear();
+    }
+    s_recording = {};
+    s_transferRecording = {};
+
+    //destroying the pools frees every command buffer allocated from them
+    VK_CALL vkDestroyCommandPool(s_device, s_commandPool, nullptr);
+    s_commandPool = VK_NULL_HANDLE;
+    if (s_transferCommandPool){
+        VK_CALL vkDestroyCommandPool(s_device, s_transferCommandPool, nullptr);
+        s_transferCommandPool = VK_NULL_HANDLE;
+    }
+    if (s_timelineSemaphore){
+        VK_CALL vkDestroySemaphore(s_device, s_timelineSemaphore, nullptr);
+        s_timelineSemaphore = VK_NULL_HANDLE;
+    }
+    s_getSemaphoreCounterValue = nullptr;
+    s_transferQueue = VK_NULL_HANDLE;
+
+    s_ring->destroy();
+    s_ring.reset();
+    s_ringData = nullptr;
+    s_device = VK_NULL_HANDLE;
+    s_physicalDevice = VK_NULL_HANDLE;
+}
+
+void VulkanUploader::begin_batch(Batch &batch, VkCommandPool commandPool, std::vector<Batch> &freeBatches) {
+    if (!freeBatches.empty()){
+        batch = std::move(freeBatches.back());
+        freeBatches.pop_back();
+    }
+    else {
+        batch = {};
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = commandPool;
+        allocInfo.commandBufferCount = 1;
+        VK_CALL_ASSERT(vkAllocateCommandBuffers(s_device, &allocInfo, &batch.commandBuffer)) {
+            throw std::runtime_error("failed to allocate uploader command buffer!");
+        }
+
+        VkFenceCreateInfo fenceInfo = {};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        VK_CALL_ASSERT(vkCreateFence(s_device, &fenceInfo, nullptr, &batch.fence)) {
+            throw std::runtime_error("failed to create uploader fence!");
+        }
+    }
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CALL vkBeginCommandBuffer(batch.commandBuffer, &beginInfo);
+}
+
+VkCommandBuffer VulkanUploader::recording_command_buffer() {
+    if (s_isRecording){
+        return s_recording.commandBuffer;
+    }
+
+    begin_batch(s_recording, s_commandPool, s_freeBatches);
+
+    //uploads may overwrite resources still being read by frames submitted earlier on this queue
+    VK_CALL vkCmdPipelineBarrier(s_recording.commandBuffer,
+                                 VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    s_isRecording = true;
+    return s_recording.commandBuffer;
+}
+
+VkCommandBuffer VulkanUploader::transfer_command_buffer() {
+    if (s_isTransferRecording){
+        return s_transferRecording.commandBuffer;
+    }
+
+    begin_batch(s_transferRecording, s_transferCommandPool, s_freeTransferBatches);
+    s_transferRecording.value = s_submittedTransferValue + 1;
+    s_isTransferRecording = true;
+    return s_transferRecording.commandBuffer;
+}
+
+void VulkanUploader::release(Batch &batch, std::vector<Batch> &freeBatches) {
+    for (auto& buffer : batch.overflowBuffers){
+        buffer->destroy();
+    }
+    batch.overflowBuffers.clear();
+    batch.hasRingData = false;
+    batch.ringBegin = 0;
+    batch.value = 0;
+    VK_CALL vkResetFences(s_device, 1, &batch.fence);
+    freeBatches.emplace_back(std::move(batch));
+}
+
+void VulkanUploader::retire_completed() {
+    while (!s_inFlight.empty() && vkGetFenceStatus(s_device, s_inFlight.front().fence) == VK_SUCCESS){
+        release(s_inFlight.front(), s_freeBatches);
+        s_inFlight.pop_front();
+    }
+}
+
+void VulkanUploader::wait_oldest() {
+    EG_TRACE("eagle","Staging ring is full, waiting for the oldest upload batch");
+    VK_CALL vkWaitForFences(s_device, 1, &s_inFlight.front().fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+    retire_completed();
+}
+
+bool VulkanUploader::reserve(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset) {
+    if (size > s_ringSize){
+        return false;
+    }
+
+    while (true) {
+        retire_completed();
+
+        //regions are handed out in ring order, so the oldest batch holding ring data marks the tail
+        const Batch* oldest = nullptr;
+        for (auto& batch : s_inFlight){
+            if (batch.hasRingData){
+                oldest = &batch;
+                break;
+            }
+        }
+        if (!oldest && s_isRecording && s_recording.hasRingData){
+            oldest = &s_recording;
+        }
+
+        if (!oldest){
+            offset = 0;
+            s_head = size;
+            return true;
+        }
+
+        VkDeviceSize tail = oldest->ringBegin;
+        VkDeviceSize aligned = ((s_head + alignment - 1) / alignment) * alignment;
+        if (s_head >= tail){
+            if (aligned + size <= s_ringSize){
+                offset = aligned;
+                s_head = aligned + size;
+                return true;
+            }
+            if (size < tail){
+                offset = 0;
+                s_head = size;
+                return true;
+            }
+        }
+        else if (aligned + size < tail){
+            offset = aligned;
+            s_head = aligned + size;
+            return true;
+        }
+
+        if (!s_inFlight.empty()){
+            wait_oldest();
+        }
+        else {
+            //only the batch being recorded holds ring data, every region in it has already been copied from
+            submit();
+        }
+    }
+}
+
+VulkanStagingRegion VulkanUploader::stage(const void *data, VkDeviceSize size, VkDeviceSize alignment, bool allowAsync) {
+    assert(initialized() && "VulkanUploader used before init");
+    VulkanStagingRegion region = {};
+
+    if (allowAsync && async_transfers_enabled() && size >= ASYNC_UPLOAD_THRESHOLD){
+        VulkanBufferCreateInfo bufferInfo = {};
+        bufferInfo.memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        bufferInfo.usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        std::shared_ptr<VulkanBuffer> stagingBuffer;
+        VK_CALL_ASSERT(VulkanBuffer::create_buffer(s_physicalDevice, s_device, stagingBuffer, bufferInfo, size, const_cast<void*>(data))) {
+            throw std::runtime_error("failed to create transfer staging buffer!");
+        }
+        transfer_command_buffer();
+        region.buffer = stagingBuffer->native_buffer();
+        region.async = true;
+        s_transferRecording.overflowBuffers.emplace_back(std::move(stagingBuffer));
+        return region;
+    }
+
+    VkDeviceSize offset;
+    if (reserve(size, alignment, offset)){
+        recording_command_buffer();
+        if (!s_recording.hasRingData){
+            s_recording.ringBegin = offset;
+            s_recording.hasRingData = true;
+        }
+        memcpy(s_ringData + offset, data, size);
+        region.buffer = s_ring->native_buffer();
+        region.offset = offset;
+        return region;
+    }
+
+    EG_TRACE("eagle","Upload of {0} bytes does not fit the staging ring, using a temporary staging buffer", size);
+    VulkanBufferCreateInfo bufferInfo = {};
+    bufferInfo.memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    bufferInfo.usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    std::shared_ptr<VulkanBuffer> stagingBuffer;
+    VK_CALL_ASSERT(VulkanBuffer::create_buffer(s_physicalDevice, s_device, stagingBuffer, bufferInfo, size, const_cast<void*>(data))) {
+        throw std::runtime_error("failed to create temporary staging buffer!");
+    }
+    recording_command_buffer();
+    region.buffer = stagingBuffer->native_buffer();
+    s_recording.overflowBuffers.emplace_back(std::move(stagingBuffer));
+    return region;
+}
+
+uint64_t VulkanUploader::copy_buffer(const VulkanStagingRegion &src, VkBuffer dst, VkDeviceSize size, VkDeviceSize dstOffset) {
+    VkBufferCopy copyRegion = {};
+    copyRegion.srcOffset = src.offset;
+    copyRegion.dstOffset = dstOffset;
+    copyRegion.size = size;
+
+    if (!src.async){
+        VK_CALL vkCmdCopyBuffer(recording_command_buffer(), src.buffer, dst, 1, &copyRegion);
+        return 0;
+    }
+
+    VkCommandBuffer commandBuffer = transfer_command_buffer();
+    VK_CALL vkCmdCopyBuffer(commandBuffer, src.buffer, dst, 1, &copyRegion);
+
+    //releases the buffer to the graphics family, poll records the matching acquire once the copy completed
+    VkBufferMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.srcQueueFamilyIndex = s_transferFamilyIndex;
+    barrier.dstQueueFamilyIndex = s_queueFamilyIndex;
+    barrier.buffer = dst;
+    barrier.offset = dstOffset;
+    barrier.size = size;
+    VK_CALL vkCmdPipelineBarrier(commandBuffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+    PendingAcquire acquire = {};
+    acquire.value = s_transferRecording.value;
+    acquire.bufferBarrier = barrier;
+    acquire.bufferBarrier.srcAccessMask = 0;
+    acquire.bufferBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+    acquire.isImage = false;
+    s_pendingAcquires.emplace_back(acquire);
+    return acquire.value;
+}
+
+uint64_t VulkanUploader::copy_buffer_to_image(const VulkanStagingRegion &src, VkImage dst, uint32_t width, uint32_t height,
+                                              VkImageSubresourceRange subresourceRange, VkImageLayout finalLayout) {
+    VkBufferImageCopy region = {};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+
+    region.imageSubresource.aspectMask = subresourceRange.aspectMask;
+    region.imageSubresource.mipLevel = subresourceRange.baseMipLevel;
+    region.imageSubresource.baseArrayLayer = subresourceRange.baseArrayLayer;
+    region.imageSubresource.layerCount = subresourceRange.layerCount;
+
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {width, height, 1};
+
+    return copy_buffer_to_image(src, dst, {region}, subresourceRange, finalLayout);
+}
+
+uint64_t VulkanUploader::copy_buffer_to_image(const VulkanStagingRegion &src, VkImage dst, std::vector<VkBufferImageCopy> regions,
+                                              VkImageSubresourceRange subresourceRange, VkImageLayout finalLayout) {
+    VkCommandBuffer commandBuffer = src.async ? transfer_command_buffer() : recording_command_buffer();
+
+    VulkanHelper::record_image_layout_transition(
+            commandBuffer,
+            dst,
+            VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            subresourceRange,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT
+    );
+
+    for (auto& region : regions){
+        region.bufferOffset += src.offset;
+    }
+
+    VK_CALL vkCmdCopyBufferToImage(commandBuffer, src.buffer, dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   static_cast<uint32_t>(regions.size()), regions.data());
+
+    if (!src.async){
+        VulkanHelper::record_image_layout_transition(
+                commandBuffer,
+                dst,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                finalLayout,
+                subresourceRange,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+        );
+        return 0;
+    }
+
+    //the layout transition happens as part of the ownership transfer
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = finalLayout;
+    barrier.srcQueueFamilyIndex = s_transferFamilyIndex;
+    barrier.dstQueueFamilyIndex = s_queueFamilyIndex;
+    barrier.image = dst;
+    barrier.subresourceRange = subresourceRange;
+    VK_CALL vkCmdPipelineBarrier(commandBuffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    PendingAcquire acquire = {};
+    acquire.value = s_transferRecording.value;
+    acquire.imageBarrier = barrier;
+    acquire.imageBarrier.srcAccessMask = 0;
+    acquire.imageBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+    acquire.isImage = true;
+    s_pendingAcquires.emplace_back(acquire);
+    return acquire.value;
+}
+
+void VulkanUploader::copy_image(VkImage src, VkImageLayout srcLayout, VkImageSubresourceRange srcRange,
+                                VkImage dst, VkImageLayout dstLayout, VkImageSubresourceRange dstRange,
+                                const std::vector<VkImageCopy> &regions) {
+    VkCommandBuffer commandBuffer = recording_command_buffer();
+
+    //src may still be sampled by frames submitted earlier
+    VulkanHelper::record_image_layout_transition(commandBuffer, src, srcLayout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                                 srcRange, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VulkanHelper::record_image_layout_transition(commandBuffer, dst, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                 dstRange, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    VK_CALL vkCmdCopyImage(commandBuffer, src, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+
+    VulkanHelper::record_image_layout_transition(commandBuffer, src, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, srcLayout, srcRange,
+                                                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    VulkanHelper::record_image_layout_transition(commandBuffer, dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, dstLayout, dstRange,
+                                                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+}
+
+void VulkanUploader::transition_image_layout(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                                             VkImageSubresourceRange subresourceRange,
+                                             VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+    VulkanHelper::record_image_layout_transition(recording_command_buffer(), image, oldLayout, newLayout,
+                                                 subresourceRange, srcStage, dstStage);
+}
+
+uint64_t VulkanUploader::upload_buffer(VkBuffer dst, const void *data, VkDeviceSize size, VkDeviceSize dstOffset, bool allowAsync) {
+    return copy_buffer(stage(data, size, 16, allowAsync), dst, size, dstOffset);
+}
+
+uint64_t VulkanUploader::completed_transfer_value() {
+    if (s_timelineSemaphore){
+        uint64_t value = 0;
+        VK_CALL s_getSemaphoreCounterValue(s_device, s_timelineSemaphore, &value);
+        return value;
+    }
+
+    //without timeline semaphores the batch fences are checked in submission order
+    uint64_t value = s_transferInFlight.empty() ? s_submittedTransferValue : s_transferInFlight.front().value - 1;
+    for (auto& batch : s_transferInFlight){
+        if (vkGetFenceStatus(s_device, batch.fence) != VK_SUCCESS){
+            break;
+        }
+        value = batch.value;
+    }
+    return value;
+}
+
+void VulkanUploader::poll() {
+    if (!async_transfers_enabled()){
+        return;
+    }
+
+    uint64_t completed = completed_transfer_value();
+    while (!s_transferInFlight.empty() && s_transferInFlight.front().value <= completed){
+        release(s_transferInFlight.front(), s_freeTransferBatches);
+        s_transferInFlight.pop_front();
+    }
+
+    if (completed <= s_acquiredValue){
+        return;
+    }
+
+    std::vector<VkBufferMemoryBarrier> bufferBarriers;
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+    auto it = std::remove_if(s_pendingAcquires.begin(), s_pendingAcquires.end(), [&](const PendingAcquire& acquire){
+        if (acquire.value > completed){
+            return false;
+        }
+        if (acquire.isImage){
+            imageBarriers.emplace_back(acquire.imageBarrier);
+        }
+        else {
+            bufferBarriers.emplace_back(acquire.bufferBarrier);
+        }
+        return true;
+    });
+    s_pendingAcquires.erase(it, s_pendingAcquires.end());
+
+    if (!bufferBarriers.empty() || !imageBarriers.empty()){
+        VK_CALL vkCmdPipelineBarrier(recording_command_buffer(),
+                                     VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                     0,
+                                     0, nullptr,
+                                     bufferBarriers.size(), bufferBarriers.data(),
+                                     imageBarriers.size(), imageBarriers.data());
+        s_graphicsWaitValue = completed;
+    }
+    s_acquiredValue = completed;
+}
+
+void VulkanUploader::wait(uint64_t token) {
+    if (is_ready(token)){
+        return;
+    }
+
+    if (s_isTransferRecording && s_transferRecording.value <= token){
+        submit_transfers();
+    }
+
+    EG_TRACE("eagle","Waiting for async upload {0}", token);
+    for (auto& batch : s_transferInFlight){
+        if (batch.value >= token){
+            VK_CALL vkWaitForFences(s_device, 1, &batch.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+            break;
+        }
+    }
+    poll();
+}
+
+void VulkanUploader::submit_transfers() {
+    if (!s_isTransferRecording){
+        return;
+    }
+
+    VK_CALL vkEndCommandBuffer(s_transferRecording.commandBuffer);
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &s_transferRecording.commandBuffer;
+
+    VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+    if (s_timelineSemaphore){
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &s_transferRecording.value;
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &s_timelineSemaphore;
+    }
+
+    VK_CALL_ASSERT(vkQueueSubmit(s_transferQueue, 1, &submitInfo, s_transferRecording.fence)) {
+        throw std::runtime_error("failed to submit transfer batch!");
+    }
+
+    s_submittedTransferValue = s_transferRecording.value;
+    s_transferInFlight.emplace_back(std::move(s_transferRecording));
+    s_transferRecording = {};
+    s_isTransferRecording = false;
+}
+
+bool VulkanUploader::submit(VkSemaphore signalSemaphore) {
+    submit_transfers();
+
+    if (!s_isRecording){
+        return false;
+    }
+
+    //makes every transfer write visible to whatever is submitted after this batch
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    VK_CALL vkCmdPipelineBarrier(s_recording.commandBuffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    VK_CALL vkEndCommandBuffer(s_recording.commandBuffer);
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &s_recording.commandBuffer;
+    if (signalSemaphore){
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &signalSemaphore;
+    }
+
+    //acquire barriers wait on the transfer timeline, the value was already reached so this never stalls
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+    if (s_timelineSemaphore && s_graphicsWaitValue > 0){
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timelineInfo.waitSemaphoreValueCount = 1;
+        timelineInfo.pWaitSemaphoreValues = &s_graphicsWaitValue;
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores = &s_timelineSemaphore;
+        submitInfo.pWaitDstStageMask = &waitStage;
+    }
+
+    VK_CALL_ASSERT(vkQueueSubmit(s_queue, 1, &submitInfo, s_recording.fence)) {
+        throw std::runtime_error("failed to submit upload batch!");
+    }
+
+    s_graphicsWaitValue = 0;
+    s_inFlight.emplace_back(std::move(s_recording));
+    s_recording = {};
+    s_isRecording = false;
+    return true;
+}
+
+}
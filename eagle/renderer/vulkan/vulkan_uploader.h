@@ -0,0 +1,149 @@
+#ifndef EAGLE_VULKANUPLOADER_H
+#define EAGLE_VULKANUPLOADER_H
+
+#include "vulkan_global_definitions.h"
+#include "vulkan_buffer.h"
+
+#include <deque>
+
+namespace eagle {
+
+struct VulkanStagingRegion {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    bool async = false;     //staged for the transfer queue
+};
+
+struct VulkanUploaderCreateInfo {
+    VkPhysicalDevice physicalDevice;
+    VkDevice device;
+    VkQueue graphicsQueue;
+    uint32_t graphicsFamilyIndex;
+    VkQueue transferQueue = VK_NULL_HANDLE;     //null when the device has no dedicated transfer family
+    uint32_t transferFamilyIndex = 0;
+    bool timelineSemaphoreSupported = false;
+};
+
+//Persistently mapped staging ring shared by every upload (baked buffers, textures, layout transitions).
+//Commands are recorded into a single batch that is submitted once per frame, right before the frame's
+//command buffer on the same queue, and ring regions are reclaimed when the batch's fence signals.
+//A staged region is only valid until the next call to stage, so copies must be recorded right after staging.
+//
+//When the device has a dedicated transfer family, large uploads of newly created resources run there instead.
+//Ownership is released to the graphics family once the copy is done, and the matching acquire is recorded
+//into the graphics batch only after the transfer has completed, so frames never wait on it.
+//Each async copy returns a readiness token: the resource can be used once is_ready(token) returns true.
+class VulkanUploader {
+public:
+    static constexpr VkDeviceSize DEFAULT_RING_SIZE = 32ull * 1024 * 1024;
+    static constexpr VkDeviceSize ASYNC_UPLOAD_THRESHOLD = 256 * 1024;
+
+    static void init(const VulkanUploaderCreateInfo& createInfo, VkDeviceSize ringSize = DEFAULT_RING_SIZE);
+    static void destroy();
+
+    //copies data into the ring, falls back to a temporary buffer released with the batch when it does not fit.
+    //allowAsync must be false when the destination may already be in use by the graphics queue
+    static VulkanStagingRegion stage(const void* data, VkDeviceSize size, VkDeviceSize alignment = 16, bool allowAsync = true);
+
+    //copies return the readiness token of the destination, 0 when it is usable by the next frame
+    static uint64_t copy_buffer(const VulkanStagingRegion& src, VkBuffer dst, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+
+    static uint64_t copy_buffer_to_image(const VulkanStagingRegion& src, VkImage dst, uint32_t width, uint32_t height,
+                                         VkImageSubresourceRange subresourceRange, VkImageLayout finalLayout);
+
+    //one copy with a region per mip level, region buffer offsets are relative to src
+    static uint64_t copy_buffer_to_image(const VulkanStagingRegion& src, VkImage dst, std::vector<VkBufferImageCopy> regions,
+                                         VkImageSubresourceRange subresourceRange, VkImageLayout finalLayout);
+
+    //copies between images on the graphics queue, src is returned to srcLayout and the dst subresources, whose
+    //previous contents are discarded, end up in dstLayout
+    static void copy_image(VkImage src, VkImageLayout srcLayout, VkImageSubresourceRange srcRange,
+                           VkImage dst, VkImageLayout dstLayout, VkImageSubresourceRange dstRange,
+                           const std::vector<VkImageCopy>& regions);
+
+    static void transition_image_layout(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                                        VkImageSubresourceRange subresourceRange,
+                                        VkPipelineStageFlags srcStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                        VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+    //stages and copies in one call
+    static uint64_t upload_buffer(VkBuffer dst, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0, bool allowAsync = true);
+
+    //checks for completed transfers and records their acquire barriers, called once per frame before recording
+    static void poll();
+
+    static inline bool is_ready(uint64_t token) { return token <= s_acquiredValue; }
+
+    //blocks until the transfer holding token completes, used before updating a resource that is not ready yet
+    static void wait(uint64_t token);
+
+    //submits the recorded batches, returns false when there was nothing to submit on the graphics queue.
+    //signalSemaphore is only signaled when something was submitted
+    static bool submit(VkSemaphore signalSemaphore = VK_NULL_HANDLE);
+
+    static inline bool initialized() { return s_device != VK_NULL_HANDLE; }
+    static inline bool async_transfers_enabled() { return s_transferQueue != VK_NULL_HANDLE; }
+
+private:
+    struct Batch {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        VkDeviceSize ringBegin = 0;
+        bool hasRingData = false;
+        uint64_t value = 0;     //timeline value signaled by transfer batches
+        std::vector<std::shared_ptr<VulkanBuffer>> overflowBuffers;
+    };
+
+    struct PendingAcquire {
+        uint64_t value;
+        VkBufferMemoryBarrier bufferBarrier;
+        VkImageMemoryBarrier imageBarrier;
+        bool isImage;
+    };
+
+    static VkCommandBuffer recording_command_buffer();
+    static VkCommandBuffer transfer_command_buffer();
+    static void begin_batch(Batch& batch, VkCommandPool commandPool, std::vector<Batch>& freeBatches);
+    static bool reserve(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+    static void retire_completed();
+    static void wait_oldest();
+    static void release(Batch& batch, std::vector<Batch>& freeBatches);
+    static void submit_transfers();
+    static uint64_t completed_transfer_value();
+
+private:
+    static VkPhysicalDevice s_physicalDevice;
+    static VkDevice s_device;
+    static VkQueue s_queue;
+    static uint32_t s_queueFamilyIndex;
+    static VkCommandPool s_commandPool;
+
+    static std::shared_ptr<VulkanBuffer> s_ring;
+    static uint8_t* s_ringData;
+    static VkDeviceSize s_ringSize;
+    static VkDeviceSize s_head;
+
+    static Batch s_recording;
+    static bool s_isRecording;
+    static std::deque<Batch> s_inFlight;
+    static std::vector<Batch> s_freeBatches;
+
+    //async transfers
+    static VkQueue s_transferQueue;
+    static uint32_t s_transferFamilyIndex;
+    static VkCommandPool s_transferCommandPool;
+    static VkSemaphore s_timelineSemaphore;
+    static PFN_vkGetSemaphoreCounterValueKHR s_getSemaphoreCounterValue;
+    static Batch s_transferRecording;
+    static bool s_isTransferRecording;
+    static std::deque<Batch> s_transferInFlight;
+    static std::vector<Batch> s_freeTransferBatches;
+    static std::vector<PendingAcquire> s_pendingAcquires;
+    static uint64_t s_submittedTransferValue;
+    static uint64_t s_acquiredValue;
+    static uint64_t s_graphicsWaitValue;
+};
+
+}
+
+#endif //EAGLE_VULKANUPLOADER_H
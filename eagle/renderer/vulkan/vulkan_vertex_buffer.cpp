@@ -92,6 +92,15 @@ bool VulkanVertexBuffer::is_dirty() const {
     return !m_dirtyBuffers.empty();
 }
 
+bool VulkanVertexBuffer::is_ready() const {
+    for (auto& buffer : m_buffers){
+        if (buffer && !buffer->is_ready()){
+            return false;
+        }
+    }
+    return true;
+}
+
 }
 
 
@@ -35,6 +35,7 @@ public:
 
     //vertex buffer
     void upload() override;
+    bool is_ready() const override;
 
     inline VulkanBuffer& native_buffer(uint32_t bufferIndex) {
         return *(m_buffers[bufferIndex]);
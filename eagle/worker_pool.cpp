@@ -0,0 +1,81 @@
+#include <eagle/worker_pool.h>
+#include <eagle/log.h>
+
+namespace eagle {
+
+namespace {
+
+thread_local const WorkerPool* t_currentPool = nullptr;
+
+}
+
+WorkerPool::WorkerPool(uint32_t threadCount) {
+    if (threadCount == 0){
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    EG_TRACE("eagle", "Starting worker pool with {0} threads", threadCount);
+    m_threads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++){
+        m_threads.emplace_back(&WorkerPool::run, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_taskAvailable.notify_all();
+    for (auto& thread : m_threads){
+        thread.join();
+    }
+}
+
+void WorkerPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.emplace_back(std::move(task));
+    }
+    m_taskAvailable.notify_one();
+}
+
+void WorkerPool::wait_idle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]{ return m_tasks.empty() && m_runningTasks == 0; });
+}
+
+bool WorkerPool::is_worker_thread() const {
+    return t_currentPool == this;
+}
+
+void WorkerPool::run() {
+    t_currentPool = this;
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskAvailable.wait(lock, [this]{ return m_stopping || !m_tasks.empty(); });
+            //pending tasks are still drained when stopping
+            if (m_tasks.empty()){
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            m_runningTasks++;
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_runningTasks--;
+            if (m_tasks.empty() && m_runningTasks == 0){
+                m_idle.notify_all();
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,47 @@
+#ifndef EG_WORKER_POOL_H
+#define EG_WORKER_POOL_H
+
+#include <eagle/core_global_definitions.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace eagle {
+
+//Fixed set of threads consuming a FIFO of tasks.
+//Tasks must not throw, errors have to be forwarded to whoever waits on the result.
+class WorkerPool {
+public:
+    //0 uses one thread per hardware thread minus the calling one
+    explicit WorkerPool(uint32_t threadCount = 0);
+    ~WorkerPool();
+
+    void submit(std::function<void()> task);
+
+    //blocks until every submitted task finished
+    void wait_idle();
+
+    inline uint32_t thread_count() const { return static_cast<uint32_t>(m_threads.size()); }
+
+    //true when called from one of this pool's tasks, which must not block on other tasks of the pool
+    bool is_worker_thread() const;
+
+private:
+    void run();
+
+private:
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+    std::condition_variable m_idle;
+    uint32_t m_runningTasks = 0;
+    bool m_stopping = false;
+};
+
+}
+
+#endif //EG_WORKER_POOL_H
@@ -0,0 +1,19 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) in vec2 aPosition;
+
+//per instance stream, see eagle::InstanceData
+layout(location = 1) in mat4 iTransform;
+layout(location = 5) in vec4 iColor;
+
+layout(location = 0) out vec4 vColor;
+
+out gl_PerVertex{
+    vec4 gl_Position;
+};
+
+void main() {
+    vColor = iColor;
+    gl_Position = iTransform * vec4(aPosition, 0.0f, 1.0f);
+}
@@ -0,0 +1,153 @@
+#include "instancing_application.h"
+
+#include <eagle/application.h>
+#include <eagle/window.h>
+
+#include <chrono>
+#include <cmath>
+
+InstancingApplication::InstancingApplication() {
+    EG_LOG_CREATE("instancing");
+    EG_LOG_PATTERN("[%T.%e] [%n] [%^%l%$] [%s:%#::%!()] %v");
+    EG_LOG_LEVEL(spdlog::level::info);
+}
+
+void InstancingApplication::init() {
+    EG_INFO("instancing", "Instancing attached!");
+    m_renderingContext = eagle::Application::instance().window().rendering_context();
+
+    m_listener.attach(&eagle::Application::instance().event_bus());
+    m_listener.subscribe<eagle::OnWindowClose>([](const eagle::OnWindowClose& ev){
+        eagle::Application::instance().quit();
+        return false;
+    });
+
+    eagle::VertexLayout meshLayout;
+    meshLayout.add(0, eagle::Format::R32G32_SFLOAT);
+
+    eagle::ShaderCreateInfo pipelineInfo = {m_renderingContext->main_render_pass(), {
+            {eagle::ShaderStage::VERTEX, "data/instanced.vert.spv"},
+            {eagle::ShaderStage::FRAGMENT, "data/color.frag.spv"}
+    }};
+    pipelineInfo.vertexLayout = eagle::InstancedBatchRenderer::instance_layout(meshLayout);
+    m_shader = m_renderingContext->create_shader(pipelineInfo);
+
+    //regular polygons with 3 to 3 + MESH_COUNT - 1 sides, drawn as triangle fans
+    for (uint32_t i = 0; i < MESH_COUNT; i++){
+        uint32_t sides = 3 + i;
+        std::vector<float> vertices = {0.0f, 0.0f};
+        std::vector<uint16_t> indices;
+        for (uint32_t side = 0; side < sides; side++){
+            float angle = 2.0f * 3.14159265f * side / sides;
+            vertices.emplace_back(std::cos(angle));
+            vertices.emplace_back(std::sin(angle));
+            indices.emplace_back(0);
+            indices.emplace_back(static_cast<uint16_t>(side + 1));
+            indices.emplace_back(static_cast<uint16_t>((side + 1) % sides + 1));
+        }
+
+        eagle::VertexBufferCreateInfo vbCreateInfo = {};
+        vbCreateInfo.updateType = eagle::UpdateType::BAKED;
+        vbCreateInfo.size = static_cast<uint32_t>(vertices.size() * sizeof(float));
+        vbCreateInfo.data = vertices.data();
+
+        eagle::InstancedMesh mesh;
+        mesh.vertexBuffer = m_renderingContext->create_vertex_buffer(vbCreateInfo).lock();
+        mesh.indexBuffer = m_renderingContext->create_index_buffer({eagle::UpdateType::BAKED, eagle::IndexBufferType::UINT_16,
+                                                                    static_cast<uint32_t>(indices.size() * sizeof(uint16_t)),
+                                                                    indices.data()}).lock();
+        mesh.indexCount = static_cast<uint32_t>(indices.size());
+        m_meshes.emplace_back(mesh);
+    }
+
+    eagle::CommandBufferCreateInfo commandBufferCreateInfo = {};
+    commandBufferCreateInfo.level = eagle::CommandBufferLevel::PRIMARY;
+    commandBufferCreateInfo.transient = true;
+    m_primaryCommandBuffer = m_renderingContext->create_command_buffer(commandBufferCreateInfo);
+
+    m_batchRenderer = std::make_unique<eagle::InstancedBatchRenderer>(m_renderingContext);
+
+    eagle::Random::init();
+    m_quads.resize(INSTANCE_COUNT);
+    for (auto& quad : m_quads){
+        quad.x = eagle::Random::range(-1.0f, 1.0f);
+        quad.y = eagle::Random::range(-1.0f, 1.0f);
+        quad.scale = eagle::Random::range(0.002f, 0.01f);
+        quad.angle = eagle::Random::range(0.0f, 6.2831853f);
+        quad.angularSpeed = eagle::Random::range(-3.0f, 3.0f);
+        quad.color[0] = eagle::Random::value();
+        quad.color[1] = eagle::Random::value();
+        quad.color[2] = eagle::Random::value();
+        quad.color[3] = 1.0f;
+    }
+
+    m_timer.start();
+    EG_INFO("instancing", "Drawing {0} instances of {1} meshes", m_quads.size(), m_meshes.size());
+}
+
+void InstancingApplication::step() {
+    m_timer.update();
+    if (!m_renderingContext->prepare_frame()){
+        EG_WARNING("instancing", "Failed to prepare frame, skipping");
+        return;
+    }
+
+    auto shader = m_shader.lock();
+    auto start = std::chrono::high_resolution_clock::now();
+
+    //every instance moves every frame, so the whole stream is rebuilt
+    float deltaTime = m_timer.delta_time();
+    eagle::InstanceData instance = {};
+    instance.transform[10] = 1.0f;
+    instance.transform[15] = 1.0f;
+    m_batchRenderer->begin();
+    for (size_t i = 0; i < m_quads.size(); i++){
+        Quad& quad = m_quads[i];
+        quad.angle += quad.angularSpeed * deltaTime;
+        float c = std::cos(quad.angle) * quad.scale;
+        float s = std::sin(quad.angle) * quad.scale;
+        instance.transform[0] = c;
+        instance.transform[1] = s;
+        instance.transform[4] = -s;
+        instance.transform[5] = c;
+        instance.transform[12] = quad.x;
+        instance.transform[13] = quad.y;
+        std::copy(quad.color, quad.color + 4, instance.color);
+        m_batchRenderer->submit(shader, m_meshes[i % m_meshes.size()], instance);
+    }
+
+    auto primaryCommandBuffer = m_primaryCommandBuffer.lock();
+
+    primaryCommandBuffer->begin();
+    primaryCommandBuffer->begin_gpu_zone("instances");
+    primaryCommandBuffer->begin_render_pass(m_renderingContext->main_render_pass(), m_renderingContext->main_frambuffer());
+    m_batchRenderer->flush(*primaryCommandBuffer);
+    primaryCommandBuffer->end_render_pass();
+    primaryCommandBuffer->end_gpu_zone();
+    primaryCommandBuffer->end();
+
+    m_cpuTimeMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    for (auto& timing : m_renderingContext->gpu_zone_timings()){
+        if (timing.name == "instances"){
+            m_gpuTimeMs += timing.milliseconds;
+        }
+    }
+    if (++m_recordedFrames == 120){
+        auto& stats = m_batchRenderer->stats();
+        EG_INFO("instancing", "{0} instances in {1} draws ({2} KB streamed), average cpu time: {3:.3f}ms, gpu time: {4:.3f}ms",
+                stats.instanceCount, stats.batchCount, stats.streamBytes / 1024,
+                m_cpuTimeMs / m_recordedFrames, m_gpuTimeMs / m_recordedFrames);
+        m_cpuTimeMs = 0.0f;
+        m_gpuTimeMs = 0.0f;
+        m_recordedFrames = 0;
+    }
+
+    m_renderingContext->present_frame(primaryCommandBuffer);
+}
+
+void InstancingApplication::destroy() {
+    EG_INFO("instancing", "Instancing destroyed!");
+    m_batchRenderer.reset();
+    m_meshes.clear();
+    m_listener.destroy();
+}
@@ -0,0 +1,48 @@
+#ifndef EAGLE_INSTANCINGAPP_H
+#define EAGLE_INSTANCINGAPP_H
+
+#include <eagle/eagle.h>
+
+//Stress test for InstancedBatchRenderer: every frame a large number of spinning quads is rebuilt on the CPU and
+//drawn in a handful of instanced draws.
+class InstancingApplication : public eagle::ApplicationDelegate {
+public:
+    static constexpr uint32_t INSTANCE_COUNT = 100000;
+    //quads are split between meshes so the renderer has more than one batch to build
+    static constexpr uint32_t MESH_COUNT = 4;
+
+    InstancingApplication();
+    ~InstancingApplication() override = default;
+
+    void init() override;
+
+    void step() override;
+
+    void destroy() override;
+
+private:
+    struct Quad {
+        float x, y;
+        float scale;
+        float angle;
+        float angularSpeed;
+        float color[4];
+    };
+
+private:
+    eagle::RenderingContext* m_renderingContext = nullptr;
+    eagle::EventListener m_listener;
+    std::weak_ptr<eagle::Shader> m_shader;
+    std::vector<eagle::InstancedMesh> m_meshes;
+    std::weak_ptr<eagle::CommandBuffer> m_primaryCommandBuffer;
+    std::unique_ptr<eagle::InstancedBatchRenderer> m_batchRenderer;
+    std::vector<Quad> m_quads;
+    eagle::Timer m_timer;
+
+    float m_cpuTimeMs = 0.0f;
+    float m_gpuTimeMs = 0.0f;
+    uint32_t m_recordedFrames = 0;
+};
+
+
+#endif //EAGLE_INSTANCINGAPP_H
@@ -0,0 +1,21 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) in vec2 aPosition;
+
+layout(push_constant) uniform Quad {
+    vec4 color;
+    vec2 offset;
+    float scale;
+} uQuad;
+
+layout(location = 0) out vec4 vColor;
+
+out gl_PerVertex{
+    vec4 gl_Position;
+};
+
+void main() {
+    vColor = uQuad.color;
+    gl_Position = vec4(aPosition * uQuad.scale + uQuad.offset, 0.0f, 1.0f);
+}
@@ -0,0 +1,18 @@
+#include <parallel_draw_application.h>
+
+#include <eagle/platform/desktop/desktop_application.h>
+
+int main(){
+
+
+    eagle::DesktopApplication application(1280, 720, new ParallelDrawApplication());
+
+    try {
+        application.run();
+    } catch(const std::exception& e) {
+        EG_CRITICAL("eagle", "An exception occurred: {0}", e.what());
+        return 1;
+    }
+
+    return 0;
+}
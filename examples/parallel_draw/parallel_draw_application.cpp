@@ -0,0 +1,134 @@
+#include "parallel_draw_application.h"
+
+#include <eagle/application.h>
+#include <eagle/window.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+ParallelDrawApplication::ParallelDrawApplication() {
+    EG_LOG_CREATE("parallel_draw");
+    EG_LOG_PATTERN("[%T.%e] [%n] [%^%l%$] [%s:%#::%!()] %v");
+    EG_LOG_LEVEL(spdlog::level::info);
+}
+
+void ParallelDrawApplication::init() {
+    EG_INFO("parallel_draw", "Parallel draw attached!");
+    m_renderingContext = eagle::Application::instance().window().rendering_context();
+
+    m_listener.attach(&eagle::Application::instance().event_bus());
+    m_listener.subscribe<eagle::OnWindowClose>([](const eagle::OnWindowClose& ev){
+        eagle::Application::instance().quit();
+        return false;
+    });
+
+    eagle::VertexLayout vertexLayout;
+    vertexLayout.add(0, eagle::Format::R32G32_SFLOAT);
+
+    eagle::ShaderCreateInfo pipelineInfo = {m_renderingContext->main_render_pass(), {
+            {eagle::ShaderStage::VERTEX, "data/quad.vert.spv"},
+            {eagle::ShaderStage::FRAGMENT, "data/color.frag.spv"}
+    }};
+    pipelineInfo.vertexLayout = vertexLayout;
+    m_shader = m_renderingContext->create_shader(pipelineInfo);
+
+    float vertices[] = {
+            -1.0f, -1.0f,
+            1.0f, -1.0f,
+            1.0f, 1.0f,
+            -1.0f, 1.0f
+    };
+
+    eagle::VertexBufferCreateInfo vbCreateInfo = {};
+    vbCreateInfo.updateType = eagle::UpdateType::BAKED;
+    vbCreateInfo.size = sizeof(vertices);
+    vbCreateInfo.data = vertices;
+    m_vertexBuffer = m_renderingContext->create_vertex_buffer(vbCreateInfo);
+
+    uint16_t indices[] = {0, 1, 2, 2, 3, 0};
+    m_indexBuffer = m_renderingContext->create_index_buffer({eagle::UpdateType::BAKED, eagle::IndexBufferType::UINT_16, sizeof(indices), indices});
+
+    eagle::CommandBufferCreateInfo commandBufferCreateInfo = {};
+    commandBufferCreateInfo.level = eagle::CommandBufferLevel::PRIMARY;
+    commandBufferCreateInfo.transient = true;
+    m_primaryCommandBuffer = m_renderingContext->create_command_buffer(commandBufferCreateInfo);
+
+    //one quad per grid cell, each one is a separate draw call
+    float cellSize = 2.0f / GRID_SIZE;
+    m_quads.resize(GRID_SIZE * GRID_SIZE);
+    for (uint32_t y = 0; y < GRID_SIZE; y++){
+        for (uint32_t x = 0; x < GRID_SIZE; x++){
+            Quad& quad = m_quads[y * GRID_SIZE + x];
+            quad.color[0] = static_cast<float>(x) / GRID_SIZE;
+            quad.color[1] = static_cast<float>(y) / GRID_SIZE;
+            quad.color[2] = 0.5f;
+            quad.color[3] = 1.0f;
+            quad.offset[0] = -1.0f + cellSize * (x + 0.5f);
+            quad.offset[1] = -1.0f + cellSize * (y + 0.5f);
+            quad.scale = cellSize * 0.4f;
+        }
+    }
+
+    m_taskCount = std::max(1u, std::thread::hardware_concurrency());
+    EG_INFO("parallel_draw", "Recording {0} draws on {1} threads", m_quads.size(), m_taskCount);
+}
+
+void ParallelDrawApplication::step() {
+    if (!m_renderingContext->prepare_frame()){
+        EG_WARNING("parallel_draw", "Failed to prepare frame, skipping");
+        return;
+    }
+
+    auto shader = m_shader.lock();
+    auto vertexBuffer = m_vertexBuffer.lock();
+    auto indexBuffer = m_indexBuffer.lock();
+    uint32_t quadsPerTask = (static_cast<uint32_t>(m_quads.size()) + m_taskCount - 1) / m_taskCount;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    auto& secondaryCommandBuffers = m_renderingContext->record_secondary_parallel(
+            m_renderingContext->main_render_pass(), m_renderingContext->main_frambuffer(), m_taskCount,
+            [&](eagle::CommandBuffer& commandBuffer, uint32_t taskIndex){
+        commandBuffer.bind_shader(shader);
+        commandBuffer.bind_vertex_buffer(vertexBuffer);
+        commandBuffer.bind_index_buffer(indexBuffer);
+
+        size_t first = static_cast<size_t>(taskIndex) * quadsPerTask;
+        size_t last = std::min(first + quadsPerTask, m_quads.size());
+        for (size_t i = first; i < last; i++){
+            commandBuffer.push_constants(eagle::ShaderStage::VERTEX, 0, sizeof(Quad), &m_quads[i]);
+            commandBuffer.draw_indexed(6, 0, 0);
+        }
+    });
+
+    m_recordTimeMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    for (auto& timing : m_renderingContext->gpu_zone_timings()){
+        if (timing.name == "quads"){
+            m_gpuTimeMs += timing.milliseconds;
+        }
+    }
+    if (++m_recordedFrames == 120){
+        EG_INFO("parallel_draw", "Average recording time: {0:.3f}ms, gpu time: {1:.3f}ms",
+                m_recordTimeMs / m_recordedFrames, m_gpuTimeMs / m_recordedFrames);
+        m_recordTimeMs = 0.0f;
+        m_gpuTimeMs = 0.0f;
+        m_recordedFrames = 0;
+    }
+
+    auto primaryCommandBuffer = m_primaryCommandBuffer.lock();
+
+    primaryCommandBuffer->begin();
+    primaryCommandBuffer->begin_gpu_zone("quads");
+    primaryCommandBuffer->begin_render_pass(m_renderingContext->main_render_pass(), m_renderingContext->main_frambuffer());
+    primaryCommandBuffer->execute_commands(secondaryCommandBuffers);
+    primaryCommandBuffer->end_render_pass();
+    primaryCommandBuffer->end_gpu_zone();
+    primaryCommandBuffer->end();
+    m_renderingContext->present_frame(primaryCommandBuffer);
+}
+
+void ParallelDrawApplication::destroy() {
+    EG_INFO("parallel_draw", "Parallel draw destroyed!");
+    m_listener.destroy();
+}
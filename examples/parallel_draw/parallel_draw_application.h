@@ -0,0 +1,42 @@
+#ifndef EAGLE_PARALLELDRAWAPP_H
+#define EAGLE_PARALLELDRAWAPP_H
+
+#include <eagle/eagle.h>
+
+struct Quad {
+    float color[4];
+    float offset[2];
+    float scale;
+};
+
+//Draws a large grid of quads, one draw call each, with the draw list split across every core.
+class ParallelDrawApplication : public eagle::ApplicationDelegate {
+public:
+    static constexpr uint32_t GRID_SIZE = 200;
+
+    ParallelDrawApplication();
+    ~ParallelDrawApplication() override = default;
+
+    void init() override;
+
+    void step() override;
+
+    void destroy() override;
+
+private:
+    eagle::RenderingContext* m_renderingContext = nullptr;
+    eagle::EventListener m_listener;
+    std::weak_ptr<eagle::Shader> m_shader;
+    std::weak_ptr<eagle::VertexBuffer> m_vertexBuffer;
+    std::weak_ptr<eagle::IndexBuffer> m_indexBuffer;
+    std::weak_ptr<eagle::CommandBuffer> m_primaryCommandBuffer;
+    std::vector<Quad> m_quads;
+    uint32_t m_taskCount = 1;
+
+    float m_recordTimeMs = 0.0f;
+    float m_gpuTimeMs = 0.0f;
+    uint32_t m_recordedFrames = 0;
+};
+
+
+#endif //EAGLE_PARALLELDRAWAPP_H
@@ -28,7 +28,7 @@ TextureCreateInfo TextureLoader::load_pixels(const std::string &path) {
     imageCreateInfo.format = Format::R8G8B8A8_UNORM;
     imageCreateInfo.mipLevels = 1;
     imageCreateInfo.arrayLayers = 1;
-    imageCreateInfo.tiling = ImageTiling::LINEAR;
+    imageCreateInfo.tiling = ImageTiling::OPTIMAL;
     imageCreateInfo.memoryProperties = {MemoryProperty::DEVICE_LOCAL};
     imageCreateInfo.aspects = {ImageAspect::COLOR};
     imageCreateInfo.usages = {ImageUsage::SAMPLED, ImageUsage::TRANSFER_DST};
@@ -37,6 +37,7 @@ TextureCreateInfo TextureLoader::load_pixels(const std::string &path) {
     TextureCreateInfo textureCreateInfo = {};
     textureCreateInfo.imageCreateInfo = std::move(imageCreateInfo);
     textureCreateInfo.filter = Filter::LINEAR;
+    textureCreateInfo.generateMipmaps = true;
     return textureCreateInfo;
 }
 
@@ -86,8 +86,10 @@ void TriangleApplication::init() {
 
     m_indexBuffer = m_renderingContext->create_index_buffer({eagle::UpdateType::BAKED, eagle::IndexBufferType::UINT_16, 6 * sizeof(uint16_t), indices});
 
+    //both are recorded every frame
     eagle::CommandBufferCreateInfo commandBufferCreateInfo = {};
     commandBufferCreateInfo.level = eagle::CommandBufferLevel::PRIMARY;
+    commandBufferCreateInfo.transient = true;
     m_primaryCommandBuffer = m_renderingContext->create_command_buffer(commandBufferCreateInfo);
 
     commandBufferCreateInfo.level = eagle::CommandBufferLevel::SECONDARY;
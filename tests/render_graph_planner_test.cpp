@@ -0,0 +1,257 @@
+#include <eagle/renderer/render_graph_planner.h>
+
+#include <algorithm>
+#include <cstdio>
+
+using namespace eagle;
+
+namespace {
+
+int s_failures = 0;
+
+#define EG_CHECK(condition) \
+    do { \
+        if (!(condition)){ \
+            std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            s_failures++; \
+        } \
+    } while (false)
+
+RenderGraphImageDescription color_description(uint32_t width, uint32_t height) {
+    RenderGraphImageDescription description;
+    description.width = width;
+    description.height = height;
+    description.format = Format::R8G8B8A8_UNORM;
+    return description;
+}
+
+void test_culls_passes_without_outputs() {
+    RenderGraphPlanner planner;
+    uint32_t backbuffer = planner.import_image(ImageLayout::UNDEFINED, ImageLayout::PRESENT_SRC_KHR);
+    uint32_t unused = planner.create_image(color_description(64, 64));
+    uint32_t dead = planner.add_pass();
+    planner.add_access(dead, unused, RenderGraphUsage::COLOR_ATTACHMENT, true);
+    uint32_t live = planner.add_pass();
+    planner.add_access(live, backbuffer, RenderGraphUsage::COLOR_ATTACHMENT, true);
+    uint32_t effect = planner.add_pass();
+    planner.add_access(effect, unused, RenderGraphUsage::STORAGE_COMPUTE, true);
+    planner.set_side_effect(effect);
+
+    planner.plan();
+
+    EG_CHECK(planner.passes()[dead].culled);
+    EG_CHECK(!planner.passes()[live].culled);
+    EG_CHECK(!planner.passes()[effect].culled);
+    EG_CHECK(planner.stats().culledPassCount == 1);
+}
+
+void test_reuses_physical_images() {
+    RenderGraphPlanner planner;
+    uint32_t backbuffer = planner.import_image(ImageLayout::UNDEFINED, ImageLayout::PRESENT_SRC_KHR);
+    uint32_t first = planner.create_image(color_description(64, 64));
+    uint32_t second = planner.create_image(color_description(64, 64));
+    uint32_t overlapping = planner.create_image(color_description(64, 64));
+    uint32_t smaller = planner.create_image(color_description(32, 32));
+
+    //first lives in passes 0-1, second in 2-3 so it can take first's image, overlapping lives in 2-4 next to second
+    uint32_t pass0 = planner.add_pass();
+    planner.add_access(pass0, first, RenderGraphUsage::COLOR_ATTACHMENT, true);
+    uint32_t pass1 = planner.add_pass();
+    planner.add_access(pass1, first, RenderGraphUsage::SAMPLED_FRAGMENT, false);
+    planner.add_access(pass1, smaller, RenderGraphUsage::COLOR_ATTACHMENT, true);
+    uint32_t pass2 = planner.add_pass();
+    planner.add_access(pass2, smaller, RenderGraphUsage::SAMPLED_FRAGMENT, false);
+    planner.add_access(pass2, second, RenderGraphUsage::COLOR_ATTACHMENT, true);
+    planner.add_access(pass2, overlapping, RenderGraphUsage::COLOR_ATTACHMENT, true);
+    uint32_t pass3 = planner.add_pass();
+    planner.add_access(pass3, second, RenderGraphUsage::SAMPLED_FRAGMENT, false);
+    planner.add_access(pass3, backbuffer, RenderGraphUsage::COLOR_ATTACHMENT, true);
+    uint32_t pass4 = planner.add_pass();
+    planner.add_access(pass4, overlapping, RenderGraphUsage::SAMPLED_FRAGMENT, false);
+    planner.add_access(pass4, backbuffer, RenderGraphUsage::COLOR_ATTACHMENT, true);
+
+    planner.plan();
+
+    auto& resources = planner.resources();
+    EG_CHECK(resources[first].physical == resources[second].physical);
+    EG_CHECK(resources[second].physical != resources[overlapping].physical);
+    EG_CHECK(resources[smaller].physical != resources[first].physical);
+    EG_CHECK(resources[smaller].physical != resources[overlapping].physical);
+    EG_CHECK(planner.stats().transientImageCount == 4);
+    EG_CHECK(planner.stats().physicalImageCount == 3);
+}
+
+void test_keeps_physical_images_across_clear() {
+    RenderGraphPlanner planner;
+    for (int frame = 0; frame < 2; frame++){
+        planner.clear();
+        uint32_t backbuffer = planner.import_image(ImageLayout::UNDEFINED, ImageLayout::PRESENT_SRC_KHR);
+        uint32_t color = planner.create_image(color_description(64, 64));
+        uint32_t draw = planner.add_pass();
+        planner.add_access(draw, color, RenderGraphUsage::COLOR_ATTACHMENT, true);
+        uint32_t blit = planner.add_pass();
+        planner.add_access(blit, color, RenderGraphUsage::TRANSFER_SRC, false);
+        planner.add_access(blit, backbuffer, RenderGraphUsage::TRANSFER_DST, true);
+
+        planner.plan();
+
+        EG_CHECK(planner.physical_images().size() == 1);
+        //only the first frame needs an image to be created
+        EG_CHECK(planner.physical_images()[0].recreate == (frame == 0));
+        planner.physical_images_created();
+    }
+}
+
+void test_transitions_between_passes() {
+    RenderGraphPlanner planner;
+    uint32_t backbuffer = planner.import_image(ImageLayout::UNDEFINED, ImageLayout::PRESENT_SRC_KHR);
+    uint32_t color = planner.create_image(color_description(64, 64));
+    uint32_t draw = planner.add_pass();
+    planner.add_access(draw, color, RenderGraphUsage::COLOR_ATTACHMENT, true);
+    uint32_t resolve = planner.add_pass();
+    planner.add_access(resolve, color, RenderGraphUsage::SAMPLED_FRAGMENT, false);
+    planner.add_access(resolve, backbuffer, RenderGraphUsage::COLOR_ATTACHMENT, true);
+
+    planner.plan();
+
+    auto& drawBarrier = planner.passes()[draw].barrier;
+    EG_CHECK(drawBarrier.images.size() == 1);
+    EG_CHECK(drawBarrier.images[0].resource == color);
+    EG_CHECK(drawBarrier.images[0].oldLayout == ImageLayout::UNDEFINED);
+    EG_CHECK(drawBarrier.images[0].newLayout == ImageLayout::COLOR_ATTACHMENT_OPTIMAL);
+
+    bool sampled = false;
+    for (auto& transition : planner.passes()[resolve].barrier.images){
+        if (transition.resource == color){
+            sampled = transition.oldLayout == ImageLayout::COLOR_ATTACHMENT_OPTIMAL &&
+                      transition.newLayout == ImageLayout::SHADER_READ_ONLY_OPTIMAL;
+        }
+    }
+    EG_CHECK(sampled);
+
+    auto& finalBarrier = planner.final_barrier();
+    EG_CHECK(finalBarrier.images.size() == 1);
+    EG_CHECK(finalBarrier.images[0].resource == backbuffer);
+    EG_CHECK(finalBarrier.images[0].newLayout == ImageLayout::PRESENT_SRC_KHR);
+}
+
+void test_skips_redundant_barriers() {
+    RenderGraphPlanner planner;
+    uint32_t buffer = planner.import_buffer();
+    uint32_t backbuffer = planner.import_image(ImageLayout::COLOR_ATTACHMENT_OPTIMAL, ImageLayout::COLOR_ATTACHMENT_OPTIMAL);
+    uint32_t first = planner.add_pass();
+    planner.add_access(first, buffer, RenderGraphUsage::INDIRECT_ARGUMENT, false);
+    planner.add_access(first, backbuffer, RenderGraphUsage::COLOR_ATTACHMENT, true);
+    uint32_t second = planner.add_pass();
+    planner.add_access(second, buffer, RenderGraphUsage::INDIRECT_ARGUMENT, false);
+    planner.set_side_effect(second);
+
+    planner.plan();
+
+    //the first read waits for whatever wrote the imported buffer, the second one is already covered by it
+    EG_CHECK(planner.passes()[first].barrier.buffers.size() == 1);
+    EG_CHECK(planner.passes()[second].barrier.empty());
+    EG_CHECK(planner.final_barrier().empty());
+}
+
+void test_aliases_memory_between_descriptions() {
+    RenderGraphPlanner planner;
+    uint32_t backbuffer = planner.import_image(ImageLayout::UNDEFINED, ImageLayout::PRESENT_SRC_KHR);
+    uint32_t first = planner.create_image(color_description(64, 64));
+    uint32_t middle = planner.create_image(color_description(16, 16));
+    RenderGraphImageDescription depthDescription = color_description(32, 32);
+    depthDescription.format = Format::D32_SFLOAT;
+    depthDescription.aspects = {ImageAspect::DEPTH};
+    uint32_t last = planner.create_image(depthDescription);
+
+    //first lives in passes 0-1, middle in 1-2 and last in 2-3, so only first and last can share memory
+    uint32_t pass0 = planner.add_pass();
+    planner.add_access(pass0, first, RenderGraphUsage::COLOR_ATTACHMENT, true);
+    uint32_t pass1 = planner.add_pass();
+    planner.add_access(pass1, first, RenderGraphUsage::SAMPLED_FRAGMENT, false);
+    planner.add_access(pass1, middle, RenderGraphUsage::COLOR_ATTACHMENT, true);
+    uint32_t pass2 = planner.add_pass();
+    planner.add_access(pass2, middle, RenderGraphUsage::SAMPLED_FRAGMENT, false);
+    planner.add_access(pass2, last, RenderGraphUsage::DEPTH_STENCIL_ATTACHMENT, true);
+    uint32_t pass3 = planner.add_pass();
+    planner.add_access(pass3, last, RenderGraphUsage::SAMPLED_FRAGMENT, false);
+    planner.add_access(pass3, backbuffer, RenderGraphUsage::COLOR_ATTACHMENT, true);
+
+    planner.plan();
+
+    auto& resources = planner.resources();
+    EG_CHECK(planner.stats().physicalImageCount == 3);
+    std::vector<ImageMemoryRequirements> requirements(planner.physical_images().size());
+    requirements[resources[first].physical] = {4096, 256};
+    requirements[resources[middle].physical] = {1024, 256};
+    requirements[resources[last].physical] = {2048, 512};
+
+    uint64_t size = planner.place_physical_images(requirements);
+
+    auto& physicalImages = planner.physical_images();
+    auto& firstImage = physicalImages[resources[first].physical];
+    auto& middleImage = physicalImages[resources[middle].physical];
+    auto& lastImage = physicalImages[resources[last].physical];
+    EG_CHECK(firstImage.memoryOffset == 0);
+    EG_CHECK(lastImage.memoryOffset == 0);
+    EG_CHECK(middleImage.memoryOffset == 4096);
+    EG_CHECK(size == 5120);
+    EG_CHECK(planner.stats().physicalImageBytes == 7168);
+    EG_CHECK(planner.stats().aliasedMemoryBytes == 5120);
+    EG_CHECK(lastImage.aliases.size() == 1 && lastImage.aliases[0] == resources[first].physical);
+    EG_CHECK(firstImage.aliases.empty() && middleImage.aliases.empty());
+
+    //last waits for the fragment shader that sampled first, nothing else in pass 2 reads in that stage
+    auto& srcStages = planner.passes()[pass2].barrier.srcStages;
+    EG_CHECK(std::find(srcStages.begin(), srcStages.end(), PipelineStage::FRAGMENT_SHADER_BIT) != srcStages.end());
+}
+
+void test_places_live_images_apart() {
+    RenderGraphPlanner planner;
+    uint32_t backbuffer = planner.import_image(ImageLayout::UNDEFINED, ImageLayout::PRESENT_SRC_KHR);
+    uint32_t large = planner.create_image(color_description(64, 64));
+    uint32_t small = planner.create_image(color_description(8, 8));
+
+    uint32_t draw = planner.add_pass();
+    planner.add_access(draw, large, RenderGraphUsage::COLOR_ATTACHMENT, true);
+    planner.add_access(draw, small, RenderGraphUsage::COLOR_ATTACHMENT, true);
+    uint32_t resolve = planner.add_pass();
+    planner.add_access(resolve, large, RenderGraphUsage::SAMPLED_FRAGMENT, false);
+    planner.add_access(resolve, small, RenderGraphUsage::SAMPLED_FRAGMENT, false);
+    planner.add_access(resolve, backbuffer, RenderGraphUsage::COLOR_ATTACHMENT, true);
+
+    planner.plan();
+
+    auto& resources = planner.resources();
+    std::vector<ImageMemoryRequirements> requirements(planner.physical_images().size());
+    requirements[resources[large].physical] = {300, 1};
+    requirements[resources[small].physical] = {100, 256};
+
+    uint64_t size = planner.place_physical_images(requirements);
+
+    auto& physicalImages = planner.physical_images();
+    EG_CHECK(physicalImages[resources[large].physical].memoryOffset == 0);
+    EG_CHECK(physicalImages[resources[small].physical].memoryOffset == 512);
+    EG_CHECK(size == 612);
+    EG_CHECK(physicalImages[resources[large].physical].aliases.empty());
+    EG_CHECK(physicalImages[resources[small].physical].aliases.empty());
+}
+
+}
+
+int main() {
+    test_culls_passes_without_outputs();
+    test_reuses_physical_images();
+    test_keeps_physical_images_across_clear();
+    test_transitions_between_passes();
+    test_skips_redundant_barriers();
+    test_aliases_memory_between_descriptions();
+    test_places_live_images_apart();
+
+    if (s_failures != 0){
+        std::printf("%d render graph planner checks failed\n", s_failures);
+        return 1;
+    }
+    std::printf("render graph planner checks passed\n");
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include <eagle/log.h>
+#include <eagle/pak/pak_writer.h>
+#include <eagle/pak/pak_file_system.h>
+#include <eagle/platform/desktop/desktop_file_system.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+using namespace eagle;
+
+namespace {
+
+void print_usage() {
+    std::cout << "usage:\n"
+              << "  eagle_pak pack <directory> <output.pak> [--no-compress]\n"
+              << "  eagle_pak list <archive.pak>\n"
+              << "  eagle_pak bench <directory> <archive.pak> [iterations]\n";
+}
+
+int pack(const std::string& directory, const std::string& output, bool compress) {
+    PakWriterCreateInfo createInfo = {};
+    createInfo.compress = compress;
+    PakWriter writer(createInfo);
+    writer.add_directory(directory);
+    writer.write(output);
+    std::cout << "packed " << writer.entry_count() << " files into " << output << "\n";
+    return 0;
+}
+
+int list(const std::string& path) {
+    PakArchive archive(path);
+    for (uint32_t i = 0; i < archive.entry_count(); i++){
+        auto& entry = archive.entries()[i];
+        std::cout << archive.entry_path(entry) << "  "
+                  << entry.size << " bytes"
+                  << (entry.compression == PakCompression::LZ4 ? " (lz4 " + std::to_string(entry.storedSize) + ")" : "")
+                  << "\n";
+    }
+    return 0;
+}
+
+template<typename F>
+double measure_ms(F&& func) {
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+//the first pass of each file system is reported as cold: it includes opening/mapping and the first page faults,
+//the OS page cache is not dropped, so run the tool after a reboot or cache flush for true cold disk numbers
+int bench(const std::string& directory, const std::string& pakPath, int iterations) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> paths;
+    for (auto& item : fs::recursive_directory_iterator(directory)){
+        if (item.is_regular_file()){
+            paths.emplace_back(fs::relative(item.path(), directory).generic_string());
+        }
+    }
+
+    size_t totalBytes = 0;
+    auto load_all = [&](FileSystem& fileSystem, const std::string& prefix){
+        totalBytes = 0;
+        for (auto& path : paths){
+            totalBytes += fileSystem.read_bytes(prefix + path).size();
+        }
+    };
+
+    DesktopFileSystem desktopFileSystem;
+    std::string desktopPrefix = directory + "/";
+    double desktopCold = measure_ms([&]{ load_all(desktopFileSystem, desktopPrefix); });
+    double desktopWarm = measure_ms([&]{
+        for (int i = 0; i < iterations; i++) load_all(desktopFileSystem, desktopPrefix);
+    }) / iterations;
+
+    std::unique_ptr<PakFileSystem> pakFileSystem;
+    double pakCold = measure_ms([&]{
+        pakFileSystem = std::make_unique<PakFileSystem>(pakPath, "");
+        load_all(*pakFileSystem, "");
+    });
+    double pakWarm = measure_ms([&]{
+        for (int i = 0; i < iterations; i++) load_all(*pakFileSystem, "");
+    }) / iterations;
+
+    std::cout << paths.size() << " files, " << totalBytes << " bytes\n"
+              << "desktop: cold " << desktopCold << " ms, warm " << desktopWarm << " ms\n"
+              << "pak:     cold " << pakCold << " ms, warm " << pakWarm << " ms\n";
+    return 0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    EG_LOG_CREATE("eagle");
+    EG_LOG_LEVEL(spdlog::level::warn);
+
+    if (argc < 3){
+        print_usage();
+        return 1;
+    }
+
+    try {
+        std::string command = argv[1];
+        if (command == "pack" && argc >= 4){
+            bool compress = !(argc >= 5 && std::strcmp(argv[4], "--no-compress") == 0);
+            return pack(argv[2], argv[3], compress);
+        }
+        if (command == "list"){
+            return list(argv[2]);
+        }
+        if (command == "bench" && argc >= 4){
+            int iterations = argc >= 5 ? std::max(1, std::atoi(argv[4])) : 10;
+            return bench(argv[2], argv[3], iterations);
+        }
+    }
+    catch (const std::exception& e){
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    print_usage();
+    return 1;
+}